@@ -21,6 +21,7 @@
 #include <vector>
 
 using node::BlockAssembler;
+using node::BlockTemplateCache;
 
 static void AssembleBlock(benchmark::Bench& bench)
 {
@@ -68,6 +69,22 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
         PrepareBlock(testing_setup->m_node, assembler_options);
     });
 }
+// Hand out the kept template while the mempool does not change.
+static void BlockTemplateCacheGet(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    testing_setup->PopulateMempool(det_rand, /*num_transactions=*/1000, /*submit=*/true);
+    BlockAssembler::Options assembler_options;
+    assembler_options.test_block_validity = false;
+    assembler_options.coinbase_output_script = P2WSH_OP_TRUE;
+    BlockTemplateCache cache{*testing_setup->m_node.chainman, *testing_setup->m_node.mempool};
+
+    bench.run([&] {
+        cache.Get(assembler_options);
+    });
+}
 
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
+BENCHMARK(BlockTemplateCacheGet, benchmark::PriorityLevel::LOW);
@@ -6,7 +6,9 @@
 #include <bench/bench.h>
 #include <crypto/chacha20.h>
 #include <crypto/chacha20poly1305.h>
+#include <crypto/poly1305.h>
 #include <span.h>
+#include <tinyformat.h>
 
 #include <cstddef>
 #include <cstdint>
@@ -41,6 +43,45 @@ static void FSCHACHA20POLY1305(benchmark::Bench& bench, size_t buffersize)
     });
 }
 
+static void CHACHA20_1MB_STANDARD(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 implementation", __func__, ChaCha20AutoDetect(chacha20_implementation::STANDARD)));
+    CHACHA20(bench, BUFFER_SIZE_LARGE);
+    ChaCha20AutoDetect();
+}
+
+static void CHACHA20_1MB_SSE41(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 implementation", __func__, ChaCha20AutoDetect(chacha20_implementation::USE_SSE41)));
+    CHACHA20(bench, BUFFER_SIZE_LARGE);
+    ChaCha20AutoDetect();
+}
+
+static void CHACHA20_1MB_AVX2(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 implementation", __func__, ChaCha20AutoDetect(chacha20_implementation::USE_AVX2)));
+    CHACHA20(bench, BUFFER_SIZE_LARGE);
+    ChaCha20AutoDetect();
+}
+
+static void FSCHACHA20POLY1305_1MB_STANDARD(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 and '%s' Poly1305 implementations", __func__,
+                         ChaCha20AutoDetect(chacha20_implementation::STANDARD), Poly1305AutoDetect(poly1305_implementation::STANDARD)));
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_LARGE);
+    ChaCha20AutoDetect();
+    Poly1305AutoDetect();
+}
+
+static void FSCHACHA20POLY1305_1MB_AVX2(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' ChaCha20 and '%s' Poly1305 implementations", __func__,
+                         ChaCha20AutoDetect(chacha20_implementation::USE_AVX2), Poly1305AutoDetect(poly1305_implementation::USE_AVX2)));
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_LARGE);
+    ChaCha20AutoDetect();
+    Poly1305AutoDetect();
+}
+
 static void CHACHA20_64BYTES(benchmark::Bench& bench)
 {
     CHACHA20(bench, BUFFER_SIZE_TINY);
@@ -77,3 +118,8 @@ BENCHMARK(CHACHA20_1MB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_256BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_SSE41, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_1MB_AVX2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_1MB_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_1MB_AVX2, benchmark::PriorityLevel::HIGH);
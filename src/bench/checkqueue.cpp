@@ -8,9 +8,12 @@
 #include <key.h>
 #include <prevector.h>
 #include <random.h>
+#include <script/sigcache.h>
+#include <uint256.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -19,13 +22,22 @@ static const size_t BATCH_SIZE = 30;
 static const int PREVECTOR_SIZE = 28;
 static const unsigned int QUEUE_BATCH_SIZE = 128;
 
+// The number of threads, including the main thread, that the checks are run on.
+// It is the number of cores by default; to see how the queue scales, pass the
+// numbers to measure as -asymptote, e.g. -asymptote=1,2,4,8,16,32,64.
+static int NumThreads(const benchmark::Bench& bench)
+{
+    return bench.complexityN() > 0 ? static_cast<int>(bench.complexityN()) : GetNumCores();
+}
+
 // This Benchmark tests the CheckQueue with a slightly realistic workload,
 // where checks all contain a prevector that is indirect 50% of the time
 // and there is a little bit of work done between calls to Add.
 static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
 {
     // We shouldn't ever be running with the checkqueue on a single core machine.
-    if (GetNumCores() <= 1) return;
+    const int threads_num{NumThreads(bench)};
+    if (threads_num <= 1 && bench.complexityN() <= 0) return;
 
     ECC_Context ecc_context{};
 
@@ -42,7 +54,7 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
 
     // The main thread should be counted to prevent thread oversubscription, and
     // to decrease the variance of benchmark results.
-    int worker_threads_num{GetNumCores() - 1};
+    int worker_threads_num{threads_num - 1};
     CCheckQueue<PrevectorJob> queue{QUEUE_BATCH_SIZE, worker_threads_num};
 
     // create all the data once, then submit copies in the benchmark.
@@ -65,4 +77,53 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench& bench)
         control.Complete();
     });
 }
+
+// This Benchmark tests the CheckQueue with checks that look up and insert
+// signature cache entries, like the script checks of a block do, so that all
+// threads use the cache at once.
+static void CCheckQueueSignatureCache(benchmark::Bench& bench)
+{
+    // We shouldn't ever be running with the checkqueue on a single core machine.
+    const int threads_num{NumThreads(bench)};
+    if (threads_num <= 1 && bench.complexityN() <= 0) return;
+
+    struct SignatureCacheJob {
+        SignatureCache* cache;
+        uint256 entry;
+        std::optional<int> operator()()
+        {
+            if (!cache->Get(entry, /*erase=*/false)) cache->Set(entry);
+            return std::nullopt;
+        }
+    };
+
+    SignatureCache signature_cache{DEFAULT_SIGNATURE_CACHE_BYTES};
+    int worker_threads_num{threads_num - 1};
+    CCheckQueue<SignatureCacheJob> queue{QUEUE_BATCH_SIZE, worker_threads_num};
+
+    // Half of the checks find their entry in the cache, the other half insert
+    // a new one.
+    FastRandomContext insecure_rand(true);
+    std::vector<uint256> cached(BATCHES * BATCH_SIZE / 2);
+    for (auto& entry : cached) {
+        entry = insecure_rand.rand256();
+        signature_cache.Set(entry);
+    }
+
+    bench.minEpochIterations(10).batch(BATCH_SIZE * BATCHES).unit("job").run([&] {
+        CCheckQueueControl<SignatureCacheJob> control(queue);
+        size_t next_cached{0};
+        for (size_t i = 0; i < BATCHES; ++i) {
+            std::vector<SignatureCacheJob> vChecks;
+            vChecks.reserve(BATCH_SIZE);
+            for (size_t x = 0; x < BATCH_SIZE; ++x) {
+                vChecks.push_back({&signature_cache, x % 2 ? cached[next_cached++] : insecure_rand.rand256()});
+            }
+            control.Add(std::move(vChecks));
+        }
+        control.Complete();
+    });
+}
+
 BENCHMARK(CCheckQueueSpeedPrevectorJob, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CCheckQueueSignatureCache, benchmark::PriorityLevel::HIGH);
@@ -12,6 +12,7 @@
 #include <validation.h>
 
 #include <cassert>
+#include <memory>
 #include <vector>
 
 /*
@@ -104,16 +105,29 @@ void BenchmarkConnectBlock(benchmark::Bench& bench, std::vector<CKey>& keys, std
     });
 }
 
+/*
+ * The script checks of the block run on the main thread and the test setup's
+ * two worker threads. To see how validation scales, pass the numbers of threads
+ * to measure as -asymptote, e.g. -asymptote=1,2,4,8,16; they are limited by
+ * MAX_SCRIPTCHECK_THREADS.
+ */
+std::unique_ptr<TestChain100Setup> MakeSetup(const benchmark::Bench& bench)
+{
+    TestOpts opts;
+    if (bench.complexityN() > 0) opts.worker_threads_num = static_cast<int>(bench.complexityN()) - 1;
+    return MakeNoLogFileContext<TestChain100Setup>(ChainType::REGTEST, opts);
+}
+
 static void ConnectBlockAllSchnorr(benchmark::Bench& bench)
 {
-    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto test_setup{MakeSetup(bench)};
     auto [keys, outputs]{CreateKeysAndOutputs(test_setup->coinbaseKey, /*num_schnorr=*/5, /*num_ecdsa=*/0)};
     BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
 }
 
 static void ConnectBlockMixedEcdsaSchnorr(benchmark::Bench& bench)
 {
-    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto test_setup{MakeSetup(bench)};
     // Blocks in range 848000 to 868000 have a roughly 20 to 80 ratio of schnorr to ecdsa inputs
     auto [keys, outputs]{CreateKeysAndOutputs(test_setup->coinbaseKey, /*num_schnorr=*/1, /*num_ecdsa=*/4)};
     BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
@@ -121,7 +135,7 @@ static void ConnectBlockMixedEcdsaSchnorr(benchmark::Bench& bench)
 
 static void ConnectBlockAllEcdsa(benchmark::Bench& bench)
 {
-    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto test_setup{MakeSetup(bench)};
     auto [keys, outputs]{CreateKeysAndOutputs(test_setup->coinbaseKey, /*num_schnorr=*/0, /*num_ecdsa=*/5)};
     BenchmarkConnectBlock(bench, keys, outputs, *test_setup);
 }
@@ -7,6 +7,7 @@
 #include <kernel/cs_main.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <random.h>
 #include <script/script.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
@@ -144,4 +145,72 @@ static void MempoolEviction(benchmark::Bench& bench)
     });
 }
 
+// A flood of transaction chains pushes the mempool past its limit. Children
+// pay more than their parents, so whole chains are evicted at once.
+//! Chains of transactions spending each other, with a random fee each.
+static std::vector<std::pair<CTransactionRef, CAmount>> MakeChains(size_t num_chains, size_t chain_length)
+{
+    FastRandomContext det_rand{true};
+    std::vector<std::pair<CTransactionRef, CAmount>> txs;
+    txs.reserve(num_chains * chain_length);
+    for (size_t chain{0}; chain < num_chains; ++chain) {
+        COutPoint prevout{Txid::FromUint256(det_rand.rand256()), 0};
+        for (size_t i{0}; i < chain_length; ++i) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout = prevout;
+            tx.vin[0].scriptSig = CScript() << OP_1;
+            tx.vout.resize(1);
+            tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+            tx.vout[0].nValue = 10 * COIN;
+            txs.emplace_back(MakeTransactionRef(tx), 1000 + det_rand.randrange(1000) + 100 * i);
+            prevout = COutPoint{txs.back().first->GetHash(), 0};
+        }
+    }
+    return txs;
+}
+
+static void MempoolEvictionFlood(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    const auto txs{MakeChains(/*num_chains=*/200, /*chain_length=*/25)};
+
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& [tx, fee] : txs) {
+            AddTx(tx, fee, pool);
+        }
+        pool.TrimToSize(pool.DynamicMemoryUsage() / 4);
+        pool.TrimToSize(0);
+    });
+}
+
+//! A block confirming the first transactions of long chains, leaving their
+//! last transactions in the mempool.
+static void MempoolRemoveForBlock(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    static constexpr size_t CHAIN_LENGTH{25};
+    static constexpr size_t NUM_CONFIRMED{20};
+    const auto txs{MakeChains(/*num_chains=*/200, CHAIN_LENGTH)};
+    std::vector<CTransactionRef> block_txs;
+    std::vector<CTransactionRef> remaining_txs;
+    for (size_t i{0}; i < txs.size(); ++i) {
+        (i % CHAIN_LENGTH < NUM_CONFIRMED ? block_txs : remaining_txs).push_back(txs[i].first);
+    }
+
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& [tx, fee] : txs) {
+            AddTx(tx, fee, pool);
+        }
+        pool.removeForBlock(block_txs, /*nBlockHeight=*/2);
+        pool.removeForBlock(remaining_txs, /*nBlockHeight=*/3);
+    });
+}
+
 BENCHMARK(MempoolEviction, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionFlood, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolRemoveForBlock, benchmark::PriorityLevel::HIGH);
@@ -2,8 +2,13 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <bench/bench.h>
 #include <consensus/amount.h>
+#include <node/bumpfeeoracle.h>
+#include <node/mini_miner.h>
+#include <policy/feerate.h>
+#include <policy/packages.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
@@ -14,9 +19,12 @@
 #include <txmempool.h>
 #include <validation.h>
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 class CCoinsViewCache;
@@ -126,5 +134,125 @@ static void MempoolCheck(benchmark::Bench& bench)
     });
 }
 
+//! Submit a transaction to the mempool funding @p num_outputs P2WPKH outputs of the coinbase key.
+static CTransactionRef FundOutputs(TestChain100Setup& setup, size_t num_outputs, CAmount value)
+{
+    const CScript script_pub_key{GetScriptForDestination(WitnessV0KeyHash(setup.coinbaseKey.GetPubKey()))};
+    const CTransactionRef& coinbase_tx{setup.m_coinbase_txns[0]};
+    return MakeTransactionRef(setup.CreateValidMempoolTransaction({coinbase_tx}, {COutPoint{coinbase_tx->GetHash(), 0}}, /*input_height=*/0,
+                                                                  {setup.coinbaseKey}, std::vector<CTxOut>(num_outputs, CTxOut{value, script_pub_key})));
+}
+
+//! Test acceptance of a transaction spending many inputs.
+static void MempoolAcceptManyInputs(benchmark::Bench& bench)
+{
+    static constexpr size_t NUM_INPUTS{100};
+    static constexpr CAmount VALUE{COIN / 4};
+    // Without a signature cache, every run verifies all signatures again.
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>(ChainType::REGTEST, {.min_validation_cache = true})};
+    const auto funding_tx{FundOutputs(*testing_setup, NUM_INPUTS, VALUE)};
+    std::vector<COutPoint> inputs;
+    for (uint32_t i{0}; i < NUM_INPUTS; ++i) inputs.emplace_back(funding_tx->GetHash(), i);
+    const auto tx{MakeTransactionRef(testing_setup->CreateValidMempoolTransaction({funding_tx}, inputs, /*input_height=*/0, {testing_setup->coinbaseKey},
+                                                                                  {CTxOut{NUM_INPUTS * VALUE - COIN / 100, funding_tx->vout[0].scriptPubKey}}, /*submit=*/false))};
+
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    LOCK(cs_main);
+    bench.unit("tx").run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        const auto result{chainman.ProcessTransaction(tx, /*test_accept=*/true)};
+        assert(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+    });
+}
+
+//! Test acceptance of a package of single input transactions.
+static void MempoolAcceptPackage(benchmark::Bench& bench)
+{
+    // Together with their common parent, within the default descendant limit.
+    static constexpr size_t NUM_TXS{DEFAULT_DESCENDANT_LIMIT - 1};
+    static constexpr CAmount VALUE{COIN};
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>(ChainType::REGTEST, {.min_validation_cache = true})};
+    const auto funding_tx{FundOutputs(*testing_setup, NUM_TXS, VALUE)};
+    Package package;
+    for (uint32_t i{0}; i < NUM_TXS; ++i) {
+        package.push_back(MakeTransactionRef(testing_setup->CreateValidMempoolTransaction(
+            {funding_tx}, {COutPoint{funding_tx->GetHash(), i}}, /*input_height=*/0, {testing_setup->coinbaseKey},
+            {CTxOut{VALUE - COIN / 100, funding_tx->vout[0].scriptPubKey}}, /*submit=*/false)));
+    }
+
+    Chainstate& chainstate{testing_setup->m_node.chainman->ActiveChainstate()};
+    CTxMemPool& pool{*testing_setup->m_node.mempool};
+    LOCK(cs_main);
+    bench.batch(NUM_TXS).unit("tx").run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        const auto result{ProcessNewPackage(chainstate, pool, package, /*test_accept=*/true, /*client_maxfeerate=*/std::nullopt)};
+        assert(result.m_state.IsValid());
+    });
+}
+
+//! Add @p num_chains chains of @p chain_length transactions to the mempool, and return the outputs
+//! of the last transaction of each.
+static std::vector<COutPoint> AddChains(CTxMemPool& pool, uint32_t num_chains, size_t chain_length) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+{
+    std::vector<COutPoint> outpoints;
+    for (uint32_t chain{0}; chain < num_chains; ++chain) {
+        COutPoint prevout{Txid::FromUint256(uint256::ONE), chain};
+        for (size_t i{0}; i < chain_length; ++i) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(prevout);
+            tx.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+            const auto ref{MakeTransactionRef(tx)};
+            AddTx(ref, pool);
+            prevout = COutPoint{ref->GetHash(), 0};
+        }
+        outpoints.push_back(prevout);
+    }
+    return outpoints;
+}
+
+//! Number of chains to calculate bump fees for. A single MiniMiner gives up on more than 500
+//! transactions, so all their transactions together must stay within that.
+static constexpr uint32_t BUMP_FEE_NUM_CHAINS{500 / DEFAULT_ANCESTOR_LIMIT};
+static const std::vector<CFeeRate> BUMP_FEE_TARGETS{CFeeRate{5'000}, CFeeRate{20'000}, CFeeRate{50'000}, CFeeRate{100'000}};
+
+//! Calculate the bump fees of unconfirmed outputs at several feerates with a new MiniMiner each.
+static void MempoolBumpFeesMiniMiner(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    std::vector<COutPoint> outpoints;
+    {
+        LOCK2(cs_main, pool.cs);
+        outpoints = AddChains(pool, BUMP_FEE_NUM_CHAINS, /*chain_length=*/DEFAULT_ANCESTOR_LIMIT);
+    }
+
+    bench.run([&] {
+        for (const auto& target_feerate : BUMP_FEE_TARGETS) {
+            const auto bump_fees{node::MiniMiner(pool, outpoints).CalculateBumpFees(target_feerate)};
+            assert(bump_fees.size() == outpoints.size());
+        }
+    });
+}
+
+//! Calculate the same bump fees with a BumpFeeOracle, which keeps the clusters between calls.
+static void MempoolBumpFeesOracle(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    std::vector<COutPoint> outpoints;
+    {
+        LOCK2(cs_main, pool.cs);
+        outpoints = AddChains(pool, BUMP_FEE_NUM_CHAINS, /*chain_length=*/DEFAULT_ANCESTOR_LIMIT);
+    }
+    node::BumpFeeOracle oracle{pool};
+
+    bench.run([&] {
+        const auto bump_fees{oracle.CalculateBumpFees(outpoints, BUMP_FEE_TARGETS)};
+        assert(bump_fees.size() == BUMP_FEE_TARGETS.size() && bump_fees.front().size() == outpoints.size());
+    });
+}
+
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAcceptManyInputs, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAcceptPackage, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolBumpFeesMiniMiner, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolBumpFeesOracle, benchmark::PriorityLevel::HIGH);
@@ -10,12 +10,17 @@
 #include <pubkey.h>
 #include <script/sign.h>
 #include <test/util/setup_common.h>
+#include <node/txdownloadman.h>
 #include <node/txorphanage.h>
+#include <sync.h>
 #include <util/check.h>
+#include <util/time.h>
 #include <test/util/transaction_utils.h>
 
 #include <cstdint>
 #include <memory>
+#include <thread>
+#include <vector>
 
 static constexpr node::TxOrphanage::Usage TINY_TX_WEIGHT{240};
 static constexpr int64_t APPROX_WEIGHT_PER_INPUT{200};
@@ -264,7 +269,55 @@ static void OrphanageEraseForPeer(benchmark::Bench& bench)
     OrphanageEraseAll(bench, /*block_or_disconnect=*/false);
 }
 
+// Every peer announces every transaction, as happens for transactions relayed through the network. The peers are
+// split over num_threads threads, which take the lock for every announcement like message handling does.
+static void TxDownloadAnnounce(benchmark::Bench& bench, unsigned int num_threads)
+{
+    static constexpr NodeId NUM_PEERS{64};
+    static constexpr unsigned int NUM_TXNS{500};
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    FastRandomContext det_rand{true};
+
+    std::vector<Wtxid> wtxids;
+    wtxids.reserve(NUM_TXNS);
+    for (unsigned int i{0}; i < NUM_TXNS; ++i) {
+        wtxids.push_back(Wtxid::FromUint256(det_rand.rand256()));
+    }
+
+    Mutex tx_download_mutex;
+    bench.run([&] {
+        node::TxDownloadManager txdownloadman{node::TxDownloadOptions{*testing_setup->m_node.mempool, det_rand, /*m_deterministic_txrequest=*/true}};
+        for (NodeId peer{0}; peer < NUM_PEERS; ++peer) {
+            txdownloadman.ConnectedPeer(peer, {/*m_preferred=*/peer < 8, /*m_relay_permissions=*/false, /*m_wtxid_relay=*/true});
+        }
+        const auto now{GetTime<std::chrono::microseconds>()};
+        const auto announce{[&](unsigned int thread) {
+            for (const auto& wtxid : wtxids) {
+                for (NodeId peer = thread; peer < NUM_PEERS; peer += num_threads) {
+                    LOCK(tx_download_mutex);
+                    txdownloadman.AddTxAnnouncement(peer, wtxid, now);
+                }
+            }
+        }};
+        std::vector<std::thread> threads;
+        for (unsigned int thread{1}; thread < num_threads; ++thread) threads.emplace_back(announce, thread);
+        announce(0);
+        for (auto& thread : threads) thread.join();
+    });
+}
+
+static void TxDownloadAnnounceFromManyPeers(benchmark::Bench& bench)
+{
+    TxDownloadAnnounce(bench, /*num_threads=*/1);
+}
+static void TxDownloadAnnounceFromManyPeersFourThreads(benchmark::Bench& bench)
+{
+    TxDownloadAnnounce(bench, /*num_threads=*/4);
+}
+
 BENCHMARK(OrphanageSinglePeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageMultiPeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForBlock, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForPeer, benchmark::PriorityLevel::LOW);
+BENCHMARK(TxDownloadAnnounceFromManyPeers, benchmark::PriorityLevel::LOW);
+BENCHMARK(TxDownloadAnnounceFromManyPeersFourThreads, benchmark::PriorityLevel::LOW);
@@ -66,7 +66,9 @@ public:
 
     /** Encrypt a packet. Only after Initialize().
      *
-     * It must hold that output.size() == contents.size() + EXPANSION.
+     * It must hold that output.size() == contents.size() + EXPANSION. Contents may be encrypted in
+     * place, by passing output.subspan(LENGTH_LEN + HEADER_LEN, contents.size()) as contents;
+     * they must not overlap with output in any other way.
      */
     void Encrypt(std::span<const std::byte> contents, std::span<const std::byte> aad, bool ignore, std::span<std::byte> output) noexcept;
 
@@ -79,7 +81,9 @@ public:
     /** Decrypt a packet. Only after Initialize().
      *
      * It must hold that input.size() + LENGTH_LEN == contents.size() + EXPANSION.
-     * Contents.size() must equal the length returned by DecryptLength.
+     * Contents.size() must equal the length returned by DecryptLength. Contents may be decrypted
+     * in place, by passing input.subspan(HEADER_LEN, contents.size()) as contents; they must not
+     * overlap with input in any other way.
      */
     bool Decrypt(std::span<const std::byte> input, std::span<const std::byte> aad, bool& ignore, std::span<std::byte> contents) noexcept;
 
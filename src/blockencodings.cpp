@@ -13,19 +13,89 @@
 #include <random.h>
 #include <streams.h>
 #include <txmempool.h>
+#include <util/check.h>
 #include <validation.h>
 
-#include <unordered_map>
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <optional>
+#include <vector>
 
-CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce) :
-        nonce(nonce),
-        shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
+namespace {
+/**
+ * Table from the short IDs of a compact block to the positions of their
+ * transactions in the block, built once per block and then looked up for
+ * every mempool and extra transaction.
+ *
+ * Short IDs are SipHash outputs, so their low bits are used to place them in
+ * an open addressing table directly, and a lookup usually touches a single
+ * slot instead of hashing into a node based map.
+ */
+class ShortIdTable
+{
+public:
+    //! Longest run of slots an insertion may probe before the short IDs are
+    //! considered too unevenly distributed.
+    static constexpr size_t MAX_PROBES{40};
+
+    explicit ShortIdTable(size_t count)
+        : m_slots(std::bit_ceil(std::max<size_t>(4 * count, 16)), EMPTY), m_mask{m_slots.size() - 1} {}
+
+    enum class InsertResult { OK, DUPLICATE, TOO_MANY_PROBES };
+
+    InsertResult Insert(uint64_t shortid, uint16_t pos)
+    {
+        for (size_t i{0}, slot = shortid & m_mask; i < MAX_PROBES; ++i, slot = (slot + 1) & m_mask) {
+            if (m_slots[slot] == EMPTY) {
+                m_slots[slot] = (shortid << 16) | pos;
+                return InsertResult::OK;
+            }
+            if ((m_slots[slot] >> 16) == shortid) return InsertResult::DUPLICATE;
+        }
+        return InsertResult::TOO_MANY_PROBES;
+    }
+
+    //! Position of the transaction with the given short ID, if any.
+    std::optional<uint16_t> Find(uint64_t shortid) const
+    {
+        for (size_t slot = shortid & m_mask; m_slots[slot] != EMPTY; slot = (slot + 1) & m_mask) {
+            if ((m_slots[slot] >> 16) == shortid) return uint16_t(m_slots[slot]);
+        }
+        return std::nullopt;
+    }
+
+private:
+    // Slots hold the 48-bit short ID and the 16-bit position. A block has
+    // fewer than 2^16 - 1 transactions, so no slot in use is all ones.
+    static constexpr uint64_t EMPTY{std::numeric_limits<uint64_t>::max()};
+    static_assert(CBlockHeaderAndShortTxIDs::SHORTTXIDS_LENGTH == 6);
+
+    std::vector<uint64_t> m_slots;
+    const size_t m_mask;
+};
+} // namespace
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, std::span<const size_t> prefill) :
+        nonce(nonce), header(block) {
     FillShortTxIDSelector();
-    //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
-    prefilledtxn[0] = {0, block.vtx[0]};
+    Assume(std::ranges::is_sorted(prefill) && std::ranges::adjacent_find(prefill) == prefill.end());
+    shorttxids.reserve(block.vtx.size() - 1);
+    prefilledtxn.reserve(1 + prefill.size());
+    // The coinbase is always prefilled. Prefilled indexes are stored as offsets
+    // from the previous prefilled transaction.
+    prefilledtxn.push_back({0, block.vtx[0]});
+    size_t last_prefilled{0};
+    auto next_prefill{std::ranges::upper_bound(prefill, 0)};
     for (size_t i = 1; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        shorttxids[i - 1] = GetShortID(tx.GetWitnessHash());
+        if (next_prefill != prefill.end() && *next_prefill == i) {
+            prefilledtxn.push_back({uint16_t(i - last_prefilled - 1), block.vtx[i]});
+            last_prefilled = i;
+            ++next_prefill;
+        } else {
+            shorttxids.push_back(GetShortID(tx.GetWitnessHash()));
+        }
     }
 }
 
@@ -79,47 +149,44 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     // Because well-formed cmpctblock messages will have a (relatively) uniform distribution
     // of short IDs, any highly-uneven distribution of elements can be safely treated as a
     // READ_STATUS_FAILED.
-    std::unordered_map<uint64_t, uint16_t> shorttxids(cmpctblock.shorttxids.size());
+    ShortIdTable shorttxids(cmpctblock.shorttxids.size());
     uint16_t index_offset = 0;
     for (size_t i = 0; i < cmpctblock.shorttxids.size(); i++) {
         while (txn_available[i + index_offset])
             index_offset++;
-        shorttxids[cmpctblock.shorttxids[i]] = i + index_offset;
-        // To determine the chance that the number of entries in a bucket exceeds N,
-        // we use the fact that the number of elements in a single bucket is
-        // binomially distributed (with n = the number of shorttxids S, and p =
-        // 1 / the number of buckets), that in the worst case the number of buckets is
-        // equal to S (due to std::unordered_map having a default load factor of 1.0),
-        // and that the chance for any bucket to exceed N elements is at most
-        // buckets * (the chance that any given bucket is above N elements).
-        // Thus: P(max_elements_per_bucket > N) <= S * (1 - cdf(binomial(n=S,p=1/S), N)).
-        // If we assume blocks of up to 16000, allowing 12 elements per bucket should
-        // only fail once per ~1 million block transfers (per peer and connection).
-        if (shorttxids.bucket_size(shorttxids.bucket(cmpctblock.shorttxids[i])) > 12)
+        // The table is kept at most a quarter full. For a load factor a, the chance
+        // that an insertion into a linear probing table has to probe more than N
+        // slots drops roughly as (a * e^(1 - a))^N, so with blocks of up to 16000
+        // transactions, MAX_PROBES should only be exceeded once per ~1 million
+        // block transfers (per peer and connection).
+        switch (shorttxids.Insert(cmpctblock.shorttxids[i], i + index_offset)) {
+        case ShortIdTable::InsertResult::OK:
+            break;
+        case ShortIdTable::InsertResult::TOO_MANY_PROBES:
             return READ_STATUS_FAILED;
+        case ShortIdTable::InsertResult::DUPLICATE:
+            // TODO: in the shortid-collision case, we should instead request both transactions
+            // which collided. Falling back to full-block-request here is overkill.
+            return READ_STATUS_FAILED; // Short ID collision
+        }
     }
-    // TODO: in the shortid-collision case, we should instead request both transactions
-    // which collided. Falling back to full-block-request here is overkill.
-    if (shorttxids.size() != cmpctblock.shorttxids.size())
-        return READ_STATUS_FAILED; // Short ID collision
 
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
     for (const auto& tx : pool->txns_randomized) {
         uint64_t shortid = cmpctblock.GetShortID(tx->GetWitnessHash());
-        std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = tx;
-                have_txn[idit->second]  = true;
+        if (const auto pos{shorttxids.Find(shortid)}) {
+            if (!have_txn[*pos]) {
+                txn_available[*pos] = tx;
+                have_txn[*pos]  = true;
                 mempool_count++;
             } else {
                 // If we find two mempool txn that match the short id, just request it.
                 // This should be rare enough that the extra bandwidth doesn't matter,
                 // but eating a round-trip due to FillBlock failure would be annoying
-                if (txn_available[idit->second]) {
-                    txn_available[idit->second].reset();
+                if (txn_available[*pos]) {
+                    txn_available[*pos].reset();
                     mempool_count--;
                 }
             }
@@ -127,7 +194,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         // Though ideally we'd continue scanning for the two-txn-match-shortid case,
         // the performance win of an early exit here is too good to pass up and worth
         // the extra risk.
-        if (mempool_count == shorttxids.size())
+        if (mempool_count == cmpctblock.shorttxids.size())
             break;
     }
     }
@@ -137,11 +204,10 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
             continue;
         }
         uint64_t shortid = cmpctblock.GetShortID(extra_txn[i]->GetWitnessHash());
-        std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = extra_txn[i];
-                have_txn[idit->second]  = true;
+        if (const auto pos{shorttxids.Find(shortid)}) {
+            if (!have_txn[*pos]) {
+                txn_available[*pos] = extra_txn[i];
+                have_txn[*pos]  = true;
                 mempool_count++;
                 extra_count++;
             } else {
@@ -151,9 +217,9 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
                 // but eating a round-trip due to FillBlock failure would be annoying
                 // Note that we don't want duplication between extra_txn and mempool to
                 // trigger this case, so we compare witness hashes first
-                if (txn_available[idit->second] &&
-                        txn_available[idit->second]->GetWitnessHash() != extra_txn[i]->GetWitnessHash()) {
-                    txn_available[idit->second].reset();
+                if (txn_available[*pos] &&
+                        txn_available[*pos]->GetWitnessHash() != extra_txn[i]->GetWitnessHash()) {
+                    txn_available[*pos].reset();
                     mempool_count--;
                     extra_count--;
                 }
@@ -162,7 +228,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         // Though ideally we'd continue scanning for the two-txn-match-shortid case,
         // the performance win of an early exit here is too good to pass up and worth
         // the extra risk.
-        if (mempool_count == shorttxids.size())
+        if (mempool_count == cmpctblock.shorttxids.size())
             break;
     }
 
@@ -8,6 +8,7 @@
 #include <primitives/block.h>
 
 #include <functional>
+#include <span>
 
 class CTxMemPool;
 class BlockValidationState;
@@ -110,9 +111,11 @@ public:
     CBlockHeaderAndShortTxIDs() = default;
 
     /**
-     * @param[in]  nonce  This should be randomly generated, and is used for the siphash secret key
+     * @param[in]  nonce    This should be randomly generated, and is used for the siphash secret key
+     * @param[in]  prefill  Sorted positions of the transactions to send in full besides the
+     *                      coinbase, e.g. the ones the receiver is unlikely to have
      */
-    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce);
+    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, std::span<const size_t> prefill = {});
 
     uint64_t GetShortID(const Wtxid& wtxid) const;
 
@@ -6,6 +6,7 @@
 #include <set>
 
 #include <blockfilter.h>
+#include <blockview.h>
 #include <crypto/siphash.h>
 #include <hash.h>
 #include <primitives/block.h>
@@ -182,6 +183,17 @@ const std::string& ListBlockFilterTypes()
     return type_list;
 }
 
+static void AddSpentScripts(GCSFilter::ElementSet& elements, const CBlockUndo& block_undo)
+{
+    for (const CTxUndo& tx_undo : block_undo.vtxundo) {
+        for (const Coin& prevout : tx_undo.vprevout) {
+            const CScript& script = prevout.out.scriptPubKey;
+            if (script.empty()) continue;
+            elements.emplace(script.begin(), script.end());
+        }
+    }
+}
+
 static GCSFilter::ElementSet BasicFilterElements(const CBlock& block,
                                                  const CBlockUndo& block_undo)
 {
@@ -195,14 +207,23 @@ static GCSFilter::ElementSet BasicFilterElements(const CBlock& block,
         }
     }
 
-    for (const CTxUndo& tx_undo : block_undo.vtxundo) {
-        for (const Coin& prevout : tx_undo.vprevout) {
-            const CScript& script = prevout.out.scriptPubKey;
-            if (script.empty()) continue;
+    AddSpentScripts(elements, block_undo);
+    return elements;
+}
+
+static GCSFilter::ElementSet BasicFilterElements(const BlockView& block,
+                                                 const CBlockUndo& block_undo)
+{
+    GCSFilter::ElementSet elements;
+
+    for (size_t i = 0; i < block.TxCount(); ++i) {
+        block.ForEachOutput(i, [&](CAmount, std::span<const unsigned char> script) {
+            if (script.empty() || script[0] == OP_RETURN) return;
             elements.emplace(script.begin(), script.end());
-        }
+        });
     }
 
+    AddSpentScripts(elements, block_undo);
     return elements;
 }
 
@@ -227,6 +248,16 @@ BlockFilter::BlockFilter(BlockFilterType filter_type, const CBlock& block, const
     m_filter = GCSFilter(params, BasicFilterElements(block, block_undo));
 }
 
+BlockFilter::BlockFilter(BlockFilterType filter_type, const BlockView& block, const CBlockUndo& block_undo)
+    : m_filter_type(filter_type), m_block_hash(block.GetHash())
+{
+    GCSFilter::Params params;
+    if (!BuildParams(params)) {
+        throw std::invalid_argument("unknown filter_type");
+    }
+    m_filter = GCSFilter(params, BasicFilterElements(block, block_undo));
+}
+
 bool BlockFilter::BuildParams(GCSFilter::Params& params) const
 {
     switch (m_filter_type) {
@@ -18,6 +18,7 @@
 #include <uint256.h>
 #include <util/bytevectorhash.h>
 
+class BlockView;
 class CBlock;
 class CBlockUndo;
 
@@ -131,6 +132,9 @@ public:
     //! Construct a new BlockFilter of the specified type from a block.
     BlockFilter(BlockFilterType filter_type, const CBlock& block, const CBlockUndo& block_undo);
 
+    //! Construct a new BlockFilter of the specified type from a lazily parsed block.
+    BlockFilter(BlockFilterType filter_type, const BlockView& block, const CBlockUndo& block_undo);
+
     BlockFilterType GetFilterType() const { return m_filter_type; }
     const uint256& GetBlockHash() const LIFETIMEBOUND { return m_block_hash; }
     const GCSFilter& GetFilter() const LIFETIMEBOUND { return m_filter; }
@@ -0,0 +1,120 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockview.h>
+
+#include <hash.h>
+#include <serialize.h>
+#include <streams.h>
+#include <util/check.h>
+
+#include <ios>
+
+namespace {
+/** Skip n bytes, failing like a read past the end would. */
+void Skip(SpanReader& reader, uint64_t n)
+{
+    if (n > reader.size()) throw std::ios_base::failure("BlockView: end of data");
+    reader.ignore(n);
+}
+
+/** Skip over a serialized vector of inputs and return how many there were. */
+uint64_t SkipInputs(SpanReader& reader)
+{
+    const uint64_t count{ReadCompactSize(reader)};
+    for (uint64_t i{0}; i < count; ++i) {
+        Skip(reader, 32 + 4);                   // prevout
+        Skip(reader, ReadCompactSize(reader)); // scriptSig
+        Skip(reader, 4);                        // nSequence
+    }
+    return count;
+}
+
+void SkipOutputs(SpanReader& reader)
+{
+    const uint64_t count{ReadCompactSize(reader)};
+    for (uint64_t i{0}; i < count; ++i) {
+        Skip(reader, 8);                        // nValue
+        Skip(reader, ReadCompactSize(reader)); // scriptPubKey
+    }
+}
+} // namespace
+
+BlockView::BlockView(std::span<const std::byte> block_data)
+    : m_data{block_data}
+{
+    SpanReader reader{m_data};
+    const auto offset{[&] { return uint32_t(m_data.size() - reader.size()); }};
+
+    reader >> m_header;
+    const uint64_t tx_count{ReadCompactSize(reader)};
+    // Every transaction takes at least 10 bytes, which bounds the reservation by the data size.
+    if (tx_count > reader.size() / 10) throw std::ios_base::failure("BlockView: transaction count too large");
+    m_txs.reserve(tx_count);
+    for (uint64_t i{0}; i < tx_count; ++i) {
+        TxPos& pos{m_txs.emplace_back()};
+        pos.begin = offset();
+        Skip(reader, 4); // nVersion
+        pos.inputs = offset();
+        uint64_t input_count{SkipInputs(reader)};
+        uint8_t flags{0};
+        if (input_count == 0) {
+            // Same extended format detection as UnserializeTransaction: a zero
+            // flags byte is the (empty) output vector of a transaction without inputs.
+            reader >> flags;
+            if (flags != 0) {
+                pos.inputs = offset();
+                input_count = SkipInputs(reader);
+                SkipOutputs(reader);
+            }
+        } else {
+            SkipOutputs(reader);
+        }
+        pos.witness = offset();
+        if (flags & 1) {
+            for (uint64_t j{0}; j < input_count; ++j) {
+                const uint64_t stack_size{ReadCompactSize(reader)};
+                for (uint64_t k{0}; k < stack_size; ++k) {
+                    Skip(reader, ReadCompactSize(reader));
+                }
+            }
+            flags ^= 1;
+        }
+        if (flags) throw std::ios_base::failure("Unknown transaction optional data");
+        Skip(reader, 4); // nLockTime
+        pos.end = offset();
+    }
+}
+
+std::span<const std::byte> BlockView::TxData(size_t i) const
+{
+    const TxPos& pos{m_txs.at(i)};
+    return m_data.subspan(pos.begin, pos.end - pos.begin);
+}
+
+Txid BlockView::GetTxid(size_t i) const
+{
+    const TxPos& pos{m_txs.at(i)};
+    HashWriter hasher{};
+    hasher.write(m_data.subspan(pos.begin, 4));
+    hasher.write(m_data.subspan(pos.inputs, pos.witness - pos.inputs));
+    hasher.write(m_data.subspan(pos.end - 4, 4));
+    return Txid::FromUint256(hasher.GetHash());
+}
+
+void BlockView::ForEachOutput(size_t i, const std::function<void(CAmount, std::span<const unsigned char>)>& fn) const
+{
+    const TxPos& pos{m_txs.at(i)};
+    SpanReader reader{m_data.subspan(pos.inputs, pos.witness - pos.inputs)};
+    SkipInputs(reader);
+    const uint64_t count{ReadCompactSize(reader)};
+    for (uint64_t j{0}; j < count; ++j) {
+        CAmount value;
+        reader >> value;
+        const uint64_t script_size{ReadCompactSize(reader)};
+        Skip(reader, script_size);
+        const size_t script_end{pos.witness - reader.size()};
+        fn(value, UCharSpanCast(m_data.subspan(script_end - script_size, script_size)));
+    }
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKVIEW_H
+#define BITCOIN_BLOCKVIEW_H
+
+#include <consensus/amount.h>
+#include <primitives/block.h>
+#include <uint256.h>
+#include <util/transaction_identifier.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+/**
+ * Read-only view of a serialized block that only decodes what is asked for.
+ *
+ * Construction parses the header and records where every transaction and its
+ * inputs, outputs and witness data start, without allocating anything per
+ * transaction. Transaction ids and output scripts are then read straight from
+ * the underlying buffer, which must outlive the view.
+ *
+ * This is meant for consumers such as the block indexes that only need a few
+ * fields of every block and would otherwise pay for deserializing a full
+ * CBlock. It does not validate anything beyond the serialization format.
+ */
+class BlockView
+{
+public:
+    /** Offsets of the parts of a serialized transaction within the block data. */
+    struct TxPos {
+        uint32_t begin;   //!< nVersion
+        uint32_t inputs;  //!< vin, after the segwit marker and flag if present
+        uint32_t witness; //!< witness data if present, otherwise nLockTime
+        uint32_t end;     //!< one past nLockTime
+    };
+
+    /**
+     * Parse the block header and the position of each transaction.
+     *
+     * @throws std::ios_base::failure if block_data is not a well-formed block serialization.
+     */
+    explicit BlockView(std::span<const std::byte> block_data LIFETIMEBOUND);
+
+    const CBlockHeader& GetHeader() const LIFETIMEBOUND { return m_header; }
+    uint256 GetHash() const { return m_header.GetHash(); }
+
+    size_t TxCount() const { return m_txs.size(); }
+
+    /** Full serialization of transaction i, including witness data. */
+    std::span<const std::byte> TxData(size_t i) const LIFETIMEBOUND;
+
+    /** The txid of transaction i, hashed from its serialization without witness data. */
+    Txid GetTxid(size_t i) const;
+
+    /** Call fn with the value and script of every output of transaction i. */
+    void ForEachOutput(size_t i, const std::function<void(CAmount, std::span<const unsigned char>)>& fn) const;
+
+private:
+    std::span<const std::byte> m_data;
+    CBlockHeader m_header;
+    std::vector<TxPos> m_txs;
+};
+
+#endif // BITCOIN_BLOCKVIEW_H
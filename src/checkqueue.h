@@ -8,11 +8,16 @@
 #include <logging.h>
 #include <sync.h>
 #include <tinyformat.h>
+#include <util/thread.h>
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <iterator>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -28,11 +33,22 @@
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
   *
+  * Every worker has a queue of its own, which the batches are spread over.
+  * A worker takes verifications from the back of its own queue, and when that
+  * is empty, steals them from the front of the other ones, so the workers only
+  * contend for the queue mutexes when they run out of work.
+  *
   */
 template <typename T, typename R = std::remove_cvref_t<decltype(std::declval<T>()().value())>>
 class CCheckQueue
 {
 private:
+    //! Verifications waiting to be taken by one of the workers.
+    struct alignas(64) WorkQueue {
+        Mutex m_mutex;
+        std::deque<T> checks GUARDED_BY(m_mutex);
+    };
+
     //! Mutex to protect the inner state
     Mutex m_mutex;
 
@@ -42,25 +58,36 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
+    //! The queues of elements to be processed, one per worker thread (and one
+    //! if there are no worker threads). As the order of booleans doesn't
+    //! matter, the own queue is used as a LIFO (stack).
+    std::vector<WorkQueue> m_queues;
+
+    //! The queue the next batch is added to. Only used by the master.
+    size_t m_next_queue{0};
+
+    /**
+     * Number of elements in the queues. It is increased before elements are
+     * queued and decreased after they are taken, so it is never smaller than
+     * the actual number.
+     */
+    std::atomic<unsigned int> m_num_queued{0};
 
     //! The number of workers (including the master) that are idle.
     int nIdle GUARDED_BY(m_mutex){0};
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
-
     //! The temporary evaluation result.
     std::optional<R> m_result GUARDED_BY(m_mutex);
 
+    //! Whether m_result is set, so the remaining verifications can be skipped.
+    std::atomic<bool> m_has_result{false};
+
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<unsigned int> nTodo{0};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
@@ -68,39 +95,52 @@ private:
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
+    /**
+     * Take a batch of elements, from the back of the worker's own queue or the
+     * front of the first other queue that is not empty. Half of the queue is
+     * taken (but at least one element and at most nBatchSize), so the batches
+     * become smaller as the queues run empty and all workers finish
+     * approximately simultaneously.
+     */
+    bool TakeChecks(std::optional<size_t> own_queue, std::vector<T>& checks)
+    {
+        if (m_num_queued.load(std::memory_order_relaxed) == 0) return false;
+        const size_t first{own_queue.value_or(0)};
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            WorkQueue& queue{m_queues[(first + i) % m_queues.size()]};
+            LOCK(queue.m_mutex);
+            if (queue.checks.empty()) continue;
+            const size_t count{std::clamp<size_t>(queue.checks.size() / 2, 1, nBatchSize)};
+            if (own_queue && i == 0) {
+                const auto start_it{queue.checks.end() - count};
+                checks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.checks.end()));
+                queue.checks.erase(start_it, queue.checks.end());
+            } else {
+                const auto end_it{queue.checks.begin() + count};
+                checks.assign(std::make_move_iterator(queue.checks.begin()), std::make_move_iterator(end_it));
+                queue.checks.erase(queue.checks.begin(), end_it);
+            }
+            m_num_queued -= count;
+            return true;
+        }
+        return false;
+    }
+
     /** Internal function that does bulk of the verification work. If fMaster, return the final result. */
-    std::optional<R> Loop(bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    std::optional<R> Loop(bool fMaster, std::optional<size_t> own_queue = std::nullopt) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        std::optional<R> local_result;
-        bool do_work;
         do {
-            {
+            if (!TakeChecks(own_queue, vChecks)) {
                 WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    if (local_result.has_value() && !m_result.has_value()) {
-                        std::swap(local_result, m_result);
-                    }
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster) {
-                        // We processed the last element; inform the master it can exit and return the result
-                        m_master_cv.notify_one();
-                    }
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
+                while (m_num_queued == 0 && !m_request_stop) {
                     if (fMaster && nTodo == 0) {
-                        nTotal--;
                         std::optional<R> to_return = std::move(m_result);
                         // reset the status for new work later
                         m_result = std::nullopt;
+                        m_has_result = false;
                         // return the current status
                         return to_return;
                     }
@@ -112,27 +152,32 @@ private:
                     // return value does not matter, because m_request_stop is only set in the destructor.
                     return std::nullopt;
                 }
-
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                auto start_it = queue.end() - nNow;
-                vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.end()));
-                queue.erase(start_it, queue.end());
-                // Check whether we need to do work at all
-                do_work = !m_result.has_value();
+                continue;
             }
-            // execute work
-            if (do_work) {
+
+            // execute work, unless another verification failed already
+            std::optional<R> local_result;
+            if (!m_has_result.load(std::memory_order_relaxed)) {
                 for (T& check : vChecks) {
                     local_result = check();
                     if (local_result.has_value()) break;
                 }
             }
+            // The elements are destroyed before they are counted as completed.
+            const unsigned int nNow = vChecks.size();
             vChecks.clear();
+            if (local_result.has_value()) {
+                LOCK(m_mutex);
+                if (!m_result.has_value()) {
+                    std::swap(local_result, m_result);
+                    m_has_result = true;
+                }
+            }
+            if (nTodo.fetch_sub(nNow) == nNow && !fMaster) {
+                // We processed the last element; inform the master it can exit and return the result.
+                // The lock makes sure the master is either waiting or has yet to see nTodo.
+                WITH_LOCK(m_mutex, m_master_cv.notify_one());
+            }
         } while (true);
     }
 
@@ -140,16 +185,25 @@ public:
     //! Mutex to ensure only one concurrent CCheckQueueControl
     Mutex m_control_mutex;
 
-    //! Create a new check queue
-    explicit CCheckQueue(unsigned int batch_size, int worker_threads_num)
-        : nBatchSize(batch_size)
+    //! Create a new check queue. The description and thread name prefix
+    //! identify what the queue is used for in logs. If pin_threads is set, the
+    //! worker threads are pinned to the CPUs the process may run on, in order,
+    //! where supported.
+    explicit CCheckQueue(unsigned int batch_size, int worker_threads_num,
+                         std::string_view description = "Script verification", std::string_view thread_name = "scriptch",
+                         bool pin_threads = false)
+        : m_queues(std::max(worker_threads_num, 1)),
+          nBatchSize(batch_size)
     {
-        LogInfo("Script verification uses %d additional threads", worker_threads_num);
+        LogInfo("%s uses %d additional threads%s", description, worker_threads_num, pin_threads ? " pinned to CPUs" : "");
         m_worker_threads.reserve(worker_threads_num);
         for (int n = 0; n < worker_threads_num; ++n) {
-            m_worker_threads.emplace_back([this, n]() {
-                util::ThreadRename(strprintf("scriptch.%i", n));
-                Loop(false /* worker thread */);
+            m_worker_threads.emplace_back([this, n, pin_threads, thread_name = std::string{thread_name}]() {
+                util::ThreadRename(strprintf("%s.%i", thread_name, n));
+                if (pin_threads && !util::ThreadPinToCPU(n)) {
+                    LogDebug(BCLog::VALIDATION, "Could not pin thread %s.%i to a CPU", thread_name, n);
+                }
+                Loop(false /* worker thread */, n);
             });
         }
     }
@@ -175,12 +229,20 @@ public:
             return;
         }
 
-        {
-            LOCK(m_mutex);
-            queue.insert(queue.end(), std::make_move_iterator(vChecks.begin()), std::make_move_iterator(vChecks.end()));
-            nTodo += vChecks.size();
+        nTodo += vChecks.size();
+        m_num_queued += vChecks.size();
+        // Spread the checks over the queues, at most nBatchSize at a time.
+        for (auto it = vChecks.begin(); it != vChecks.end();) {
+            const auto end_it{it + std::min<size_t>(nBatchSize, vChecks.end() - it)};
+            WorkQueue& queue{m_queues[m_next_queue++ % m_queues.size()]};
+            LOCK(queue.m_mutex);
+            queue.checks.insert(queue.checks.end(), std::make_move_iterator(it), std::make_move_iterator(end_it));
+            it = end_it;
         }
 
+        // Synchronize with idle workers, which check m_num_queued under the
+        // lock before they wait.
+        if (WITH_LOCK(m_mutex, return nIdle) == 0) return;
         if (vChecks.size() == 1) {
             m_worker_cv.notify_one();
         } else {
@@ -198,11 +260,19 @@ public:
     }
 
     bool HasThreads() const { return !m_worker_threads.empty(); }
+
+    //! The maximum number of elements processed in one batch.
+    unsigned int BatchSize() const { return nBatchSize; }
 };
 
 /**
  * RAII-style controller object for a CCheckQueue that guarantees the passed
  * queue is finished before continuing.
+ *
+ * The checks added through the controller (typically those of the
+ * transactions of a block, one at a time) are collected and handed to the
+ * queue once there are at least as many as make up a batch, and when it is
+ * completed, so the workers are not woken up for every transaction.
  */
 template <typename T, typename R = std::remove_cvref_t<decltype(std::declval<T>()().value())>>
 class SCOPED_LOCKABLE CCheckQueueControl
@@ -211,6 +281,14 @@ private:
     CCheckQueue<T, R>& m_queue;
     UniqueLock<Mutex> m_lock;
     bool fDone;
+    //! Checks that were added but not handed to the queue yet
+    std::vector<T> m_pending;
+
+    void Flush()
+    {
+        m_queue.Add(std::move(m_pending));
+        m_pending.clear();
+    }
 
 public:
     CCheckQueueControl() = delete;
@@ -220,6 +298,7 @@ public:
 
     std::optional<R> Complete()
     {
+        Flush();
         auto ret = m_queue.Complete();
         fDone = true;
         return ret;
@@ -227,7 +306,12 @@ public:
 
     void Add(std::vector<T>&& vChecks)
     {
-        m_queue.Add(std::move(vChecks));
+        if (m_pending.empty()) {
+            m_pending = std::move(vChecks);
+        } else {
+            m_pending.insert(m_pending.end(), std::make_move_iterator(vChecks.begin()), std::make_move_iterator(vChecks.end()));
+        }
+        if (m_pending.size() >= m_queue.BatchSize()) Flush();
     }
 
     ~CCheckQueueControl() UNLOCK_FUNCTION()
@@ -4,9 +4,11 @@
 
 #include <coins.h>
 
+#include <attributes.h>
 #include <consensus/consensus.h>
 #include <logging.h>
 #include <random.h>
+#include <streams.h>
 #include <util/trace.h>
 
 TRACEPOINT_SEMAPHORE(utxocache, add);
@@ -42,13 +44,89 @@ CCoinsViewCache::CCoinsViewCache(CCoinsView* baseIn, bool deterministic) :
 }
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
-    return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
+    size_t usage{memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage};
+    if (m_compact_coins) usage += memusage::DynamicUsage(*m_compact_coins) + m_compact_coins_usage;
+    return usage;
+}
+
+namespace {
+/** Minimal output stream appending to a CompactCoin. */
+class CompactCoinWriter
+{
+    CompactCoin& m_data;
+
+public:
+    explicit CompactCoinWriter(CompactCoin& data LIFETIMEBOUND) : m_data{data} {}
+
+    void write(std::span<const std::byte> src)
+    {
+        m_data.insert(m_data.end(), UCharCast(src.data()), UCharCast(src.data() + src.size()));
+    }
+
+    template <typename T>
+    CompactCoinWriter& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+};
+} // namespace
+
+CompactCoin CompressCoin(const Coin& coin)
+{
+    CompactCoin compact;
+    // Coins that do not fit inline get an exactly sized allocation.
+    compact.reserve(GetSerializeSize(coin));
+    CompactCoinWriter{compact} << coin;
+    return compact;
+}
+
+void CCoinsViewCache::EnableCompactCoins()
+{
+    m_compact_coins_enabled = true;
+}
+
+CCompactCoinsMap& CCoinsViewCache::CompactCoins() const
+{
+    if (!m_compact_coins) {
+        m_compact_coins_memory_resource = std::make_unique<CCompactCoinsMapMemoryResource>();
+        m_compact_coins = std::make_unique<CCompactCoinsMap>(0, SaltedOutpointHasher{/*deterministic=*/m_deterministic}, CCompactCoinsMap::key_equal{}, m_compact_coins_memory_resource.get());
+    }
+    return *m_compact_coins;
+}
+
+const CompactCoin* CCoinsViewCache::FetchCompactCoin(const COutPoint& outpoint) const
+{
+    if (m_compact_coins) {
+        if (const auto it{m_compact_coins->find(outpoint)}; it != m_compact_coins->end()) return &it->second;
+    }
+    auto coin{base->GetCoin(outpoint)};
+    if (!coin || coin->IsSpent()) return nullptr;
+    auto compact{CompressCoin(*coin)};
+    m_compact_coins_usage += memusage::DynamicUsage(compact);
+    return &CompactCoins().emplace(outpoint, std::move(compact)).first->second;
+}
+
+std::optional<Coin> CCoinsViewCache::TakeCompactCoin(const COutPoint& outpoint) const
+{
+    if (!m_compact_coins) return std::nullopt;
+    const auto it{m_compact_coins->find(outpoint)};
+    if (it == m_compact_coins->end()) return std::nullopt;
+    Coin coin;
+    SpanReader{it->second} >> coin;
+    m_compact_coins_usage -= memusage::DynamicUsage(it->second);
+    m_compact_coins->erase(it);
+    return coin;
 }
 
 CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const {
     const auto [ret, inserted] = cacheCoins.try_emplace(outpoint);
     if (inserted) {
-        if (auto coin{base->GetCoin(outpoint)}) {
+        if (auto coin{TakeCompactCoin(outpoint)}) {
+            // An unmodified coin that was compacted; it is not flagged, just as it was before.
+            ret->second.coin = std::move(*coin);
+            cachedCoinsUsage += ret->second.coin.DynamicMemoryUsage();
+        } else if (auto coin{base->GetCoin(outpoint)}) {
             ret->second.coin = std::move(*coin);
             cachedCoinsUsage += ret->second.coin.DynamicMemoryUsage();
             if (ret->second.coin.IsSpent()) { // TODO GetCoin cannot return spent coins
@@ -65,6 +143,14 @@ CCoinsMap::iterator CCoinsViewCache::FetchCoin(const COutPoint &outpoint) const
 
 std::optional<Coin> CCoinsViewCache::GetCoin(const COutPoint& outpoint) const
 {
+    // Hand out a copy without expanding the coin in this cache.
+    if (m_compact_coins_enabled && !cacheCoins.contains(outpoint)) {
+        const CompactCoin* compact{FetchCompactCoin(outpoint)};
+        if (!compact) return std::nullopt;
+        Coin coin;
+        SpanReader{*compact} >> coin;
+        return coin;
+    }
     if (auto it{FetchCoin(outpoint)}; it != cacheCoins.end() && !it->second.coin.IsSpent()) return it->second.coin;
     return std::nullopt;
 }
@@ -76,8 +162,12 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
     bool inserted;
     std::tie(it, inserted) = cacheCoins.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::tuple<>());
     bool fresh = false;
-    if (!inserted) {
-        cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    if (inserted) {
+        if (auto compact{TakeCompactCoin(outpoint)}) {
+            // Treat a compacted coin like the unmodified entry it is.
+            it->second.coin = std::move(*compact);
+            cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+        }
     }
     if (!possible_overwrite) {
         if (!it->second.coin.IsSpent()) {
@@ -98,6 +188,7 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
         // DIRTY, then it can be marked FRESH.
         fresh = !it->second.IsDirty();
     }
+    cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
     it->second.coin = std::move(coin);
     CCoinsCacheEntry::SetDirty(*it, m_sentinel);
     if (fresh) CCoinsCacheEntry::SetFresh(*it, m_sentinel);
@@ -111,6 +202,10 @@ void CCoinsViewCache::AddCoin(const COutPoint &outpoint, Coin&& coin, bool possi
 }
 
 void CCoinsViewCache::EmplaceCoinInternalDANGER(COutPoint&& outpoint, Coin&& coin) {
+    if (m_compact_coins && m_compact_coins->contains(outpoint)) {
+        // A compacted coin is kept, just like an unmodified entry in cacheCoins.
+        return;
+    }
     cachedCoinsUsage += coin.DynamicMemoryUsage();
     auto [it, inserted] = cacheCoins.try_emplace(std::move(outpoint), std::move(coin));
     if (inserted) CCoinsCacheEntry::SetDirty(*it, m_sentinel);
@@ -161,13 +256,15 @@ const Coin& CCoinsViewCache::AccessCoin(const COutPoint &outpoint) const {
 }
 
 bool CCoinsViewCache::HaveCoin(const COutPoint &outpoint) const {
+    if (m_compact_coins_enabled && !cacheCoins.contains(outpoint)) return FetchCompactCoin(outpoint) != nullptr;
     CCoinsMap::const_iterator it = FetchCoin(outpoint);
     return (it != cacheCoins.end() && !it->second.coin.IsSpent());
 }
 
 bool CCoinsViewCache::HaveCoinInCache(const COutPoint &outpoint) const {
     CCoinsMap::const_iterator it = cacheCoins.find(outpoint);
-    return (it != cacheCoins.end() && !it->second.coin.IsSpent());
+    if (it == cacheCoins.end()) return m_compact_coins && m_compact_coins->contains(outpoint);
+    return !it->second.coin.IsSpent();
 }
 
 uint256 CCoinsViewCache::GetBestBlock() const {
@@ -187,6 +284,13 @@ bool CCoinsViewCache::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &ha
             continue;
         }
         CCoinsMap::iterator itUs = cacheCoins.find(it->first);
+        if (itUs == cacheCoins.end()) {
+            if (auto compact{TakeCompactCoin(it->first)}) {
+                // Expand a compacted coin so it is handled as the unmodified entry it was.
+                itUs = cacheCoins.try_emplace(it->first, std::move(*compact)).first;
+                cachedCoinsUsage += itUs->second.coin.DynamicMemoryUsage();
+            }
+        }
         if (itUs == cacheCoins.end()) {
             // The parent cache does not have an entry, while the child cache does.
             // We can ignore it if it's both spent and FRESH in the child
@@ -252,6 +356,9 @@ bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cursor, hashBlock);
     if (fOk) {
         cacheCoins.clear();
+        m_compact_coins.reset();
+        m_compact_coins_memory_resource.reset();
+        m_compact_coins_usage = 0;
         ReallocateCache();
     }
     cachedCoinsUsage = 0;
@@ -260,19 +367,33 @@ bool CCoinsViewCache::Flush() {
 
 bool CCoinsViewCache::Sync()
 {
-    auto cursor{CoinsViewCacheCursor(cachedCoinsUsage, m_sentinel, cacheCoins, /*will_erase=*/false)};
+    // The unspent coins that are kept are unmodified from now on, so they are
+    // moved into the compact store while being written.
+    CCompactCoinsMap* compact_coins{m_compact_coins_enabled && !cacheCoins.empty() ? &CompactCoins() : nullptr};
+    auto cursor{CoinsViewCacheCursor(cachedCoinsUsage, m_sentinel, cacheCoins, /*will_erase=*/false,
+                                     compact_coins, &m_compact_coins_usage)};
     bool fOk = base->BatchWrite(cursor, hashBlock);
     if (fOk) {
         if (m_sentinel.second.Next() != &m_sentinel) {
             /* BatchWrite must clear flags of all entries */
             throw std::logic_error("Not all unspent flagged entries were cleared");
         }
+        // The pool backing cacheCoins keeps its chunks after erasing. Hand them
+        // back if every entry was moved to the compact store.
+        if (compact_coins && cacheCoins.empty()) ReallocateCache();
     }
     return fOk;
 }
 
 void CCoinsViewCache::Uncache(const COutPoint& hash)
 {
+    if (m_compact_coins) {
+        if (auto it{m_compact_coins->find(hash)}; it != m_compact_coins->end()) {
+            m_compact_coins_usage -= memusage::DynamicUsage(it->second);
+            m_compact_coins->erase(it);
+            return;
+        }
+    }
     CCoinsMap::iterator it = cacheCoins.find(hash);
     if (it != cacheCoins.end() && !it->second.IsDirty() && !it->second.IsFresh()) {
         cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
@@ -287,7 +408,7 @@ void CCoinsViewCache::Uncache(const COutPoint& hash)
 }
 
 unsigned int CCoinsViewCache::GetCacheSize() const {
-    return cacheCoins.size();
+    return cacheCoins.size() + (m_compact_coins ? m_compact_coins->size() : 0);
 }
 
 bool CCoinsViewCache::HaveInputs(const CTransaction& tx) const
@@ -343,6 +464,16 @@ void CCoinsViewCache::SanityCheck() const
     }
     assert(count_linked == count_flagged);
     assert(recomputed_usage == cachedCoinsUsage);
+
+    if (m_compact_coins) {
+        size_t recomputed_compact_usage = 0;
+        for (const auto& [outpoint, compact] : *m_compact_coins) {
+            // A coin is either expanded or compacted, never both.
+            assert(!cacheCoins.contains(outpoint));
+            recomputed_compact_usage += memusage::DynamicUsage(compact);
+        }
+        assert(recomputed_compact_usage == m_compact_coins_usage);
+    }
 }
 
 static const size_t MIN_TRANSACTION_OUTPUT_WEIGHT = WITNESS_SCALE_FACTOR * ::GetSerializeSize(CTxOut());
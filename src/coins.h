@@ -9,6 +9,7 @@
 #include <compressor.h>
 #include <core_memusage.h>
 #include <memusage.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <support/allocators/pool.h>
@@ -20,6 +21,7 @@
 #include <cstdint>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 /**
@@ -230,6 +232,29 @@ using CCoinsMap = std::unordered_map<COutPoint,
 
 using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
+/**
+ * An unmodified Coin held in its serialized form (see Coin::Serialize). The
+ * script goes through ScriptCompression, so P2PKH, P2SH and P2PK outputs take
+ * 21-33 bytes. The 34 byte P2WSH and P2TR scripts are stored with a length
+ * byte, which together with the height and amount still fits inline for
+ * amounts below a few thousand BTC, instead of needing a separate heap
+ * allocation. 44 bytes is the largest inline size that does not make the map
+ * nodes larger.
+ */
+using CompactCoin = prevector<44, uint8_t>;
+
+using CCompactCoinsMap = std::unordered_map<COutPoint,
+                                            CompactCoin,
+                                            SaltedOutpointHasher,
+                                            std::equal_to<COutPoint>,
+                                            PoolAllocator<std::pair<const COutPoint, CompactCoin>,
+                                                          sizeof(std::pair<const COutPoint, CompactCoin>) + sizeof(void*) * 4>>;
+
+using CCompactCoinsMapMemoryResource = CCompactCoinsMap::allocator_type::ResourceType;
+
+/** Serialize an unspent coin into its CompactCoin form. */
+CompactCoin CompressCoin(const Coin& coin);
+
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
 {
@@ -271,11 +296,16 @@ struct CoinsViewCacheCursor
     //! This is an optimization compared to erasing all entries as the cursor iterates them when will_erase is set.
     //! Calling CCoinsMap::clear() afterwards is faster because a CoinsCachePair cannot be coerced back into a
     //! CCoinsMap::iterator to be erased, and must therefore be looked up again by key in the CCoinsMap before being erased.
+    //! If compact_coins is set (and will_erase is not), unspent coins are moved into it instead of
+    //! being unflagged, as they are unmodified from then on.
     CoinsViewCacheCursor(size_t& usage LIFETIMEBOUND,
                         CoinsCachePair& sentinel LIFETIMEBOUND,
                         CCoinsMap& map LIFETIMEBOUND,
-                        bool will_erase) noexcept
-        : m_usage(usage), m_sentinel(sentinel), m_map(map), m_will_erase(will_erase) {}
+                        bool will_erase,
+                        CCompactCoinsMap* compact_coins = nullptr,
+                        size_t* compact_usage = nullptr) noexcept
+        : m_usage(usage), m_sentinel(sentinel), m_map(map), m_will_erase(will_erase),
+          m_compact_coins(compact_coins), m_compact_usage(compact_usage) {}
 
     inline CoinsCachePair* Begin() const noexcept { return m_sentinel.second.Next(); }
     inline CoinsCachePair* End() const noexcept { return &m_sentinel; }
@@ -290,6 +320,12 @@ struct CoinsViewCacheCursor
             if (current.second.coin.IsSpent()) {
                 m_usage -= current.second.coin.DynamicMemoryUsage();
                 m_map.erase(current.first);
+            } else if (m_compact_coins) {
+                m_usage -= current.second.coin.DynamicMemoryUsage();
+                auto compact{CompressCoin(current.second.coin)};
+                *m_compact_usage += memusage::DynamicUsage(compact);
+                m_compact_coins->insert_or_assign(current.first, std::move(compact));
+                m_map.erase(current.first);
             } else {
                 current.second.SetClean();
             }
@@ -303,6 +339,8 @@ private:
     CoinsCachePair& m_sentinel;
     CCoinsMap& m_map;
     bool m_will_erase;
+    CCompactCoinsMap* m_compact_coins;
+    size_t* m_compact_usage;
 };
 
 /** Abstract view on the open txout dataset. */
@@ -378,6 +416,20 @@ protected:
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage{0};
 
+    /**
+     * Unmodified coins, held compactly. Coins read from the base view through
+     * GetCoin() or HaveCoin() are stored here, as are the coins Sync() keeps.
+     * They are expanded into cacheCoins when accessed by reference or
+     * modified. Only used after EnableCompactCoins(), and only allocated once
+     * the first coin is stored, so that caches holding none do not pay for it.
+     */
+    mutable std::unique_ptr<CCompactCoinsMapMemoryResource> m_compact_coins_memory_resource;
+    mutable std::unique_ptr<CCompactCoinsMap> m_compact_coins;
+
+    /* Cached dynamic memory usage for the CompactCoin objects that did not fit inline. */
+    mutable size_t m_compact_coins_usage{0};
+    bool m_compact_coins_enabled{false};
+
 public:
     CCoinsViewCache(CCoinsView *baseIn, bool deterministic = false);
 
@@ -454,6 +506,13 @@ public:
      */
     bool Sync();
 
+    /**
+     * Keep unmodified coins in compact form from now on, so that more of them
+     * fit in the same amount of memory. Meant for long-lived caches over the
+     * coins database, whose coins are mostly read by child caches.
+     */
+    void EnableCompactCoins();
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is
      * not modified.
@@ -485,6 +544,22 @@ private:
      * memory usage.
      */
     CCoinsMap::iterator FetchCoin(const COutPoint &outpoint) const;
+
+    /**
+     * Remove an outpoint from the compact store and return its expanded Coin,
+     * or std::nullopt if it was not compacted.
+     */
+    std::optional<Coin> TakeCompactCoin(const COutPoint& outpoint) const;
+
+    /**
+     * Find an outpoint that is not in cacheCoins in the compact store, reading
+     * it from the base view into the store if needed. Returns nullptr if the
+     * coin does not exist.
+     */
+    const CompactCoin* FetchCompactCoin(const COutPoint& outpoint) const;
+
+    /** The compact store, allocated on first use. */
+    CCompactCoinsMap& CompactCoins() const;
 };
 
 //! Utility function to add all of a transaction's outputs to a cache.
@@ -12,7 +12,49 @@
 
 #include <algorithm>
 #include <bit>
+#include <cassert>
 #include <cstring>
+#include <limits>
+
+#include <compat/cpuid.h>
+
+namespace chacha20_sse41
+{
+void Crypt_4way(const uint32_t* input, const std::byte* in, std::byte* out);
+}
+
+namespace chacha20_avx2
+{
+void Crypt_8way(const uint32_t* input, const std::byte* in, std::byte* out);
+}
+
+namespace {
+/** Process N blocks at the key, nonce and block counter given by input, xoring them with in
+ *  (unless it is nullptr, to output the keystream). */
+using CryptMultiFn = void (*)(const uint32_t* input, const std::byte* in, std::byte* out);
+
+CryptMultiFn Crypt_4way = nullptr;
+CryptMultiFn Crypt_8way = nullptr;
+
+/** Process as many blocks as possible with the multi-block implementations, advancing the block
+ *  counter in input. Returns the number of blocks processed. */
+size_t CryptMulti(uint32_t* input, const std::byte* in, std::byte* out, size_t blocks) noexcept
+{
+    size_t done{0};
+    for (const auto& [fn, n] : {std::pair{Crypt_8way, 8}, std::pair{Crypt_4way, 4}}) {
+        if (!fn) continue;
+        // The multi-block implementations don't carry the block counter into the nonce, leave
+        // the blocks around the overflow to the one-block implementation.
+        while (blocks - done >= size_t(n) && input[8] <= std::numeric_limits<uint32_t>::max() - (n - 1)) {
+            fn(input, in ? in + done * ChaCha20Aligned::BLOCKLEN : nullptr, out + done * ChaCha20Aligned::BLOCKLEN);
+            input[8] += n;
+            if (!input[8]) ++input[9];
+            done += n;
+        }
+    }
+    return done;
+}
+} // namespace
 
 #define QUARTERROUND(a,b,c,d) \
   a += b; d = std::rotl(d ^ a, 16); \
@@ -66,6 +108,10 @@ inline void ChaCha20Aligned::Keystream(std::span<std::byte> output) noexcept
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
+    const size_t multi_blocks = CryptMulti(input, nullptr, c, blocks);
+    blocks -= multi_blocks;
+    c += multi_blocks * BLOCKLEN;
+
     if (!blocks) return;
 
     j4 = input[0];
@@ -169,6 +215,11 @@ inline void ChaCha20Aligned::Crypt(std::span<const std::byte> in_bytes, std::spa
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
+    const size_t multi_blocks = CryptMulti(input, m, c, blocks);
+    blocks -= multi_blocks;
+    m += multi_blocks * BLOCKLEN;
+    c += multi_blocks * BLOCKLEN;
+
     if (!blocks) return;
 
     j4 = input[0];
@@ -370,3 +421,41 @@ void FSChaCha20::Crypt(std::span<const std::byte> input, std::span<std::byte> ou
         m_chunk_counter = 0;
     }
 }
+
+std::string ChaCha20AutoDetect([[maybe_unused]] chacha20_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    Crypt_4way = nullptr;
+    Crypt_8way = nullptr;
+
+#if defined(HAVE_GETCPUID)
+    [[maybe_unused]] bool have_sse41 = false;
+    [[maybe_unused]] bool have_avx2 = false;
+
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    if (use_implementation & chacha20_implementation::USE_SSE41) {
+        have_sse41 = (ecx >> 19) & 1;
+    }
+    const bool have_avx = ((ecx >> 27) & 1) && ((ecx >> 28) & 1) && AVXEnabled();
+    if (have_avx && (use_implementation & chacha20_implementation::USE_AVX2)) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        have_avx2 = (ebx >> 5) & 1;
+    }
+
+#if defined(ENABLE_SSE41)
+    if (have_sse41) {
+        Crypt_4way = chacha20_sse41::Crypt_4way;
+        ret = "sse41(4way)";
+    }
+#endif
+#if defined(ENABLE_AVX2)
+    if (have_avx2) {
+        Crypt_8way = chacha20_avx2::Crypt_8way;
+        ret = (Crypt_4way ? ret + "," : "") + "avx2(8way)";
+    }
+#endif
+#endif // defined(HAVE_GETCPUID)
+
+    return ret;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+#include <attributes.h>
+
+namespace chacha20_avx2 {
+namespace {
+
+__m256i inline K(uint32_t x) { return _mm256_set1_epi32(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+template <int n>
+__m256i inline RotL(__m256i x) { return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n)); }
+template <>
+__m256i inline RotL<16>(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                                   2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+}
+template <>
+__m256i inline RotL<8>(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                                   3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+}
+
+void ALWAYS_INLINE QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Add(a, b); d = RotL<16>(Xor(d, a));
+    c = Add(c, d); b = RotL<12>(Xor(b, c));
+    a = Add(a, b); d = RotL<8>(Xor(d, a));
+    c = Add(c, d); b = RotL<7>(Xor(b, c));
+}
+
+/** Transpose words k..k+7 of the 8 blocks, and write them (xored with the input, if any) to the
+ *  output of every block. */
+void ALWAYS_INLINE Write8(const __m256i* x, int k, const std::byte* in, std::byte* out)
+{
+    __m256i t[8], u[8];
+    for (int i = 0; i < 4; ++i) {
+        t[2 * i] = _mm256_unpacklo_epi32(x[k + 2 * i], x[k + 2 * i + 1]);
+        t[2 * i + 1] = _mm256_unpackhi_epi32(x[k + 2 * i], x[k + 2 * i + 1]);
+    }
+    // Within each 128-bit half, u[i] and u[4 + i] hold words k..k+3 and k+4..k+7 of block i
+    // (low half) and block 4 + i (high half).
+    for (int i = 0; i < 2; ++i) {
+        u[4 * i + 0] = _mm256_unpacklo_epi64(t[4 * i + 0], t[4 * i + 2]);
+        u[4 * i + 1] = _mm256_unpackhi_epi64(t[4 * i + 0], t[4 * i + 2]);
+        u[4 * i + 2] = _mm256_unpacklo_epi64(t[4 * i + 1], t[4 * i + 3]);
+        u[4 * i + 3] = _mm256_unpackhi_epi64(t[4 * i + 1], t[4 * i + 3]);
+    }
+    for (int b = 0; b < 8; ++b) {
+        const size_t offset = 64 * b + 4 * k;
+        __m256i v = b < 4 ? _mm256_permute2x128_si256(u[b], u[4 + b], 0x20) :
+                            _mm256_permute2x128_si256(u[b - 4], u[b], 0x31);
+        if (in) v = Xor(v, _mm256_loadu_si256((const __m256i*)(in + offset)));
+        _mm256_storeu_si256((__m256i*)(out + offset), v);
+    }
+}
+
+} // namespace
+
+void Crypt_8way(const uint32_t* input, const std::byte* in, std::byte* out)
+{
+    const __m256i j[16] = {
+        K(0x61707865), K(0x3320646e), K(0x79622d32), K(0x6b206574),
+        K(input[0]), K(input[1]), K(input[2]), K(input[3]),
+        K(input[4]), K(input[5]), K(input[6]), K(input[7]),
+        Add(K(input[8]), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)), K(input[9]), K(input[10]), K(input[11]),
+    };
+    __m256i x[16];
+    for (int i = 0; i < 16; ++i) x[i] = j[i];
+
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; ++i) x[i] = Add(x[i], j[i]);
+
+    Write8(x, 0, in, out);
+    Write8(x, 8, in, out);
+}
+
+} // namespace chacha20_avx2
+
+#endif
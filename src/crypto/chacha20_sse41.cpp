@@ -0,0 +1,91 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_SSE41
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+#include <attributes.h>
+
+namespace chacha20_sse41 {
+namespace {
+
+__m128i inline K(uint32_t x) { return _mm_set1_epi32(x); }
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+template <int n>
+__m128i inline RotL(__m128i x) { return _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - n)); }
+template <>
+__m128i inline RotL<16>(__m128i x) { return _mm_shuffle_epi8(x, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13)); }
+template <>
+__m128i inline RotL<8>(__m128i x) { return _mm_shuffle_epi8(x, _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14)); }
+
+void ALWAYS_INLINE QuarterRound(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    a = Add(a, b); d = RotL<16>(Xor(d, a));
+    c = Add(c, d); b = RotL<12>(Xor(b, c));
+    a = Add(a, b); d = RotL<8>(Xor(d, a));
+    c = Add(c, d); b = RotL<7>(Xor(b, c));
+}
+
+/** Transpose words k..k+3 of the 4 blocks, and write them (xored with the input, if any) to the
+ *  output of every block. */
+void ALWAYS_INLINE Write4(const __m128i* x, int k, const std::byte* in, std::byte* out)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(x[k], x[k + 1]);
+    const __m128i t1 = _mm_unpackhi_epi32(x[k], x[k + 1]);
+    const __m128i t2 = _mm_unpacklo_epi32(x[k + 2], x[k + 3]);
+    const __m128i t3 = _mm_unpackhi_epi32(x[k + 2], x[k + 3]);
+    const __m128i blocks[4] = {
+        _mm_unpacklo_epi64(t0, t2),
+        _mm_unpackhi_epi64(t0, t2),
+        _mm_unpacklo_epi64(t1, t3),
+        _mm_unpackhi_epi64(t1, t3),
+    };
+    for (int b = 0; b < 4; ++b) {
+        const size_t offset = 64 * b + 4 * k;
+        __m128i v = blocks[b];
+        if (in) v = Xor(v, _mm_loadu_si128((const __m128i*)(in + offset)));
+        _mm_storeu_si128((__m128i*)(out + offset), v);
+    }
+}
+
+} // namespace
+
+void Crypt_4way(const uint32_t* input, const std::byte* in, std::byte* out)
+{
+    const __m128i j[16] = {
+        K(0x61707865), K(0x3320646e), K(0x79622d32), K(0x6b206574),
+        K(input[0]), K(input[1]), K(input[2]), K(input[3]),
+        K(input[4]), K(input[5]), K(input[6]), K(input[7]),
+        Add(K(input[8]), _mm_setr_epi32(0, 1, 2, 3)), K(input[9]), K(input[10]), K(input[11]),
+    };
+    __m128i x[16];
+    for (int i = 0; i < 16; ++i) x[i] = j[i];
+
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; ++i) x[i] = Add(x[i], j[i]);
+
+    Write4(x, 0, in, out);
+    Write4(x, 4, in, out);
+    Write4(x, 8, in, out);
+    Write4(x, 12, in, out);
+}
+
+} // namespace chacha20_sse41
+
+#endif
@@ -2,11 +2,28 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <compat/cpuid.h>
 #include <crypto/common.h>
 #include <crypto/poly1305.h>
+#include <support/cleanse.h>
 
 #include <cstring>
 
+namespace poly1305_avx2
+{
+void Blocks_4way(uint32_t* h, const uint32_t (*r_pow)[5], const unsigned char* m, size_t blocks);
+}
+
+namespace {
+/** Process a multiple of 4 blocks, given h and r^1..r^4. */
+using BlocksMultiFn = void (*)(uint32_t* h, const uint32_t (*r_pow)[5], const unsigned char* m, size_t blocks);
+
+BlocksMultiFn Blocks_4way = nullptr;
+
+/** Minimum number of bytes to process with Blocks_4way, to make up for computing the powers of r. */
+constexpr size_t MIN_MULTI_BYTES{16 * POLY1305_BLOCK_SIZE};
+} // namespace
+
 namespace poly1305_donna {
 
 // Based on the public domain implementation by Andrew Moon
@@ -37,6 +54,27 @@ void poly1305_init(poly1305_context *st, const unsigned char key[32]) noexcept {
     st->final = 0;
 }
 
+/* out = a * b, partially reduced like h in poly1305_blocks */
+static void poly1305_mul(uint32_t out[5], const uint32_t a[5], const uint32_t b[5]) noexcept {
+    const uint32_t s1 = b[1] * 5, s2 = b[2] * 5, s3 = b[3] * 5, s4 = b[4] * 5;
+    uint64_t d0,d1,d2,d3,d4;
+    uint32_t c;
+
+    d0 = ((uint64_t)a[0] * b[0]) + ((uint64_t)a[1] * s4) + ((uint64_t)a[2] * s3) + ((uint64_t)a[3] * s2) + ((uint64_t)a[4] * s1);
+    d1 = ((uint64_t)a[0] * b[1]) + ((uint64_t)a[1] * b[0]) + ((uint64_t)a[2] * s4) + ((uint64_t)a[3] * s3) + ((uint64_t)a[4] * s2);
+    d2 = ((uint64_t)a[0] * b[2]) + ((uint64_t)a[1] * b[1]) + ((uint64_t)a[2] * b[0]) + ((uint64_t)a[3] * s4) + ((uint64_t)a[4] * s3);
+    d3 = ((uint64_t)a[0] * b[3]) + ((uint64_t)a[1] * b[2]) + ((uint64_t)a[2] * b[1]) + ((uint64_t)a[3] * b[0]) + ((uint64_t)a[4] * s4);
+    d4 = ((uint64_t)a[0] * b[4]) + ((uint64_t)a[1] * b[3]) + ((uint64_t)a[2] * b[2]) + ((uint64_t)a[3] * b[1]) + ((uint64_t)a[4] * b[0]);
+
+                     c = (uint32_t)(d0 >> 26); out[0] = (uint32_t)d0 & 0x3ffffff;
+    d1 += c;         c = (uint32_t)(d1 >> 26); out[1] = (uint32_t)d1 & 0x3ffffff;
+    d2 += c;         c = (uint32_t)(d2 >> 26); out[2] = (uint32_t)d2 & 0x3ffffff;
+    d3 += c;         c = (uint32_t)(d3 >> 26); out[3] = (uint32_t)d3 & 0x3ffffff;
+    d4 += c;         c = (uint32_t)(d4 >> 26); out[4] = (uint32_t)d4 & 0x3ffffff;
+    out[0] += c * 5; c =        (out[0] >> 26); out[0] = out[0] & 0x3ffffff;
+    out[1] += c;
+}
+
 static void poly1305_blocks(poly1305_context *st, const unsigned char *m, size_t bytes) noexcept {
     const uint32_t hibit = (st->final) ? 0 : (1UL << 24); /* 1 << 128 */
     uint32_t r0,r1,r2,r3,r4;
@@ -45,6 +83,20 @@ static void poly1305_blocks(poly1305_context *st, const unsigned char *m, size_t
     uint64_t d0,d1,d2,d3,d4;
     uint32_t c;
 
+    /* process groups of 4 blocks in parallel, if available */
+    if (Blocks_4way && !st->final && bytes >= MIN_MULTI_BYTES) {
+        uint32_t r_pow[4][5];
+        std::memcpy(r_pow[0], st->r, sizeof(r_pow[0]));
+        poly1305_mul(r_pow[1], r_pow[0], st->r);
+        poly1305_mul(r_pow[2], r_pow[1], st->r);
+        poly1305_mul(r_pow[3], r_pow[2], st->r);
+        const size_t blocks = (bytes / POLY1305_BLOCK_SIZE) & ~size_t{3};
+        Blocks_4way(st->h, r_pow, m, blocks);
+        memory_cleanse(r_pow, sizeof(r_pow));
+        m += blocks * POLY1305_BLOCK_SIZE;
+        bytes -= blocks * POLY1305_BLOCK_SIZE;
+    }
+
     r0 = st->r[0];
     r1 = st->r[1];
     r2 = st->r[2];
@@ -221,3 +273,25 @@ void poly1305_update(poly1305_context *st, const unsigned char *m, size_t bytes)
 }
 
 }  // namespace poly1305_donna
+
+std::string Poly1305AutoDetect([[maybe_unused]] poly1305_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    Blocks_4way = nullptr;
+
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+    if (use_implementation & poly1305_implementation::USE_AVX2) {
+        uint32_t eax, ebx, ecx, edx;
+        GetCPUID(1, 0, eax, ebx, ecx, edx);
+        if (((ecx >> 27) & 1) && ((ecx >> 28) & 1) && AVXEnabled()) {
+            GetCPUID(7, 0, eax, ebx, ecx, edx);
+            if ((ebx >> 5) & 1) {
+                Blocks_4way = poly1305_avx2::Blocks_4way;
+                ret = "avx2(4way)";
+            }
+        }
+    }
+#endif
+
+    return ret;
+}
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <string>
 
 #define POLY1305_BLOCK_SIZE 16
 
@@ -67,4 +68,17 @@ public:
     }
 };
 
+namespace poly1305_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_AVX2 = 1 << 0,
+    USE_ALL = USE_AVX2,
+};
+}
+
+/** Autodetect the best available Poly1305 implementation, which processes several blocks in
+ *  parallel for longer messages. Returns the name of the implementation. Not thread-safe, like
+ *  SHA256AutoDetect. */
+std::string Poly1305AutoDetect(poly1305_implementation::UseImplementation use_implementation = poly1305_implementation::USE_ALL);
+
 #endif // BITCOIN_CRYPTO_POLY1305_H
@@ -0,0 +1,103 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+#include <attributes.h>
+#include <crypto/common.h>
+
+namespace poly1305_avx2 {
+namespace {
+
+// Every vector holds one 26-bit limb of four independent accumulators, one per 64-bit lane.
+
+__m256i inline Mul(__m256i x, __m256i y) { return _mm256_mul_epu32(x, y); }
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+
+/** Load limb i of four consecutive 16-byte message blocks, one per lane. */
+__m256i inline LoadLimb(const unsigned char* m, int i)
+{
+    const int offset = 3 * i;
+    const int shift = 2 * i;
+    const uint32_t mask = i == 4 ? 0xffffffff : 0x3ffffff;
+    return _mm256_setr_epi64x((ReadLE32(m + offset) >> shift) & mask,
+                              (ReadLE32(m + 16 + offset) >> shift) & mask,
+                              (ReadLE32(m + 32 + offset) >> shift) & mask,
+                              (ReadLE32(m + 48 + offset) >> shift) & mask);
+}
+
+/** h = (h + m) * r, for every lane, with a partial reduction like the one-block implementation. */
+void ALWAYS_INLINE AddMul(__m256i* h, const __m256i* m, const __m256i* r, const __m256i* s)
+{
+    const __m256i mask = _mm256_set1_epi64x(0x3ffffff);
+    const __m256i h0 = Add(h[0], m[0]), h1 = Add(h[1], m[1]), h2 = Add(h[2], m[2]), h3 = Add(h[3], m[3]), h4 = Add(h[4], m[4]);
+
+    __m256i d0 = Add(Add(Add(Mul(h0, r[0]), Mul(h1, s[4])), Add(Mul(h2, s[3]), Mul(h3, s[2]))), Mul(h4, s[1]));
+    __m256i d1 = Add(Add(Add(Mul(h0, r[1]), Mul(h1, r[0])), Add(Mul(h2, s[4]), Mul(h3, s[3]))), Mul(h4, s[2]));
+    __m256i d2 = Add(Add(Add(Mul(h0, r[2]), Mul(h1, r[1])), Add(Mul(h2, r[0]), Mul(h3, s[4]))), Mul(h4, s[3]));
+    __m256i d3 = Add(Add(Add(Mul(h0, r[3]), Mul(h1, r[2])), Add(Mul(h2, r[1]), Mul(h3, r[0]))), Mul(h4, s[4]));
+    __m256i d4 = Add(Add(Add(Mul(h0, r[4]), Mul(h1, r[3])), Add(Mul(h2, r[2]), Mul(h3, r[1]))), Mul(h4, r[0]));
+
+    __m256i c;
+    c = _mm256_srli_epi64(d0, 26); h[0] = _mm256_and_si256(d0, mask);
+    d1 = Add(d1, c); c = _mm256_srli_epi64(d1, 26); h[1] = _mm256_and_si256(d1, mask);
+    d2 = Add(d2, c); c = _mm256_srli_epi64(d2, 26); h[2] = _mm256_and_si256(d2, mask);
+    d3 = Add(d3, c); c = _mm256_srli_epi64(d3, 26); h[3] = _mm256_and_si256(d3, mask);
+    d4 = Add(d4, c); c = _mm256_srli_epi64(d4, 26); h[4] = _mm256_and_si256(d4, mask);
+    h[0] = Add(h[0], Add(c, _mm256_slli_epi64(c, 2)));
+    c = _mm256_srli_epi64(h[0], 26); h[0] = _mm256_and_si256(h[0], mask);
+    h[1] = Add(h[1], c);
+}
+
+} // namespace
+
+void Blocks_4way(uint32_t* h, const uint32_t (*r_pow)[5], const unsigned char* m, size_t blocks)
+{
+    // Lane i accumulates blocks i, i + 4, i + 8, ..., multiplying by r^4 after each of them
+    // except for the last ones, which are multiplied by r^(4 - i) instead. Lane 0 starts from h.
+    __m256i acc[5], r4[5], s4[5], r_last[5], s_last[5];
+    for (int i = 0; i < 5; ++i) {
+        acc[i] = _mm256_setr_epi64x(h[i], 0, 0, 0);
+        r4[i] = _mm256_set1_epi64x(r_pow[3][i]);
+        s4[i] = _mm256_set1_epi64x(r_pow[3][i] * 5);
+        r_last[i] = _mm256_setr_epi64x(r_pow[3][i], r_pow[2][i], r_pow[1][i], r_pow[0][i]);
+        s_last[i] = _mm256_setr_epi64x(r_pow[3][i] * 5, r_pow[2][i] * 5, r_pow[1][i] * 5, r_pow[0][i] * 5);
+    }
+    const __m256i hibit = _mm256_set1_epi64x(1 << 24);
+
+    for (; blocks >= 4; blocks -= 4, m += 64) {
+        __m256i msg[5];
+        for (int i = 0; i < 5; ++i) msg[i] = LoadLimb(m, i);
+        msg[4] = _mm256_or_si256(msg[4], hibit);
+        if (blocks == 4) {
+            AddMul(acc, msg, r_last, s_last);
+        } else {
+            AddMul(acc, msg, r4, s4);
+        }
+    }
+
+    // Sum the lanes, and reduce partially again.
+    uint64_t d[5];
+    for (int i = 0; i < 5; ++i) {
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256((__m256i*)lanes, acc[i]);
+        d[i] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    uint64_t c;
+    c = d[0] >> 26; h[0] = d[0] & 0x3ffffff;
+    d[1] += c; c = d[1] >> 26; h[1] = d[1] & 0x3ffffff;
+    d[2] += c; c = d[2] >> 26; h[2] = d[2] & 0x3ffffff;
+    d[3] += c; c = d[3] >> 26; h[3] = d[3] & 0x3ffffff;
+    d[4] += c; c = d[4] >> 26; h[4] = d[4] & 0x3ffffff;
+    h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+    h[1] += c;
+}
+
+} // namespace poly1305_avx2
+
+#endif
@@ -10,10 +10,13 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <cmath>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
 #include <vector>
 
@@ -483,6 +486,105 @@ public:
         return false;
     }
 };
+
+/** @ref sharded_cache splits a @ref cache into independent shards, each with
+ * its own lock, so that it can be used from many threads without external
+ * locking.
+ *
+ * The shard of an element is picked by the low bits of its first hash, which
+ * barely affect the locations of the element within the shard (see
+ * cache::compute_hashes). A lookup only takes the shared lock of one shard,
+ * and an insert only the exclusive lock of one shard, so threads rarely wait
+ * for each other. The occasional scan of an insert for entries to age
+ * (cache::epoch_check) only covers its shard, which bounds how long it holds
+ * the lock.
+ *
+ * Small caches are not split, so that they behave exactly like a @ref cache.
+ */
+template <typename Element, typename Hash>
+class sharded_cache
+{
+private:
+    /** Padded to a cache line, so that locking one shard does not slow down
+     * threads using the neighbouring one. */
+    struct alignas(64) shard {
+        mutable std::shared_mutex mutex;
+        cache<Element, Hash> set;
+    };
+
+    std::unique_ptr<shard[]> shards;
+
+    /** shard_mask is the number of shards minus one, which is a power of two */
+    uint32_t shard_mask{0};
+
+    const Hash hash_function;
+
+    inline shard& get_shard(const Element& e) const
+    {
+        return shards[hash_function.template operator()<0>(e) & shard_mask];
+    }
+
+public:
+    /** max_shards is the maximum number of shards */
+    static constexpr uint32_t max_shards{32};
+
+    /** min_shard_size is the minimum number of elements of each shard */
+    static constexpr uint32_t min_shard_size{1 << 12};
+
+    /** You must always construct a sharded_cache with some elements via a
+     * subsequent call to setup_bytes, otherwise operations may segfault.
+     */
+    sharded_cache() : hash_function() {}
+
+    /** setup_bytes splits the given number of bytes over as many shards as
+     * possible (a power of two, at most max_shards) that each store at least
+     * min_shard_size elements, see cache::setup_bytes.
+     *
+     * setup_bytes should only be called once.
+     *
+     * @returns A pair of the maximum number of elements storable in all shards
+     * and the approximate total size of these elements in bytes.
+     */
+    std::pair<uint32_t, size_t> setup_bytes(size_t bytes)
+    {
+        const size_t requested_num_elems{std::min<size_t>(bytes / sizeof(Element), std::numeric_limits<uint32_t>::max())};
+        const uint32_t num_shards{std::bit_floor(static_cast<uint32_t>(std::clamp<size_t>(requested_num_elems / min_shard_size, 1, max_shards)))};
+        shards = std::make_unique<shard[]>(num_shards);
+        shard_mask = num_shards - 1;
+
+        uint32_t num_elems{0};
+        size_t approx_size_bytes{0};
+        for (uint32_t i = 0; i < num_shards; ++i) {
+            const auto [shard_elems, shard_bytes] = shards[i].set.setup_bytes(bytes / num_shards);
+            num_elems += shard_elems;
+            approx_size_bytes += shard_bytes;
+        }
+        return std::make_pair(num_elems, approx_size_bytes);
+    }
+
+    /** num_shards returns the number of shards the cache was split into */
+    uint32_t num_shards() const
+    {
+        return shard_mask + 1;
+    }
+
+    /** insert inserts the element into its shard, see cache::insert. */
+    inline void insert(Element e)
+    {
+        shard& s = get_shard(e);
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        s.set.insert(std::move(e));
+    }
+
+    /** contains checks whether the element is in its shard, see
+     * cache::contains. */
+    inline bool contains(const Element& e, const bool erase) const
+    {
+        shard& s = get_shard(e);
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        return s.set.contains(e, erase);
+    }
+};
 } // namespace CuckooCache
 
 #endif // BITCOIN_CUCKOOCACHE_H
@@ -15,6 +15,7 @@
 #include <util/hasher.h>
 
 #include <deque>
+#include <span>
 #include <vector>
 
 // A compressed CBlockHeader, which leaves out the prevhash
@@ -141,6 +142,8 @@ public:
     /** Result data structure for ProcessNextHeaders. */
     struct ProcessingResult {
         std::vector<CBlockHeader> pow_validated_headers;
+        //! Hashes of pow_validated_headers, in the same order.
+        std::vector<uint256> pow_validated_hashes;
         bool success{false};
         bool request_more{false};
     };
@@ -156,17 +159,21 @@ public:
      *                   rules).
      * full_headers_message: true if the message was at max capacity,
      *                       indicating more headers may be available
+     * received_hashes: optionally, the hashes of received_headers as
+     *                  computed while checking their proof of work, so they
+     *                  are not hashed again
      * ProcessingResult.pow_validated_headers: will be filled in with any
      *                       headers that the caller can fully process and
      *                       validate now (because these returned headers are
      *                       on a chain with sufficient work)
+     * ProcessingResult.pow_validated_hashes: the hashes of pow_validated_headers
      * ProcessingResult.success: set to false if an error is detected and the sync is
      *                       aborted; true otherwise.
      * ProcessingResult.request_more: if true, the caller is suggested to call
      *                       NextHeadersRequestLocator and send a getheaders message using it.
      */
     ProcessingResult ProcessNextHeaders(const std::vector<CBlockHeader>&
-            received_headers, bool full_headers_message);
+            received_headers, bool full_headers_message, std::span<const uint256> received_hashes = {});
 
     /** Issue the next GETHEADERS message to our peer.
      *
@@ -195,17 +202,18 @@ private:
      *  processed headers.
      *  On failure, this invokes Finalize() and returns false.
      */
-    bool ValidateAndStoreHeadersCommitments(const std::vector<CBlockHeader>& headers);
+    bool ValidateAndStoreHeadersCommitments(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes);
 
     /** In PRESYNC, process and update state for a single header */
-    bool ValidateAndProcessSingleHeader(const CBlockHeader& current);
+    bool ValidateAndProcessSingleHeader(const CBlockHeader& current, const uint256& hash);
 
     /** In REDOWNLOAD, check a header's commitment (if applicable) and add to
      * buffer for later processing */
-    bool ValidateAndStoreRedownloadedHeader(const CBlockHeader& header);
+    bool ValidateAndStoreRedownloadedHeader(const CBlockHeader& header, const uint256& hash);
 
-    /** Return a set of headers that satisfy our proof-of-work threshold */
-    std::vector<CBlockHeader> PopHeadersReadyForAcceptance();
+    /** Return a set of headers that satisfy our proof-of-work threshold, and
+     * their hashes in hashes_out */
+    std::vector<CBlockHeader> PopHeadersReadyForAcceptance(std::vector<uint256>& hashes_out);
 
 private:
     /** NodeId of the peer (used for log messages) **/
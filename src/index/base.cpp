@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <common/args.h>
 #include <index/base.h>
+#include <index/sync_coordinator.h>
 #include <interfaces/chain.h>
 #include <kernel/chain.h>
 #include <logging.h>
@@ -20,13 +21,17 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
@@ -149,29 +154,42 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain&
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
-bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+bool BaseIndex::ReadBlockData(interfaces::BlockInfo& block_info, IndexBlockData& block_read)
 {
-    interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
-
-    CBlock block;
-    if (!block_data) { // disk lookup if block data wasn't provided
-        if (!m_chainstate->m_blockman.ReadBlock(block, *pindex)) {
+    if (!block_info.data && CustomAllowBlockView()) {
+        // Only parse the parts of the block that the index asks for.
+        block_info.view = block_read.GetBlockView();
+        if (!block_info.view) {
+            FatalErrorf("Failed to read block %s from disk",
+                        block_info.hash.ToString());
+            return false;
+        }
+    } else if (!block_info.data) { // disk lookup if block data wasn't provided
+        block_info.data = block_read.GetBlock();
+        if (!block_info.data) {
             FatalErrorf("Failed to read block %s from disk",
-                        pindex->GetBlockHash().ToString());
+                        block_info.hash.ToString());
             return false;
         }
-        block_info.data = &block;
     }
 
-    CBlockUndo block_undo;
     if (CustomOptions().connect_undo_data) {
-        if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+        block_info.undo_data = block_read.GetBlockUndo();
+        if (!block_info.undo_data) {
             FatalErrorf("Failed to read undo block data %s from disk",
-                        pindex->GetBlockHash().ToString());
+                        block_info.hash.ToString());
             return false;
         }
-        block_info.undo_data = &block_undo;
     }
+    return true;
+}
+
+bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+{
+    interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
+
+    IndexBlockData block_read{m_chainstate->m_blockman, *pindex};
+    if (!ReadBlockData(block_info, block_read)) return false; // error logged internally
 
     if (!CustomAppend(block_info)) {
         FatalErrorf("Failed to write block %s to index database",
@@ -182,10 +200,49 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
     return true;
 }
 
+bool BaseIndex::ProcessBlocks(std::span<const CBlockIndex* const> blocks, const IndexSyncCoordinator::Registration* sync_registration)
+{
+    // Keep the block data alive until CustomAppendBatch returns.
+    std::vector<std::shared_ptr<IndexBlockData>> block_reads;
+    std::vector<interfaces::BlockInfo> block_infos;
+    block_reads.reserve(blocks.size());
+    block_infos.reserve(blocks.size());
+    for (const CBlockIndex* pindex : blocks) {
+        // Blocks read during the initial sync may be shared with other
+        // indexes syncing at the same time.
+        block_reads.push_back(sync_registration ? sync_registration->GetBlockData(*pindex) :
+                                                  std::make_shared<IndexBlockData>(m_chainstate->m_blockman, *pindex));
+        block_infos.push_back(kernel::MakeBlockInfo(pindex));
+        if (!ReadBlockData(block_infos.back(), *block_reads.back())) return false; // error logged internally
+    }
+
+    if (!CustomAppendBatch(block_infos)) {
+        FatalErrorf("Failed to write blocks %s to %s to index database",
+                    blocks.front()->GetBlockHash().ToString(), blocks.back()->GetBlockHash().ToString());
+        return false;
+    }
+
+    return true;
+}
+
+bool BaseIndex::CustomAppendBatch(std::span<const interfaces::BlockInfo> blocks)
+{
+    for (const auto& block : blocks) {
+        if (!CustomAppend(block)) return false;
+    }
+    return true;
+}
+
 void BaseIndex::Sync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
+        // Stop holding back other indexes once this one exits the sync loop,
+        // for whatever reason.
+        const auto sync_registration{std::move(m_sync_registration)};
+        // Batches must fit in the window of the coordinator, so indexes
+        // syncing together can still share their blocks.
+        const size_t batch_size{std::clamp<size_t>(CustomAppendBatchSize(), 1, sync_registration ? IndexSyncCoordinator::WINDOW : SIZE_MAX)};
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
         while (true) {
@@ -220,14 +277,29 @@ void BaseIndex::Sync()
                     break;
                 }
             }
+            if (sync_registration) {
+                sync_registration->WaitForLaggards(pindex_next->nHeight, m_interrupt);
+                if (m_interrupt) continue;
+            }
             if (pindex_next->pprev != pindex && !Rewind(pindex, pindex_next->pprev)) {
                 FatalErrorf("Failed to rewind %s to a previous chain tip", GetName());
                 return;
             }
-            pindex = pindex_next;
-
 
-            if (!ProcessBlock(pindex)) return; // error logged internally
+            // Pass the blocks following pindex_next along if the index can
+            // append several blocks at once.
+            std::vector<const CBlockIndex*> blocks{pindex_next};
+            if (batch_size > 1) {
+                LOCK(::cs_main);
+                while (blocks.size() < batch_size) {
+                    const CBlockIndex* next{m_chainstate->m_chain.Next(blocks.back())};
+                    if (!next) break;
+                    blocks.push_back(next);
+                }
+            }
+            if (!ProcessBlocks(blocks, sync_registration.get())) return; // error logged internally
+            pindex = blocks.back();
+            if (sync_registration) sync_registration->Advance(pindex->nHeight);
 
             auto current_time{std::chrono::steady_clock::now()};
             if (last_log_time + SYNC_LOG_INTERVAL < current_time) {
@@ -444,6 +516,16 @@ void BaseIndex::Interrupt()
     m_interrupt();
 }
 
+void BaseIndex::SetSyncCoordinator(std::shared_ptr<IndexSyncCoordinator> coordinator)
+{
+    if (!m_init) throw std::logic_error("Error: Cannot coordinate a non-initialized index");
+    if (m_synced) return;
+
+    const CBlockIndex* best_block{m_best_block_index.load()};
+    m_sync_registration = std::make_unique<IndexSyncCoordinator::Registration>(
+        std::move(coordinator), *this, best_block ? best_block->nHeight : -1);
+}
+
 bool BaseIndex::StartBackgroundSync()
 {
     if (!m_init) throw std::logic_error("Error: Cannot start a non-initialized index");
@@ -6,12 +6,16 @@
 #define BITCOIN_INDEX_BASE_H
 
 #include <dbwrapper.h>
+#include <index/sync_coordinator.h>
 #include <interfaces/chain.h>
 #include <interfaces/types.h>
 #include <util/string.h>
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
 
 class CBlock;
@@ -80,6 +84,9 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    /// Set by SetSyncCoordinator and taken over by the sync thread.
+    std::unique_ptr<IndexSyncCoordinator::Registration> m_sync_registration;
+
     /// Write the current index state (eg. chain block locator and subclass-specific items) to disk.
     ///
     /// Recommendations for error handling:
@@ -93,8 +100,15 @@ private:
     /// Loop over disconnected blocks and call CustomRemove.
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip);
 
+    /// Fill in the block data and undo data the index needs from block_read,
+    /// unless the block data was passed in already.
+    bool ReadBlockData(interfaces::BlockInfo& block_info, IndexBlockData& block_read);
+
     bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
 
+    /// Append consecutive blocks read from disk during the initial sync.
+    bool ProcessBlocks(std::span<const CBlockIndex* const> blocks, const IndexSyncCoordinator::Registration* sync_registration);
+
     virtual bool AllowPrune() const = 0;
 
     template <typename... Args>
@@ -115,9 +129,25 @@ protected:
     /// Initialize internal state from the database and block index.
     [[nodiscard]] virtual bool CustomInit(const std::optional<interfaces::BlockRef>& block) { return true; }
 
+    /// Whether CustomAppend can work from a BlockView, which only parses the
+    /// parts of a block that are accessed, instead of a fully deserialized
+    /// CBlock. If so, blocks read from disk during the initial sync are passed
+    /// in BlockInfo::view rather than BlockInfo::data. Blocks from
+    /// BlockConnected notifications are always passed in full.
+    [[nodiscard]] virtual bool CustomAllowBlockView() const { return false; }
+
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Maximum number of consecutive blocks the initial sync passes to
+    /// CustomAppendBatch at once.
+    [[nodiscard]] virtual size_t CustomAppendBatchSize() const { return 1; }
+
+    /// Write index entries for consecutive blocks during the initial sync, in
+    /// chain order. By default this calls CustomAppend for every block; indexes
+    /// can override it to process the blocks of a batch in parallel.
+    [[nodiscard]] virtual bool CustomAppendBatch(std::span<const interfaces::BlockInfo> blocks);
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -151,6 +181,10 @@ public:
     /// validation interface so that it stays in sync with blockchain updates.
     [[nodiscard]] bool Init();
 
+    /// Lets the initial sync share block reads with other indexes using the
+    /// same coordinator. Must be called before StartBackgroundSync.
+    void SetSyncCoordinator(std::shared_ptr<IndexSyncCoordinator> coordinator);
+
     /// Starts the initial sync process on a background thread.
     [[nodiscard]] bool StartBackgroundSync();
 
@@ -2,9 +2,16 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <optional>
+#include <thread>
+#include <vector>
 
+#include <blockview.h>
 #include <clientversion.h>
+#include <common/system.h>
 #include <common/args.h>
 #include <dbwrapper.h>
 #include <hash.h>
@@ -43,6 +50,11 @@ constexpr unsigned int FLTR_FILE_CHUNK_SIZE = 0x100000; // 1 MiB
  *  is big enough for a 2,000,000 length block chain, which
  *  we should be enough until ~2047. */
 constexpr size_t CF_HEADERS_CACHE_MAX_SZ{2000};
+/** Number of filter headers of the most recent blocks to keep in memory. getcfheaders requests
+ *  from peers following the chain are mostly for the last few blocks. */
+constexpr size_t CF_RECENT_HEADERS_CACHE_SZ{CFCHECKPT_INTERVAL};
+/** Maximum number of blocks whose filters are built in parallel during the initial sync. */
+constexpr size_t FILTER_BUILD_BATCH_SIZE{8};
 
 namespace {
 
@@ -98,9 +110,11 @@ struct DBHashKey {
 static std::map<BlockFilterType, BlockFilterIndex> g_filter_indexes;
 
 BlockFilterIndex::BlockFilterIndex(std::unique_ptr<interfaces::Chain> chain, BlockFilterType filter_type,
-                                   size_t n_cache_size, bool f_memory, bool f_wipe)
+                                   size_t n_cache_size, bool f_memory, bool f_wipe,
+                                   std::optional<int> filter_build_threads)
     : BaseIndex(std::move(chain), BlockFilterTypeName(filter_type) + " block filter index")
     , m_filter_type(filter_type)
+    , m_filter_build_threads(std::clamp<int>(filter_build_threads.value_or(GetNumCores() - 1), 0, FILTER_BUILD_BATCH_SIZE - 1))
 {
     const std::string& filter_name = BlockFilterTypeName(filter_type);
     if (filter_name.empty()) throw std::invalid_argument("unknown filter_type");
@@ -271,15 +285,56 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
+static BlockFilter BuildFilter(BlockFilterType filter_type, const interfaces::BlockInfo& block)
+{
+    const CBlockUndo& block_undo{*Assert(block.undo_data)};
+    return block.view ? BlockFilter(filter_type, *block.view, block_undo)
+                      : BlockFilter(filter_type, *Assert(block.data), block_undo);
+}
+
 bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
 {
-    BlockFilter filter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    const BlockFilter filter{BuildFilter(m_filter_type, block)};
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
     if (res) m_last_header = header; // update last header
     return res;
 }
 
+size_t BlockFilterIndex::CustomAppendBatchSize() const
+{
+    return FILTER_BUILD_BATCH_SIZE;
+}
+
+bool BlockFilterIndex::CustomAppendBatch(std::span<const interfaces::BlockInfo> blocks)
+{
+    // Every filter only depends on its own block, so build them in parallel.
+    // Only the header chain and the writes have to happen in order. The
+    // threads only live for the batch: starting them costs little next to
+    // building the filters of several blocks.
+    std::vector<std::optional<BlockFilter>> filters(blocks.size());
+    std::atomic<size_t> next_block{0};
+    const auto build_filters{[&] {
+        for (size_t i; (i = next_block++) < blocks.size();) {
+            filters[i].emplace(BuildFilter(m_filter_type, blocks[i]));
+        }
+    }};
+    std::vector<std::thread> workers;
+    workers.reserve(m_filter_build_threads);
+    for (size_t i{1}; i < blocks.size() && workers.size() < size_t(m_filter_build_threads); ++i) {
+        workers.emplace_back(build_filters);
+    }
+    build_filters();
+    for (auto& worker : workers) worker.join();
+
+    for (size_t i{0}; i < blocks.size(); ++i) {
+        const uint256 header{filters[i]->ComputeHeader(m_last_header)};
+        if (!Write(*filters[i], blocks[i].height, header)) return false;
+        m_last_header = header;
+    }
+    return true;
+}
+
 bool BlockFilterIndex::Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header)
 {
     size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
@@ -296,6 +351,12 @@ bool BlockFilterIndex::Write(const BlockFilter& filter, uint32_t block_height, c
     }
 
     m_next_filter_pos.nPos += bytes_written;
+
+    LOCK(m_cs_headers_cache);
+    m_recent_headers_cache.insert_or_assign(block_height, std::make_pair(filter.GetBlockHash(), filter_header));
+    if (m_recent_headers_cache.size() > CF_RECENT_HEADERS_CACHE_SZ) {
+        m_recent_headers_cache.erase(m_recent_headers_cache.begin());
+    }
     return true;
 }
 
@@ -342,6 +403,7 @@ bool BlockFilterIndex::CustomRemove(const interfaces::BlockInfo& block)
 
     // Update cached header to the previous block hash
     m_last_header = *Assert(ReadFilterHeader(block.height - 1, *Assert(block.prev_hash)));
+    WITH_LOCK(m_cs_headers_cache, m_recent_headers_cache.erase(block.height));
     return true;
 }
 
@@ -447,6 +509,13 @@ bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint25
         }
     }
 
+    // Blocks near the tip are likely to be in the recent headers cache.
+    auto recent = m_recent_headers_cache.find(block_index->nHeight);
+    if (recent != m_recent_headers_cache.end() && recent->second.first == block_index->GetBlockHash()) {
+        header_out = recent->second.second;
+        return true;
+    }
+
     DBVal entry;
     if (!LookupOne(*m_db, block_index, entry)) {
         return false;
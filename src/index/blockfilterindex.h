@@ -12,7 +12,12 @@
 #include <index/base.h>
 #include <util/hasher.h>
 
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
 #include <unordered_map>
+#include <utility>
 
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
 
@@ -41,13 +46,20 @@ private:
     Mutex m_cs_headers_cache;
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
+    /** block hash and filter header of the most recently appended blocks by height, to avoid disk
+     *  access when responding to getcfheaders for blocks near the tip. */
+    std::map<int, std::pair<uint256, uint256>> m_recent_headers_cache GUARDED_BY(m_cs_headers_cache);
+
+    /** Number of threads started to build the filters of a batch of blocks during the initial
+     *  sync, besides the syncing thread. */
+    const int m_filter_build_threads;
 
     // Last computed header to avoid disk reads on every new block.
     uint256 m_last_header{};
 
     bool AllowPrune() const override { return true; }
 
-    bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header);
+    bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header) EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache);
 
     std::optional<uint256> ReadFilterHeader(int height, const uint256& expected_block_hash);
 
@@ -58,16 +70,23 @@ protected:
 
     bool CustomCommit(CDBBatch& batch) override;
 
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    bool CustomAllowBlockView() const override { return true; }
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache);
+
+    size_t CustomAppendBatchSize() const override;
+
+    bool CustomAppendBatch(std::span<const interfaces::BlockInfo> blocks) override EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache);
 
-    bool CustomRemove(const interfaces::BlockInfo& block) override;
+    bool CustomRemove(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache);
 
     BaseIndex::DB& GetDB() const LIFETIMEBOUND override { return *m_db; }
 
 public:
     /** Constructs the index, which becomes available to be queried. */
     explicit BlockFilterIndex(std::unique_ptr<interfaces::Chain> chain, BlockFilterType filter_type,
-                              size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+                              size_t n_cache_size, bool f_memory = false, bool f_wipe = false,
+                              std::optional<int> filter_build_threads = std::nullopt);
 
     BlockFilterType GetFilterType() const { return m_filter_type; }
 
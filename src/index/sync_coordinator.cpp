@@ -0,0 +1,173 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/sync_coordinator.h>
+
+#include <chain.h>
+#include <flatfile.h>
+#include <kernel/cs_main.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <util/threadinterrupt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ios>
+
+using namespace std::chrono_literals;
+
+IndexBlockData::IndexBlockData(const node::BlockManager& blockman, const CBlockIndex& block_index)
+    : m_blockman{blockman}, m_block_index{block_index} {}
+
+FlatFilePos IndexBlockData::GetBlockPos() const
+{
+    return WITH_LOCK(cs_main, return m_block_index.GetBlockPos());
+}
+
+const std::vector<std::byte>* IndexBlockData::GetRawBlock()
+{
+    std::call_once(m_raw_block_once, [&] {
+        std::vector<std::byte> raw_block;
+        if (m_blockman.ReadRawBlock(raw_block, GetBlockPos())) {
+            m_raw_block = std::move(raw_block);
+        }
+    });
+    return m_raw_block ? &*m_raw_block : nullptr;
+}
+
+const BlockView* IndexBlockData::GetBlockView()
+{
+    std::call_once(m_block_view_once, [&] {
+        const auto* raw_block{GetRawBlock()};
+        if (!raw_block) return;
+        try {
+            m_block_view.emplace(*raw_block);
+        } catch (const std::ios_base::failure& e) {
+            LogError("Failed to parse block %s read from disk: %s", m_block_index.GetBlockHash().ToString(), e.what());
+            return;
+        }
+        // The signet solution is only checked when the full block is
+        // deserialized, see GetBlock().
+        if (!m_blockman.CheckReadBlockHeader(m_block_view->GetHeader(), GetBlockPos(), m_block_index.GetBlockHash())) {
+            m_block_view.reset();
+        }
+    });
+    return m_block_view ? &*m_block_view : nullptr;
+}
+
+const CBlock* IndexBlockData::GetBlock()
+{
+    std::call_once(m_block_once, [&] {
+        const auto* raw_block{GetRawBlock()};
+        if (!raw_block) return;
+        CBlock block;
+        if (!m_blockman.ParseBlock(block, *raw_block, GetBlockPos(), m_block_index.GetBlockHash())) return;
+        m_block = std::move(block);
+    });
+    return m_block ? &*m_block : nullptr;
+}
+
+const CBlockUndo* IndexBlockData::GetBlockUndo()
+{
+    std::call_once(m_block_undo_once, [&] {
+        CBlockUndo block_undo;
+        if (m_block_index.nHeight > 0 && !m_blockman.ReadBlockUndo(block_undo, m_block_index)) return;
+        m_block_undo = std::move(block_undo);
+    });
+    return m_block_undo ? &*m_block_undo : nullptr;
+}
+
+IndexSyncCoordinator::Registration::Registration(std::shared_ptr<IndexSyncCoordinator> coordinator, const BaseIndex& index, int height)
+    : m_coordinator{std::move(coordinator)}, m_index{index}
+{
+    m_coordinator->Register(m_index, height);
+}
+
+IndexSyncCoordinator::Registration::~Registration()
+{
+    m_coordinator->Unregister(m_index);
+}
+
+void IndexSyncCoordinator::Registration::WaitForLaggards(int height, const CThreadInterrupt& interrupt) const
+{
+    m_coordinator->WaitForLaggards(m_index, height, interrupt);
+}
+
+void IndexSyncCoordinator::Registration::Advance(int height) const
+{
+    m_coordinator->Advance(m_index, height);
+}
+
+std::shared_ptr<IndexBlockData> IndexSyncCoordinator::Registration::GetBlockData(const CBlockIndex& block_index) const
+{
+    return m_coordinator->GetBlockData(block_index);
+}
+
+IndexSyncCoordinator::IndexSyncCoordinator(const node::BlockManager& blockman)
+    : m_blockman{blockman} {}
+
+void IndexSyncCoordinator::Register(const BaseIndex& index, int height)
+{
+    LOCK(m_mutex);
+    m_heights[&index] = height;
+}
+
+void IndexSyncCoordinator::Unregister(const BaseIndex& index)
+{
+    {
+        LOCK(m_mutex);
+        m_heights.erase(&index);
+        EvictUnneeded();
+    }
+    m_cv.notify_all();
+}
+
+void IndexSyncCoordinator::WaitForLaggards(const BaseIndex& index, int height, const CThreadInterrupt& interrupt)
+{
+    WAIT_LOCK(m_mutex, lock);
+    const auto must_wait{[&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return std::ranges::any_of(m_heights, [&](const auto& entry) {
+            // Only wait for indexes that are a bit behind. Waiting for one that
+            // is much further behind would stall this index for a long time
+            // without saving any reads.
+            const int distance{height - entry.second};
+            return entry.first != &index && distance > WINDOW && distance <= 2 * WINDOW;
+        });
+    }};
+    // Poll the interrupt, it does not notify m_cv.
+    while (must_wait() && !interrupt) {
+        m_cv.wait_for(lock, 100ms);
+    }
+}
+
+void IndexSyncCoordinator::Advance(const BaseIndex& index, int height)
+{
+    {
+        LOCK(m_mutex);
+        m_heights[&index] = height;
+        EvictUnneeded();
+    }
+    m_cv.notify_all();
+}
+
+std::shared_ptr<IndexBlockData> IndexSyncCoordinator::GetBlockData(const CBlockIndex& block_index)
+{
+    LOCK(m_mutex);
+    auto& data{m_blocks[{block_index.nHeight, block_index.GetBlockHash()}]};
+    if (!data) data = std::make_shared<IndexBlockData>(m_blockman, block_index);
+    return data;
+}
+
+void IndexSyncCoordinator::EvictUnneeded()
+{
+    if (m_heights.empty()) {
+        m_blocks.clear();
+        return;
+    }
+    const auto [min_it, max_it]{std::ranges::minmax_element(m_heights, {}, [](const auto& entry) { return entry.second; })};
+    // Blocks every index is past, and blocks that only an index too far
+    // behind to be waited for would still need.
+    const int keep_from{std::max(min_it->second + 1, max_it->second - 2 * WINDOW)};
+    m_blocks.erase(m_blocks.begin(), m_blocks.lower_bound({keep_from, uint256::ZERO}));
+}
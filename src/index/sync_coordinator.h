@@ -0,0 +1,134 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SYNC_COORDINATOR_H
+#define BITCOIN_INDEX_SYNC_COORDINATOR_H
+
+#include <blockview.h>
+#include <flatfile.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+#include <undo.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class BaseIndex;
+class CBlockIndex;
+class CThreadInterrupt;
+namespace node {
+class BlockManager;
+} // namespace node
+
+/**
+ * Data of a single block as needed by the indexes, read from disk on first
+ * use. Every part is read or decoded at most once, also when it is requested
+ * from several threads at the same time, and stays valid for the lifetime of
+ * this object. Failures are logged and reported by returning nullptr.
+ */
+class IndexBlockData
+{
+public:
+    IndexBlockData(const node::BlockManager& blockman, const CBlockIndex& block_index);
+
+    //! Serialized block as stored on disk.
+    const std::vector<std::byte>* GetRawBlock();
+    //! Lazily parsed view over GetRawBlock().
+    const BlockView* GetBlockView();
+    //! Block deserialized from GetRawBlock().
+    const CBlock* GetBlock();
+    //! Undo data of the block, empty for the genesis block.
+    const CBlockUndo* GetBlockUndo();
+
+private:
+    const node::BlockManager& m_blockman;
+    const CBlockIndex& m_block_index;
+
+    FlatFilePos GetBlockPos() const;
+
+    std::once_flag m_raw_block_once;
+    std::once_flag m_block_view_once;
+    std::once_flag m_block_once;
+    std::once_flag m_block_undo_once;
+
+    std::optional<std::vector<std::byte>> m_raw_block;
+    std::optional<BlockView> m_block_view;
+    std::optional<CBlock> m_block;
+    std::optional<CBlockUndo> m_block_undo;
+};
+
+/**
+ * Lets the initial sync threads of several indexes share the blocks they read
+ * from disk, so that e.g. -txindex, -blockfilterindex and -coinstatsindex
+ * syncing together read and decode every block once instead of once per index.
+ *
+ * Each index keeps running CustomAppend on its own sync thread. Indexes that
+ * are close to each other are kept within WINDOW blocks, so the slowest one
+ * still finds the blocks the others already read. An index that is far ahead
+ * of the others (e.g. one that was already synced before a new one got
+ * enabled) is never held back and simply reads the blocks it needs itself.
+ */
+class IndexSyncCoordinator
+{
+public:
+    //! Number of blocks an index may get ahead of the slowest index syncing
+    //! alongside it before it waits for it to catch up.
+    static constexpr int WINDOW{8};
+
+    /**
+     * Handle of an index taking part in the coordinated sync. The index stops
+     * taking part, and holding back others, when the handle is destroyed.
+     */
+    class Registration
+    {
+    public:
+        Registration(std::shared_ptr<IndexSyncCoordinator> coordinator, const BaseIndex& index, int height);
+        ~Registration();
+
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+        //! Block until no other index syncing alongside this one would be left
+        //! more than WINDOW blocks behind when this one processes the block at
+        //! `height`, or until the interrupt is set.
+        void WaitForLaggards(int height, const CThreadInterrupt& interrupt) const;
+        //! Record that the index processed the block at `height`, releasing
+        //! blocks that no index needs anymore.
+        void Advance(int height) const;
+        //! Get the data of the given block, shared with the other indexes.
+        std::shared_ptr<IndexBlockData> GetBlockData(const CBlockIndex& block_index) const;
+
+    private:
+        const std::shared_ptr<IndexSyncCoordinator> m_coordinator;
+        const BaseIndex& m_index;
+    };
+
+    explicit IndexSyncCoordinator(const node::BlockManager& blockman);
+
+private:
+    void Register(const BaseIndex& index, int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Unregister(const BaseIndex& index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void WaitForLaggards(const BaseIndex& index, int height, const CThreadInterrupt& interrupt) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Advance(const BaseIndex& index, int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    std::shared_ptr<IndexBlockData> GetBlockData(const CBlockIndex& block_index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void EvictUnneeded() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    const node::BlockManager& m_blockman;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Height of the last block processed by every syncing index.
+    std::map<const BaseIndex*, int> m_heights GUARDED_BY(m_mutex);
+    //! Blocks read so far, by height and hash.
+    std::map<std::pair<int, uint256>, std::shared_ptr<IndexBlockData>> m_blocks GUARDED_BY(m_mutex);
+};
+
+#endif // BITCOIN_INDEX_SYNC_COORDINATOR_H
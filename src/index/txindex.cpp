@@ -4,6 +4,7 @@
 
 #include <index/txindex.h>
 
+#include <blockview.h>
 #include <clientversion.h>
 #include <common/args.h>
 #include <index/disktxpos.h>
@@ -59,6 +60,18 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
     // Exclude genesis block transaction because outputs are not spendable.
     if (block.height == 0) return true;
 
+    if (block.view) {
+        // Offsets and txids can be taken from the serialized block without deserializing it.
+        CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.view->TxCount()));
+        std::vector<std::pair<uint256, CDiskTxPos>> vPos;
+        vPos.reserve(block.view->TxCount());
+        for (size_t i = 0; i < block.view->TxCount(); ++i) {
+            vPos.emplace_back(block.view->GetTxid(i), pos);
+            pos.nTxOffset += block.view->TxData(i).size();
+        }
+        return m_db->WriteTxs(vPos);
+    }
+
     assert(block.data);
     CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
     std::vector<std::pair<uint256, CDiskTxPos>> vPos;
@@ -25,6 +25,8 @@ private:
     bool AllowPrune() const override { return false; }
 
 protected:
+    bool CustomAllowBlockView() const override { return true; }
+
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
     BaseIndex::DB& GetDB() const override;
@@ -26,6 +26,7 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/sync_coordinator.h>
 #include <index/txindex.h>
 #include <init/common.h>
 #include <interfaces/chain.h>
@@ -45,6 +46,7 @@
 #include <netgroup.h>
 #include <node/blockmanager_args.h>
 #include <node/blockstorage.h>
+#include <node/bumpfeeoracle.h>
 #include <node/caches.h>
 #include <node/chainstate.h>
 #include <node/chainstatemanager_args.h>
@@ -123,6 +125,8 @@ using common::ResolveErrMsg;
 
 using node::ApplyArgsManOptions;
 using node::BlockManager;
+using node::BlockTemplateCache;
+using node::BumpFeeOracle;
 using node::CalculateCacheSizes;
 using node::ChainstateLoadResult;
 using node::ChainstateLoadStatus;
@@ -316,6 +320,10 @@ void Shutdown(NodeContext& node)
     // After the threads that potentially access these pointers have been stopped,
     // destruct and reset all to nullptr.
     node.peerman.reset();
+    if (node.block_template_cache && node.validation_signals) node.validation_signals->UnregisterValidationInterface(node.block_template_cache.get());
+    node.block_template_cache.reset();
+    if (node.bump_fee_oracle && node.validation_signals) node.validation_signals->UnregisterValidationInterface(node.bump_fee_oracle.get());
+    node.bump_fee_oracle.reset();
     node.connman.reset();
     node.banman.reset();
     node.addrman.reset();
@@ -494,6 +502,8 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-minimumchainwork=<hex>", strprintf("Minimum work assumed to exist on a valid chain in hex (default: %s, testnet3: %s, testnet4: %s, signet: %s)", defaultChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnetChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnet4ChainParams->GetConsensus().nMinimumChainWork.GetHex(), signetChainParams->GetConsensus().nMinimumChainWork.GetHex()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-par=<n>", strprintf("Set the number of script verification threads (0 = auto, up to %d, <0 = leave that many cores free, default: %d)",
         MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-parpin", strprintf("Pin the script verification threads to CPUs, one each, in the order the system numbers them. Only supported on Linux (default: %u)",
+        DEFAULT_SCRIPTCHECK_PIN_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool", strprintf("Whether to save the mempool on shutdown and load on restart (default: %u)", DEFAULT_PERSIST_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempoolv1",
                    strprintf("Whether a mempool.dat file created by -persistmempool or the savemempool RPC will be written in the legacy format "
@@ -1766,6 +1776,14 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
                                      peerman_opts);
     validation_signals.RegisterValidationInterface(node.peerman.get());
 
+    assert(!node.block_template_cache);
+    node.block_template_cache = std::make_unique<BlockTemplateCache>(chainman, *node.mempool);
+    validation_signals.RegisterValidationInterface(node.block_template_cache.get());
+
+    assert(!node.bump_fee_oracle);
+    node.bump_fee_oracle = std::make_unique<BumpFeeOracle>(*node.mempool);
+    validation_signals.RegisterValidationInterface(node.bump_fee_oracle.get());
+
     // ********************************************************* Step 8: start indexers
 
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
@@ -2159,6 +2177,11 @@ bool StartIndexBackgroundSync(NodeContext& node)
         }
     }
 
+    // Let the indexes share the blocks they read while syncing. All of them
+    // must be registered before any thread starts, so they start in step.
+    const auto sync_coordinator{std::make_shared<IndexSyncCoordinator>(chainman.m_blockman)};
+    for (auto index : node.indexes) index->SetSyncCoordinator(sync_coordinator);
+
     // Start threads
     for (auto index : node.indexes) if (!index->StartBackgroundSync()) return false;
     return true;
@@ -20,6 +20,7 @@
 #include <vector>
 
 class ArgsManager;
+class BlockView;
 class CBlock;
 class CBlockUndo;
 class CFeeRate;
@@ -83,6 +84,8 @@ struct BlockInfo {
     int file_number = -1;
     unsigned data_pos = 0;
     const CBlock* data = nullptr;
+    //! Lazily parsed block, passed instead of data to indexes that accept it during their initial sync.
+    const BlockView* view = nullptr;
     const CBlockUndo* undo_data = nullptr;
     // The maximum time in the chain up to and including this block.
     // A timestamp that can only move forward.
@@ -53,6 +53,14 @@ public:
      */
     virtual std::vector<uint256> getCoinbaseMerklePath() = 0;
 
+    /**
+     * Whether the block passed TestBlockValidity. False for a template created
+     * with BlockCreateOptions::defer_validity_check while its check is still
+     * running in the background or after it failed, and for a template created
+     * without a validity check (BlockAssembler::Options::test_block_validity).
+     */
+    virtual bool isValidated() = 0;
+
     /**
      * Construct and broadcast the block.
      *
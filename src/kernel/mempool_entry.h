@@ -11,6 +11,7 @@
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <util/epochguard.h>
 #include <util/overflow.h>
 
@@ -81,7 +82,7 @@ private:
     mutable Children m_children;
     const CAmount nFee;             //!< Cached to avoid expensive parent-transaction lookups
     const int32_t nTxWeight;         //!< ... and avoid recomputing tx weight (also used for GetTxSize())
-    const size_t nUsageSize;        //!< ... and total memory usage
+    size_t nUsageSize;              //!< ... and total memory usage
     const int64_t nTime;            //!< Local time when entering the mempool
     const uint64_t entry_sequence;  //!< Sequence number used to determine whether this transaction is too recent for relay
     const unsigned int entryHeight; //!< Chain height when entering the mempool
@@ -89,6 +90,7 @@ private:
     const int64_t sigOpCost;        //!< Total sigop cost
     CAmount m_modified_fee;         //!< Used for determining the priority of the transaction for mining in a block
     mutable LockPoints lockPoints;  //!< Track the height and time at which tx was final
+    std::shared_ptr<const PrecomputedTransactionData> m_precomputed_txdata; //!< Signature hash data computed when the scripts were checked
 
     // Information about descendants of this transaction that are in the
     // mempool; if we remove this transaction we must remove all of these
@@ -105,6 +107,16 @@ private:
     CAmount nModFeesWithAncestors;
     int64_t nSigOpCostWithAncestors;
 
+    static size_t PrecomputedTxDataUsage(const std::shared_ptr<const PrecomputedTransactionData>& txdata)
+    {
+        if (!txdata) return 0;
+        size_t mem{memusage::DynamicUsage(txdata) + memusage::DynamicUsage(txdata->m_spent_outputs)};
+        for (const CTxOut& out : txdata->m_spent_outputs) {
+            mem += RecursiveDynamicUsage(out);
+        }
+        return mem;
+    }
+
 public:
     CTxMemPoolEntry(const CTransactionRef& tx, CAmount fee,
                     int64_t time, unsigned int entry_height, uint64_t entry_sequence,
@@ -149,6 +161,15 @@ public:
     CAmount GetModifiedFee() const { return m_modified_fee; }
     size_t DynamicMemoryUsage() const { return nUsageSize; }
     const LockPoints& GetLockPoints() const { return lockPoints; }
+    //! Data precomputed for the signature hashes when the transaction's scripts were checked, if kept.
+    const std::shared_ptr<const PrecomputedTransactionData>& GetPrecomputedTxData() const { return m_precomputed_txdata; }
+
+    //! Keep the precomputed signature hash data, which counts towards the memory usage.
+    void SetPrecomputedTxData(std::shared_ptr<const PrecomputedTransactionData> txdata)
+    {
+        nUsageSize = nUsageSize - PrecomputedTxDataUsage(m_precomputed_txdata) + PrecomputedTxDataUsage(txdata);
+        m_precomputed_txdata = std::move(txdata);
+    }
 
     // Adjusts the descendant state.
     void UpdateDescendantState(int32_t modifySize, CAmount modifyFee, int64_t modifyCount);
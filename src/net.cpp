@@ -118,9 +118,20 @@ GlobalMutex g_maplocalhost_mutex;
 std::map<CNetAddr, LocalServiceInfo> mapLocalHost GUARDED_BY(g_maplocalhost_mutex);
 std::string strSubVersion;
 
+SharedNetMsgPayload::SharedNetMsgPayload(std::vector<unsigned char> data_in)
+    : data{std::move(data_in)}, hash{Hash(data)} {}
+
 size_t CSerializedNetMsg::GetMemoryUsage() const noexcept
 {
-    return sizeof(*this) + memusage::DynamicUsage(m_type) + memusage::DynamicUsage(data);
+    // A shared payload is accounted in full to every message referring to it,
+    // as it stays alive as long as any of them is queued.
+    return sizeof(*this) + memusage::DynamicUsage(m_type) + memusage::DynamicUsage(data) +
+           (m_shared_payload ? sizeof(SharedNetMsgPayload) + memusage::DynamicUsage(m_shared_payload->data) : 0);
+}
+
+CNetMessage::~CNetMessage()
+{
+    if (m_recv_pool) m_recv_pool->Put(m_recv.ReleaseBuffer());
 }
 
 size_t CNetMessage::GetMemoryUsage() const noexcept
@@ -538,6 +549,7 @@ CNode* CConnman::ConnectNode(CAddress addrConnect, const char *pszDest, bool fCo
                                     .i2p_sam_session = std::move(i2p_transient_session),
                                     .recv_flood_size = nReceiveFloodSize,
                                     .use_v2transport = use_v2transport,
+                                    .recv_buffer_pool = m_recv_buffer_pool,
                                 });
         pnode->AddRef();
 
@@ -712,8 +724,8 @@ std::string CNode::DisconnectMsg(bool log_ip) const
                      LogIP(log_ip));
 }
 
-V1Transport::V1Transport(const NodeId node_id) noexcept
-    : m_magic_bytes{Params().MessageStart()}, m_node_id{node_id}
+V1Transport::V1Transport(const NodeId node_id, std::shared_ptr<node::RecvBufferPool> recv_pool) noexcept
+    : m_magic_bytes{Params().MessageStart()}, m_node_id{node_id}, m_recv_pool{std::move(recv_pool)}
 {
     LOCK(m_recv_mutex);
     Reset();
@@ -761,6 +773,12 @@ int V1Transport::readHeader(std::span<const uint8_t> msg_bytes)
         return -1;
     }
 
+    // Read the payload straight into a pooled buffer that fits it, if there is one.
+    if (m_recv_pool) {
+        m_recv_pool->Put(vRecv.ReleaseBuffer());
+        vRecv = DataStream{m_recv_pool->Get(hdr.nMessageSize)};
+    }
+
     // switch state to reading message data
     in_data = true;
 
@@ -802,6 +820,7 @@ CNetMessage V1Transport::GetReceivedMessage(const std::chrono::microseconds time
     // decompose a single CNetMessage from the TransportDeserializer
     LOCK(m_recv_mutex);
     CNetMessage msg(std::move(vRecv));
+    msg.m_recv_pool = m_recv_pool;
 
     // store message type string, time, and sizes
     msg.m_type = hdr.GetMessageType();
@@ -833,25 +852,38 @@ CNetMessage V1Transport::GetReceivedMessage(const std::chrono::microseconds time
     return msg;
 }
 
-bool V1Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
+std::vector<uint8_t> V1Transport::MakeHeader(const CSerializedNetMsg& msg) const noexcept
 {
-    AssertLockNotHeld(m_send_mutex);
-    // Determine whether a new message can be set.
-    LOCK(m_send_mutex);
-    if (m_sending_header || m_bytes_sent < m_message_to_send.data.size()) return false;
-
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    // create dbl-sha256 checksum, which shared payloads have precomputed
+    const uint256 hash = msg.m_shared_payload ? msg.m_shared_payload->hash : Hash(msg.data);
 
     // create header
-    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.data.size());
+    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.Payload().size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
-    m_header_to_send.clear();
-    VectorWriter{m_header_to_send, 0, hdr};
+    std::vector<uint8_t> header;
+    VectorWriter{header, 0, hdr};
+    return header;
+}
+
+bool V1Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    // Determine whether a new message can be set.
+    LOCK(m_send_mutex);
+    if (m_sending_header || m_bytes_sent < m_message_to_send.Payload().size()) {
+        // Queue it behind the message being sent, unless enough is queued already.
+        const size_t unsent{(m_sending_header ? m_header_to_send.size() + m_message_to_send.Payload().size() : m_message_to_send.Payload().size()) - m_bytes_sent};
+        if (m_send_queue.size() + 1 >= MAX_SEND_BATCH_MESSAGES || unsent + m_send_queue_bytes >= MAX_SEND_BATCH_BYTES) return false;
+        auto header{MakeHeader(msg)};
+        m_send_queue_bytes += header.size() + msg.Payload().size();
+        m_send_queue.emplace_back(std::move(header), std::move(msg));
+        return true;
+    }
 
     // update state
+    m_header_to_send = MakeHeader(msg);
     m_message_to_send = std::move(msg);
     m_sending_header = true;
     m_bytes_sent = 0;
@@ -866,32 +898,81 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
         return {std::span{m_header_to_send}.subspan(m_bytes_sent),
                 // We have more to send after the header if the message has payload, or if there
                 // is a next message after that.
-                have_next_message || !m_message_to_send.data.empty(),
+                have_next_message || !m_message_to_send.Payload().empty() || !m_send_queue.empty(),
                 m_message_to_send.m_type
                };
     } else {
-        return {std::span{m_message_to_send.data}.subspan(m_bytes_sent),
+        return {m_message_to_send.Payload().subspan(m_bytes_sent),
                 // We only have more to send after this message's payload if there is another
                 // message.
-                have_next_message,
+                have_next_message || !m_send_queue.empty(),
                 m_message_to_send.m_type
                };
     }
 }
 
+bool V1Transport::GetBytesToSendBatch(bool have_next_message, std::vector<SendChunk>& chunks, size_t max_chunks) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    LOCK(m_send_mutex);
+    chunks.clear();
+    // Chunks not returned because of max_chunks.
+    bool left_out{false};
+    const auto add{[&](std::span<const uint8_t> data, const std::string& msg_type) {
+        if (data.empty()) return;
+        if (chunks.size() == max_chunks) {
+            left_out = true;
+            return;
+        }
+        chunks.push_back({data, &msg_type});
+    }};
+    if (m_sending_header) {
+        add(std::span{m_header_to_send}.subspan(m_bytes_sent), m_message_to_send.m_type);
+        add(m_message_to_send.Payload(), m_message_to_send.m_type);
+    } else {
+        add(m_message_to_send.Payload().subspan(m_bytes_sent), m_message_to_send.m_type);
+    }
+    for (const auto& [header, msg] : m_send_queue) {
+        add(header, msg.m_type);
+        add(msg.Payload(), msg.m_type);
+    }
+    return have_next_message || left_out;
+}
+
 void V1Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
     LOCK(m_send_mutex);
-    m_bytes_sent += bytes_sent;
-    if (m_sending_header && m_bytes_sent == m_header_to_send.size()) {
-        // We're done sending a message's header. Switch to sending its data bytes.
-        m_sending_header = false;
-        m_bytes_sent = 0;
-    } else if (!m_sending_header && m_bytes_sent == m_message_to_send.data.size()) {
-        // We're done sending a message's data. Wipe the data vector to reduce memory consumption.
-        ClearShrink(m_message_to_send.data);
-        m_bytes_sent = 0;
+    // The bytes sent may span several chunks (see GetBytesToSendBatch).
+    while (true) {
+        const size_t unsent{(m_sending_header ? m_header_to_send.size() : m_message_to_send.Payload().size()) - m_bytes_sent};
+        const size_t sent_now{std::min(bytes_sent, unsent)};
+        m_bytes_sent += sent_now;
+        bytes_sent -= sent_now;
+        bool next_chunk{false};
+        if (m_sending_header && m_bytes_sent == m_header_to_send.size()) {
+            // We're done sending a message's header. Switch to sending its data bytes.
+            m_sending_header = false;
+            m_bytes_sent = 0;
+            next_chunk = true;
+        }
+        if (!m_sending_header && m_bytes_sent == m_message_to_send.Payload().size()) {
+            // We're done sending a message's data. Wipe the data vector to reduce memory consumption.
+            ClearShrink(m_message_to_send.data);
+            m_message_to_send.m_shared_payload.reset();
+            m_bytes_sent = 0;
+            // Continue with the next queued message, if any.
+            if (!m_send_queue.empty()) {
+                auto& [header, msg] = m_send_queue.front();
+                m_send_queue_bytes -= header.size() + msg.Payload().size();
+                m_header_to_send = std::move(header);
+                m_message_to_send = std::move(msg);
+                m_sending_header = true;
+                m_send_queue.pop_front();
+                next_chunk = true;
+            }
+        }
+        if (bytes_sent == 0 || !Assume(next_chunk)) break;
     }
 }
 
@@ -899,8 +980,12 @@ size_t V1Transport::GetSendMemoryUsage() const noexcept
 {
     AssertLockNotHeld(m_send_mutex);
     LOCK(m_send_mutex);
-    // Don't count sending-side fields besides m_message_to_send, as they're all small and bounded.
-    return m_message_to_send.GetMemoryUsage();
+    // Don't count sending-side fields besides the messages, as they're all small and bounded.
+    size_t usage{m_message_to_send.GetMemoryUsage()};
+    for (const auto& [header, msg] : m_send_queue) {
+        usage += msg.GetMemoryUsage();
+    }
+    return usage;
 }
 
 namespace {
@@ -992,9 +1077,11 @@ void V2Transport::StartSendingHandshake() noexcept
     // We cannot wipe m_send_garbage as it will still be used as AAD later in the handshake.
 }
 
-V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage) noexcept
+V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage,
+                         std::shared_ptr<node::RecvBufferPool> recv_pool) noexcept
     : m_cipher{key, ent32}, m_initiating{initiating}, m_nodeid{nodeid},
-      m_v1_fallback{nodeid},
+      m_v1_fallback{nodeid, recv_pool},
+      m_recv_pool{std::move(recv_pool)},
       m_recv_state{initiating ? RecvState::KEY : RecvState::KEY_MAYBE_V1},
       m_send_garbage{std::move(garbage)},
       m_send_state{initiating ? SendState::AWAITING_KEY : SendState::MAYBE_V1}
@@ -1007,9 +1094,9 @@ V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::s
     }
 }
 
-V2Transport::V2Transport(NodeId nodeid, bool initiating) noexcept
+V2Transport::V2Transport(NodeId nodeid, bool initiating, std::shared_ptr<node::RecvBufferPool> recv_pool) noexcept
     : V2Transport{nodeid, initiating, GenerateRandomKey(),
-                  MakeByteSpan(GetRandHash()), GenerateRandomGarbage()} {}
+                  MakeByteSpan(GetRandHash()), GenerateRandomGarbage(), std::move(recv_pool)} {}
 
 void V2Transport::SetReceiveState(RecvState recv_state) noexcept
 {
@@ -1209,24 +1296,28 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
         1 + CMessageHeader::MESSAGE_TYPE_SIZE +
         std::min<size_t>(MAX_SIZE, MAX_PROTOCOL_MESSAGE_LENGTH);
 
-    if (m_recv_buffer.size() == BIP324Cipher::LENGTH_LEN) {
+    if (m_recv_buffer.size() == BIP324Cipher::LENGTH_LEN && m_recv_packet.empty()) {
         // Length descriptor received.
         m_recv_len = m_cipher.DecryptLength(MakeByteSpan(m_recv_buffer));
         if (m_recv_len > MAX_CONTENTS_LEN) {
             LogDebug(BCLog::NET, "V2 transport error: packet too large (%u bytes), peer=%d\n", m_recv_len, m_nodeid);
             return false;
         }
-    } else if (m_recv_buffer.size() > BIP324Cipher::LENGTH_LEN && m_recv_buffer.size() == m_recv_len + BIP324Cipher::EXPANSION) {
-        // Ciphertext received, decrypt it into m_recv_decode_buffer.
+        // Receive the rest of the packet straight into a pooled buffer that fits it, if there is
+        // one.
+        if (m_recv_pool) m_recv_packet = m_recv_pool->Get(m_recv_len + BIP324Cipher::EXPANSION - BIP324Cipher::LENGTH_LEN);
+    } else if (m_recv_packet.size() == m_recv_len + BIP324Cipher::EXPANSION - BIP324Cipher::LENGTH_LEN) {
+        // Ciphertext received, decrypt it in place.
         // Note that it is impossible to reach this branch without hitting the branch above first,
-        // as GetMaxBytesToProcess only allows up to LENGTH_LEN into the buffer before that point.
-        m_recv_decode_buffer.resize(m_recv_len);
+        // as GetMaxBytesToProcess only allows up to LENGTH_LEN into m_recv_buffer, and nothing
+        // into m_recv_packet, before that point.
         bool ignore{false};
+        const std::span<std::byte> packet{m_recv_packet};
         bool ret = m_cipher.Decrypt(
-            /*input=*/MakeByteSpan(m_recv_buffer).subspan(BIP324Cipher::LENGTH_LEN),
+            /*input=*/packet,
             /*aad=*/MakeByteSpan(m_recv_aad),
             /*ignore=*/ignore,
-            /*contents=*/MakeWritableByteSpan(m_recv_decode_buffer));
+            /*contents=*/packet.subspan(BIP324Cipher::HEADER_LEN, m_recv_len));
         if (!ret) {
             LogDebug(BCLog::NET, "V2 transport error: packet decryption failure (%u bytes), peer=%d\n", m_recv_len, m_nodeid);
             return false;
@@ -1234,9 +1325,9 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
         // We have decrypted a valid packet with the AAD we expected, so clear the expected AAD.
         ClearShrink(m_recv_aad);
         // Feed the last 4 bytes of the Poly1305 authentication tag (and its timing) into our RNG.
-        RandAddEvent(ReadLE32(m_recv_buffer.data() + m_recv_buffer.size() - 4));
+        RandAddEvent(ReadLE32(UCharCast(m_recv_packet.data() + m_recv_packet.size() - 4)));
 
-        // At this point we have a valid packet decrypted into m_recv_decode_buffer. If it's not a
+        // At this point we have a valid packet decrypted in m_recv_packet. If it's not a
         // decoy, which we simply ignore, use the current state to decide what to do with it.
         if (!ignore) {
             switch (m_recv_state) {
@@ -1254,10 +1345,10 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
                 Assume(false);
             }
         }
-        // Wipe the receive buffer where the next packet will be received into.
-        ClearShrink(m_recv_buffer);
-        // In all but APP_READY state, we can wipe the decoded contents.
-        if (m_recv_state != RecvState::APP_READY) ClearShrink(m_recv_decode_buffer);
+        // Wipe the length descriptor, the next packet's one will be received into m_recv_buffer.
+        m_recv_buffer.clear();
+        // In all but APP_READY state, we can wipe the decoded packet.
+        if (m_recv_state != RecvState::APP_READY) ReleaseReceivedPacket();
     } else {
         // We either have less than 3 bytes, so we don't know the packet's length yet, or more
         // than 3 bytes but less than the packet's full ciphertext. Wait until those arrive.
@@ -1265,6 +1356,13 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
     return true;
 }
 
+void V2Transport::ReleaseReceivedPacket() noexcept
+{
+    AssertLockHeld(m_recv_mutex);
+    auto packet{std::exchange(m_recv_packet, {})};
+    if (m_recv_pool) m_recv_pool->Put(std::move(packet));
+}
+
 size_t V2Transport::GetMaxBytesToProcess() noexcept
 {
     AssertLockHeld(m_recv_mutex);
@@ -1298,9 +1396,9 @@ size_t V2Transport::GetMaxBytesToProcess() noexcept
         } else {
             // Note that BIP324Cipher::EXPANSION is the total difference between contents size
             // and encoded packet size, which includes the 3 bytes due to the packet length.
-            // When transitioning from receiving the packet length to receiving its ciphertext,
-            // the encrypted packet length is left in the receive buffer.
-            return BIP324Cipher::EXPANSION + m_recv_len - m_recv_buffer.size();
+            // The encrypted packet length is left in the receive buffer, and the rest of the
+            // packet is received into m_recv_packet.
+            return BIP324Cipher::EXPANSION - BIP324Cipher::LENGTH_LEN + m_recv_len - m_recv_packet.size();
         }
     case RecvState::APP_READY:
         // No bytes can be processed until GetMessage() is called.
@@ -1328,9 +1426,30 @@ bool V2Transport::ReceivedBytes(std::span<const uint8_t>& msg_bytes) noexcept
     // appended to m_recv_buffer. Then, depending on the receiver state, one of the
     // ProcessReceived*Bytes functions is called to process the bytes in that buffer.
     while (!msg_bytes.empty()) {
-        // Decide how many bytes to copy from msg_bytes to m_recv_buffer.
+        // Decide how many bytes to copy from msg_bytes to m_recv_buffer (or m_recv_packet).
         size_t max_read = GetMaxBytesToProcess();
 
+        if ((m_recv_state == RecvState::VERSION || m_recv_state == RecvState::APP) && m_recv_buffer.size() == BIP324Cipher::LENGTH_LEN) {
+            // The packet length is known, receive the rest of the packet into m_recv_packet. Reserve
+            // as much as is expected but never more than MAX_RESERVE_AHEAD bytes in addition to what
+            // is received so far. This means attackers that want to cause us to waste allocated
+            // memory are limited to MAX_RESERVE_AHEAD above the largest allowed message contents
+            // size, and to MAX_RESERVE_AHEAD more than they've actually sent us (unless the buffer
+            // came from the pool, in which case it was allocated already anyway).
+            if (m_recv_packet.size() + std::min(msg_bytes.size(), max_read) > m_recv_packet.capacity()) {
+                size_t alloc_add = std::min(max_read, msg_bytes.size() + MAX_RESERVE_AHEAD);
+                m_recv_packet.reserve(m_recv_packet.size() + alloc_add);
+            }
+            max_read = std::min(msg_bytes.size(), max_read);
+            const auto packet_bytes{std::as_bytes(msg_bytes.first(max_read))};
+            m_recv_packet.insert(m_recv_packet.end(), packet_bytes.begin(), packet_bytes.end());
+            msg_bytes = msg_bytes.subspan(max_read);
+            if (!ProcessReceivedPacketBytes()) return false;
+            // Make sure we have made progress before continuing.
+            Assume(max_read > 0);
+            continue;
+        }
+
         // Reserve space in the buffer if there is not enough.
         if (m_recv_buffer.size() + std::min(msg_bytes.size(), max_read) > m_recv_buffer.capacity()) {
             switch (m_recv_state) {
@@ -1342,16 +1461,11 @@ bool V2Transport::ReceivedBytes(std::span<const uint8_t>& msg_bytes) noexcept
                 m_recv_buffer.reserve(MAX_GARBAGE_LEN + BIP324Cipher::GARBAGE_TERMINATOR_LEN);
                 break;
             case RecvState::VERSION:
-            case RecvState::APP: {
-                // During states where a packet is being received, as much as is expected but never
-                // more than MAX_RESERVE_AHEAD bytes in addition to what is received so far.
-                // This means attackers that want to cause us to waste allocated memory are limited
-                // to MAX_RESERVE_AHEAD above the largest allowed message contents size, and to
-                // MAX_RESERVE_AHEAD more than they've actually sent us.
-                size_t alloc_add = std::min(max_read, msg_bytes.size() + MAX_RESERVE_AHEAD);
-                m_recv_buffer.reserve(m_recv_buffer.size() + alloc_add);
+            case RecvState::APP:
+                // During states where a packet is being received, only its length descriptor is
+                // received into this buffer.
+                m_recv_buffer.reserve(BIP324Cipher::LENGTH_LEN);
                 break;
-            }
             case RecvState::APP_READY:
                 // The buffer is empty in this state.
                 Assume(m_recv_buffer.empty());
@@ -1451,23 +1565,28 @@ CNetMessage V2Transport::GetReceivedMessage(std::chrono::microseconds time, bool
     if (m_recv_state == RecvState::V1) return m_v1_fallback.GetReceivedMessage(time, reject_message);
 
     Assume(m_recv_state == RecvState::APP_READY);
-    std::span<const uint8_t> contents{m_recv_decode_buffer};
+    // The decrypted contents follow the packet header, and are followed by the authentication tag.
+    std::span<const uint8_t> contents{UCharCast(m_recv_packet.data()) + BIP324Cipher::HEADER_LEN, m_recv_len};
     auto msg_type = GetMessageType(contents);
     CNetMessage msg{DataStream{}};
     // Note that BIP324Cipher::EXPANSION also includes the length descriptor size.
-    msg.m_raw_message_size = m_recv_decode_buffer.size() + BIP324Cipher::EXPANSION;
+    msg.m_raw_message_size = m_recv_len + BIP324Cipher::EXPANSION;
     if (msg_type) {
         reject_message = false;
         msg.m_type = std::move(*msg_type);
         msg.m_time = time;
         msg.m_message_size = contents.size();
-        msg.m_recv.resize(contents.size());
-        std::copy(contents.begin(), contents.end(), UCharCast(msg.m_recv.data()));
+        // Hand the packet buffer over to the message, skipping everything before the payload.
+        const size_t payload_offset = contents.data() - UCharCast(m_recv_packet.data());
+        m_recv_packet.resize(payload_offset + contents.size());
+        msg.m_recv = DataStream{std::move(m_recv_packet)};
+        msg.m_recv.ignore(payload_offset);
+        msg.m_recv_pool = m_recv_pool;
     } else {
-        LogDebug(BCLog::NET, "V2 transport error: invalid message type (%u bytes contents), peer=%d\n", m_recv_decode_buffer.size(), m_nodeid);
+        LogDebug(BCLog::NET, "V2 transport error: invalid message type (%u bytes contents), peer=%d\n", m_recv_len, m_nodeid);
         reject_message = true;
     }
-    ClearShrink(m_recv_decode_buffer);
+    ReleaseReceivedPacket();
     SetReceiveState(RecvState::APP);
 
     return msg;
@@ -1479,29 +1598,39 @@ bool V2Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     LOCK(m_send_mutex);
     if (m_send_state == SendState::V1) return m_v1_fallback.SetMessageToSend(msg);
     // We only allow adding a new message to be sent when in the READY state (so the packet cipher
-    // is available) and the send buffer is empty. This limits the number of messages in the send
-    // buffer to just one, and leaves the responsibility for queueing them up to the caller.
-    if (!(m_send_state == SendState::READY && m_send_buffer.empty())) return false;
-    // Construct contents (encoding message type + payload).
-    std::vector<uint8_t> contents;
+    // is available), and the send buffer holds no handshake bytes and not too many packets yet.
+    // Further queueing is left to the caller.
+    if (m_send_state != SendState::READY) return false;
+    if (!m_send_buffer.empty()) {
+        if (m_send_packets.empty()) return false;
+        if (m_send_packets.size() >= MAX_SEND_BATCH_MESSAGES || m_send_buffer.size() - m_send_pos >= MAX_SEND_BATCH_BYTES) return false;
+        // Drop the bytes sent already, so they are not moved around when the buffer grows.
+        m_send_buffer.erase(m_send_buffer.begin(), m_send_buffer.begin() + m_send_pos);
+        for (auto& [packet_end, _] : m_send_packets) packet_end -= m_send_pos;
+        m_send_pos = 0;
+    }
+    // Construct contents (encoding message type + payload) directly in the send buffer, after the
+    // space for the encrypted length and header, and encrypt them there in place.
+    const auto payload{msg.Payload()};
     auto short_message_id = V2_MESSAGE_MAP(msg.m_type);
+    const size_t type_size{short_message_id ? 1 : 1 + CMessageHeader::MESSAGE_TYPE_SIZE};
+    const size_t packet_start{m_send_buffer.size()};
+    const size_t contents_start{packet_start + BIP324Cipher::LENGTH_LEN + BIP324Cipher::HEADER_LEN};
+    // Initialize with zeroes. For long message types, the message type string is written
+    // starting at offset 1, so contents[0] and the unused positions in contents[1..13] remain 0x00.
+    m_send_buffer.resize(packet_start + type_size + payload.size() + BIP324Cipher::EXPANSION, 0);
+    const std::span contents{std::span{m_send_buffer}.subspan(contents_start, type_size + payload.size())};
     if (short_message_id) {
-        contents.resize(1 + msg.data.size());
         contents[0] = *short_message_id;
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1);
     } else {
-        // Initialize with zeroes, and then write the message type string starting at offset 1.
-        // This means contents[0] and the unused positions in contents[1..13] remain 0x00.
-        contents.resize(1 + CMessageHeader::MESSAGE_TYPE_SIZE + msg.data.size(), 0);
-        std::copy(msg.m_type.begin(), msg.m_type.end(), contents.data() + 1);
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1 + CMessageHeader::MESSAGE_TYPE_SIZE);
-    }
-    // Construct ciphertext in send buffer.
-    m_send_buffer.resize(contents.size() + BIP324Cipher::EXPANSION);
-    m_cipher.Encrypt(MakeByteSpan(contents), {}, false, MakeWritableByteSpan(m_send_buffer));
-    m_send_type = msg.m_type;
+        std::copy(msg.m_type.begin(), msg.m_type.end(), contents.begin() + 1);
+    }
+    std::copy(payload.begin(), payload.end(), contents.begin() + type_size);
+    m_cipher.Encrypt(MakeByteSpan(contents), {}, false, MakeWritableByteSpan(std::span{m_send_buffer}.subspan(packet_start)));
+    m_send_packets.emplace_back(m_send_buffer.size(), msg.m_type);
     // Release memory
     ClearShrink(msg.data);
+    msg.m_shared_payload.reset();
     return true;
 }
 
@@ -1513,15 +1642,51 @@ Transport::BytesToSend V2Transport::GetBytesToSend(bool have_next_message) const
 
     if (m_send_state == SendState::MAYBE_V1) Assume(m_send_buffer.empty());
     Assume(m_send_pos <= m_send_buffer.size());
+    if (m_send_packets.empty()) {
+        // Handshake bytes, or nothing.
+        static const std::string EMPTY_TYPE;
+        return {
+            std::span{m_send_buffer}.subspan(m_send_pos),
+            // We only have more to send after the current m_send_buffer if there is a (next)
+            // message to be sent, and we're capable of sending packets. */
+            have_next_message && m_send_state == SendState::READY,
+            EMPTY_TYPE
+        };
+    }
+    // Return one packet at a time, so the bytes can be accounted to its message type.
+    const auto& [packet_end, msg_type] = m_send_packets.front();
     return {
-        std::span{m_send_buffer}.subspan(m_send_pos),
-        // We only have more to send after the current m_send_buffer if there is a (next)
-        // message to be sent, and we're capable of sending packets. */
-        have_next_message && m_send_state == SendState::READY,
-        m_send_type
+        std::span{m_send_buffer}.first(packet_end).subspan(m_send_pos),
+        have_next_message || m_send_packets.size() > 1,
+        msg_type
     };
 }
 
+bool V2Transport::GetBytesToSendBatch(bool have_next_message, std::vector<SendChunk>& chunks, size_t max_chunks) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    LOCK(m_send_mutex);
+    if (m_send_state == SendState::V1) return m_v1_fallback.GetBytesToSendBatch(have_next_message, chunks, max_chunks);
+
+    chunks.clear();
+    if (m_send_packets.empty()) {
+        static const std::string EMPTY_TYPE;
+        if (m_send_pos < m_send_buffer.size() && max_chunks > 0) {
+            chunks.push_back({std::span{m_send_buffer}.subspan(m_send_pos), &EMPTY_TYPE});
+        }
+        return have_next_message && m_send_state == SendState::READY;
+    }
+    // All packets are in the same buffer, but return one chunk per packet so the bytes can be
+    // accounted to their message types.
+    size_t packet_start{m_send_pos};
+    for (const auto& [packet_end, msg_type] : m_send_packets) {
+        if (chunks.size() == max_chunks) return true;
+        chunks.push_back({std::span{m_send_buffer}.first(packet_end).subspan(packet_start), &msg_type});
+        packet_start = packet_end;
+    }
+    return have_next_message;
+}
+
 void V2Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
@@ -1537,6 +1702,9 @@ void V2Transport::MarkBytesSent(size_t bytes_sent) noexcept
     if (m_send_pos >= CMessageHeader::HEADER_SIZE) {
         m_sent_v1_header_worth = true;
     }
+    while (!m_send_packets.empty() && m_send_packets.front().first <= m_send_pos) {
+        m_send_packets.pop_front();
+    }
     // Wipe the buffer when everything is sent.
     if (m_send_pos == m_send_buffer.size()) {
         m_send_pos = 0;
@@ -1597,28 +1765,35 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
     size_t nSentSize = 0;
     bool data_left{false}; //!< second return value (whether unsent data remains)
     std::optional<bool> expected_more;
+    std::vector<Transport::SendChunk> chunks;
+    std::vector<std::span<const unsigned char>> spans;
 
     while (true) {
-        if (it != node.vSendMsg.end()) {
-            // If possible, move one message from the send queue to the transport. This fails when
-            // there is an existing message still being sent, or (for v2 transports) when the
-            // handshake has not yet completed.
+        // Move as many messages from the send queue to the transport as it accepts, so they can
+        // be sent together. This fails when the transport holds enough already, or (for v2
+        // transports) when the handshake has not yet completed.
+        while (it != node.vSendMsg.end()) {
             size_t memusage = it->GetMemoryUsage();
-            if (node.m_transport->SetMessageToSend(*it)) {
-                // Update memory usage of send buffer (as *it will be deleted).
-                node.m_send_memusage -= memusage;
-                ++it;
-            }
+            if (!node.m_transport->SetMessageToSend(*it)) break;
+            // Update memory usage of send buffer (as *it will be deleted).
+            node.m_send_memusage -= memusage;
+            ++it;
         }
-        const auto& [data, more, msg_type] = node.m_transport->GetBytesToSend(it != node.vSendMsg.end());
-        // We rely on the 'more' value returned by GetBytesToSend to correctly predict whether more
-        // bytes are still to be sent, to correctly set the MSG_MORE flag. As a sanity check,
+        const bool more{node.m_transport->GetBytesToSendBatch(it != node.vSendMsg.end(), chunks, Sock::MAX_SEND_CHUNKS)};
+        // We rely on the 'more' value returned by GetBytesToSendBatch to correctly predict whether
+        // more bytes are still to be sent, to correctly set the MSG_MORE flag. As a sanity check,
         // verify that the previously returned 'more' was correct.
-        if (expected_more.has_value()) Assume(!data.empty() == *expected_more);
+        if (expected_more.has_value()) Assume(!chunks.empty() == *expected_more);
         expected_more = more;
-        data_left = !data.empty(); // will be overwritten on next loop if all of data gets sent
+        data_left = !chunks.empty(); // will be overwritten on next loop if all of data gets sent
+        spans.clear();
+        size_t to_send{0};
+        for (const auto& chunk : chunks) {
+            spans.push_back(chunk.data);
+            to_send += chunk.data.size();
+        }
         int nBytes = 0;
-        if (!data.empty()) {
+        if (!chunks.empty()) {
             LOCK(node.m_sock_mutex);
             // There is no socket in case we've already disconnected, or in test cases without
             // real connections. In these cases, we bail out immediately and just leave things
@@ -1632,20 +1807,27 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 flags |= MSG_MORE;
             }
 #endif
-            nBytes = node.m_sock->Send(reinterpret_cast<const char*>(data.data()), data.size(), flags);
+            // Hand all chunks to the socket with a single call.
+            nBytes = node.m_sock->SendV(spans, flags);
         }
         if (nBytes > 0) {
             node.m_last_send = GetTime<std::chrono::seconds>();
             node.nSendBytes += nBytes;
-            // Notify transport that bytes have been processed.
-            node.m_transport->MarkBytesSent(nBytes);
             // Update statistics per message type.
-            if (!msg_type.empty()) { // don't report v2 handshake bytes for now
-                node.AccountForSentBytes(msg_type, nBytes);
+            size_t accounted{0};
+            for (const auto& chunk : chunks) {
+                if (accounted == (size_t)nBytes) break;
+                const size_t chunk_sent{std::min(chunk.data.size(), nBytes - accounted)};
+                if (!chunk.m_type->empty()) { // don't report v2 handshake bytes for now
+                    node.AccountForSentBytes(*chunk.m_type, chunk_sent);
+                }
+                accounted += chunk_sent;
             }
+            // Notify transport that bytes have been processed. This invalidates the chunks.
+            node.m_transport->MarkBytesSent(nBytes);
             nSentSize += nBytes;
-            if ((size_t)nBytes != data.size()) {
-                // could not send full message; stop sending more
+            if ((size_t)nBytes != to_send) {
+                // could not send all data; stop sending more
                 break;
             }
         } else {
@@ -1837,6 +2019,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock>&& sock,
                                  .prefer_evict = discouraged,
                                  .recv_flood_size = nReceiveFloodSize,
                                  .use_v2transport = use_v2transport,
+                                 .recv_buffer_pool = m_recv_buffer_pool,
                              });
     pnode->AddRef();
     m_msgproc->InitializeNode(*pnode, local_services);
@@ -3777,12 +3960,12 @@ ServiceFlags CConnman::GetLocalServices() const
     return m_local_services;
 }
 
-static std::unique_ptr<Transport> MakeTransport(NodeId id, bool use_v2transport, bool inbound) noexcept
+static std::unique_ptr<Transport> MakeTransport(NodeId id, bool use_v2transport, bool inbound, std::shared_ptr<node::RecvBufferPool> recv_pool) noexcept
 {
     if (use_v2transport) {
-        return std::make_unique<V2Transport>(id, /*initiating=*/!inbound);
+        return std::make_unique<V2Transport>(id, /*initiating=*/!inbound, std::move(recv_pool));
     } else {
-        return std::make_unique<V1Transport>(id);
+        return std::make_unique<V1Transport>(id, std::move(recv_pool));
     }
 }
 
@@ -3796,7 +3979,7 @@ CNode::CNode(NodeId idIn,
              ConnectionType conn_type_in,
              bool inbound_onion,
              CNodeOptions&& node_opts)
-    : m_transport{MakeTransport(idIn, node_opts.use_v2transport, conn_type_in == ConnectionType::INBOUND)},
+    : m_transport{MakeTransport(idIn, node_opts.use_v2transport, conn_type_in == ConnectionType::INBOUND, std::move(node_opts.recv_buffer_pool))},
       m_permission_flags{node_opts.permission_flags},
       m_sock{sock},
       m_connected{GetTime<std::chrono::seconds>()},
@@ -3866,10 +4049,10 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
-    size_t nMessageSize = msg.data.size();
+    size_t nMessageSize = msg.Payload().size();
     LogDebug(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.m_type, nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data, /*is_incoming=*/false);
+        CaptureMessage(pnode->addr, msg.m_type, msg.Payload(), /*is_incoming=*/false);
     }
 
     TRACEPOINT(net, outbound_message,
@@ -3877,8 +4060,8 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         pnode->m_addr_name.c_str(),
         pnode->ConnectionTypeAsString().c_str(),
         msg.m_type.c_str(),
-        msg.data.size(),
-        msg.data.data()
+        msg.Payload().size(),
+        msg.Payload().data()
     );
 
     size_t nBytesSent = 0;
@@ -21,6 +21,7 @@
 #include <netgroup.h>
 #include <node/connection_types.h>
 #include <node/protocol_version.h>
+#include <node/recvbufferpool.h>
 #include <policy/feerate.h>
 #include <protocol.h>
 #include <random.h>
@@ -92,6 +93,8 @@ static constexpr bool DEFAULT_DNSSEED{true};
 static constexpr bool DEFAULT_FIXEDSEEDS{true};
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** Maximum size of the idle receive buffers kept around for reuse by all peers. */
+static constexpr size_t MAX_RECV_BUFFER_POOL_USAGE{32 << 20};
 
 static constexpr bool DEFAULT_V2_TRANSPORT{true};
 
@@ -112,6 +115,18 @@ struct AddedNodeInfo {
 class CNodeStats;
 class CClientUIInterface;
 
+/**
+ * Immutable serialized message payload, which can be sent to several peers
+ * without copying it (e.g. a block requested by many of them).
+ */
+struct SharedNetMsgPayload {
+    explicit SharedNetMsgPayload(std::vector<unsigned char> data_in);
+
+    const std::vector<unsigned char> data;
+    /** Double-SHA256 of data, for the checksum in v1 message headers. */
+    const uint256 hash;
+};
+
 struct CSerializedNetMsg {
     CSerializedNetMsg() = default;
     CSerializedNetMsg(CSerializedNetMsg&&) = default;
@@ -125,11 +140,20 @@ struct CSerializedNetMsg {
         CSerializedNetMsg copy;
         copy.data = data;
         copy.m_type = m_type;
+        copy.m_shared_payload = m_shared_payload;
         return copy;
     }
 
     std::vector<unsigned char> data;
     std::string m_type;
+    /** Payload shared with other messages. If set, it is sent instead of data. */
+    std::shared_ptr<const SharedNetMsgPayload> m_shared_payload;
+
+    /** The payload to send, whether owned by this message or shared. */
+    std::span<const unsigned char> Payload() const noexcept
+    {
+        return m_shared_payload ? std::span{m_shared_payload->data} : std::span{data};
+    }
 
     /** Compute total memory usage of this object (own memory + any dynamic memory). */
     size_t GetMemoryUsage() const noexcept;
@@ -237,7 +261,11 @@ public:
     uint32_t m_raw_message_size{0};      //!< used wire size of the message (including header/checksum)
     std::string m_type;
 
+    //! Pool to return the storage of m_recv to once the message is destroyed, if any.
+    std::shared_ptr<node::RecvBufferPool> m_recv_pool;
+
     explicit CNetMessage(DataStream&& recv_in) : m_recv(std::move(recv_in)) {}
+    ~CNetMessage();
     // Only one CNetMessage object will exist for the same message on either
     // the receive or processing queue. For performance reasons we therefore
     // delete the copy constructor and assignment operator to avoid the
@@ -295,9 +323,18 @@ public:
      * If no message can currently be set (perhaps because the previous one is not yet done being
      * sent), returns false, and msg will be unmodified. Otherwise msg is enqueued (and
      * possibly moved-from) and true is returned.
+     *
+     * While earlier messages are still being sent, a transport may accept up to
+     * MAX_SEND_BATCH_MESSAGES messages, as long as the bytes still to be sent do not exceed
+     * MAX_SEND_BATCH_BYTES, so that they can be sent together (see GetBytesToSendBatch).
      */
     virtual bool SetMessageToSend(CSerializedNetMsg& msg) noexcept = 0;
 
+    /** Maximum number of messages a transport holds for sending at once. */
+    static constexpr size_t MAX_SEND_BATCH_MESSAGES{16};
+    /** Number of unsent bytes above which a transport accepts no further message. */
+    static constexpr size_t MAX_SEND_BATCH_BYTES{256 * 1024};
+
     /** Return type for GetBytesToSend, consisting of:
      *  - std::span<const uint8_t> to_send: span of bytes to be sent over the wire (possibly empty).
      *  - bool more: whether there will be more bytes to be sent after the ones in to_send are
@@ -348,9 +385,30 @@ public:
      */
     virtual BytesToSend GetBytesToSend(bool have_next_message) const noexcept = 0;
 
-    /** Report how many bytes returned by the last GetBytesToSend() have been sent.
+    /** A span of bytes to send, and the message type it is sent on behalf of (see BytesToSend). */
+    struct SendChunk {
+        std::span<const uint8_t> data;
+        const std::string* m_type;
+    };
+
+    /** Get all bytes to send on the wire, as a sequence of chunks that can be handed to a single
+     *  vectored send call. The first chunk is what GetBytesToSend() returns, the others are what
+     *  it would return after each chunk is sent. Chunks point into the messages and buffers of
+     *  the transport, so no bytes are copied.
      *
-     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result.
+     * @param[in]  have_next_message  As for GetBytesToSend().
+     * @param[out] chunks             Cleared, and filled with at most max_chunks non-empty chunks.
+     * @param[in]  max_chunks         Maximum number of chunks to return.
+     * @return whether there will be more bytes to send after all the returned chunks are sent
+     *         (the "more" value of GetBytesToSend() for the last chunk).
+     */
+    virtual bool GetBytesToSendBatch(bool have_next_message, std::vector<SendChunk>& chunks, size_t max_chunks) const noexcept = 0;
+
+    /** Report how many bytes returned by the last GetBytesToSend() or GetBytesToSendBatch() have
+     * been sent.
+     *
+     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result, or the total
+     * size of the chunks of the last GetBytesToSendBatch() result.
      *
      * If bytes_sent=0, this call has no effect.
      */
@@ -370,6 +428,8 @@ class V1Transport final : public Transport
 private:
     const MessageStartChars m_magic_bytes;
     const NodeId m_node_id; // Only for logging
+    //! Pool to take the buffers to receive message payloads into from, if any.
+    const std::shared_ptr<node::RecvBufferPool> m_recv_pool;
     mutable Mutex m_recv_mutex; //!< Lock for receive state
     mutable CHash256 hasher GUARDED_BY(m_recv_mutex);
     mutable uint256 data_hash GUARDED_BY(m_recv_mutex);
@@ -413,9 +473,16 @@ private:
     bool m_sending_header GUARDED_BY(m_send_mutex) {false};
     /** How many bytes have been sent so far (from m_header_to_send, or from m_message_to_send.data). */
     size_t m_bytes_sent GUARDED_BY(m_send_mutex) {0};
+    /** Messages to send after m_message_to_send, with their serialized headers. */
+    std::deque<std::pair<std::vector<uint8_t>, CSerializedNetMsg>> m_send_queue GUARDED_BY(m_send_mutex);
+    /** Total payload and header size of m_send_queue. */
+    size_t m_send_queue_bytes GUARDED_BY(m_send_mutex) {0};
+
+    /** Serialize the header of msg. */
+    std::vector<uint8_t> MakeHeader(const CSerializedNetMsg& msg) const noexcept;
 
 public:
-    explicit V1Transport(const NodeId node_id) noexcept;
+    explicit V1Transport(const NodeId node_id, std::shared_ptr<node::RecvBufferPool> recv_pool = nullptr) noexcept;
 
     bool ReceivedMessageComplete() const override EXCLUSIVE_LOCKS_REQUIRED(!m_recv_mutex)
     {
@@ -442,6 +509,7 @@ public:
 
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    bool GetBytesToSendBatch(bool have_next_message, std::vector<SendChunk>& chunks, size_t max_chunks) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     bool ShouldReconnectV1() const noexcept override { return false; }
@@ -514,7 +582,7 @@ private:
         /** Application packet.
          *
          * A packet is received, and decrypted/verified. If that succeeds, the state becomes
-         * APP_READY and the decrypted contents is kept in m_recv_decode_buffer until it is
+         * APP_READY and the decrypted contents is kept in m_recv_packet until it is
          * retrieved as a message by GetMessage(). */
         APP,
 
@@ -591,8 +659,12 @@ private:
     std::vector<uint8_t> m_recv_buffer GUARDED_BY(m_recv_mutex);
     /** AAD expected in next received packet (currently used only for garbage). */
     std::vector<uint8_t> m_recv_aad GUARDED_BY(m_recv_mutex);
-    /** Buffer to put decrypted contents in, for converting to CNetMessage. */
-    std::vector<uint8_t> m_recv_decode_buffer GUARDED_BY(m_recv_mutex);
+    /** In {VERSION, APP}, once m_recv_len is known, the ciphertext of the packet received so far
+     *  (without the length descriptor, which stays in m_recv_buffer). In APP_READY, the packet
+     *  decrypted in place, which is handed over to the CNetMessage without copying. */
+    SerializeData m_recv_packet GUARDED_BY(m_recv_mutex);
+    /** Pool to take the buffers to receive packets into from, if any. */
+    const std::shared_ptr<node::RecvBufferPool> m_recv_pool;
     /** Current receiver state. */
     RecvState m_recv_state GUARDED_BY(m_recv_mutex);
 
@@ -605,8 +677,9 @@ private:
     uint32_t m_send_pos GUARDED_BY(m_send_mutex) {0};
     /** The garbage sent, or to be sent (MAYBE_V1 and AWAITING_KEY state only). */
     std::vector<uint8_t> m_send_garbage GUARDED_BY(m_send_mutex);
-    /** Type of the message being sent. */
-    std::string m_send_type GUARDED_BY(m_send_mutex);
+    /** In READY state, the end offset in m_send_buffer and the message type of every packet in
+     *  it that is not fully sent yet. Empty if m_send_buffer holds handshake bytes. */
+    std::deque<std::pair<size_t, std::string>> m_send_packets GUARDED_BY(m_send_mutex);
     /** Current sender state. */
     SendState m_send_state GUARDED_BY(m_send_mutex);
     /** Whether we've sent at least 24 bytes (which would trigger disconnect for V1 peers). */
@@ -628,8 +701,10 @@ private:
     bool ProcessReceivedKeyBytes() noexcept EXCLUSIVE_LOCKS_REQUIRED(m_recv_mutex, !m_send_mutex);
     /** Process bytes in m_recv_buffer, while in GARB_GARBTERM state. */
     bool ProcessReceivedGarbageBytes() noexcept EXCLUSIVE_LOCKS_REQUIRED(m_recv_mutex);
-    /** Process bytes in m_recv_buffer, while in VERSION/APP state. */
+    /** Process bytes in m_recv_buffer and m_recv_packet, while in VERSION/APP state. */
     bool ProcessReceivedPacketBytes() noexcept EXCLUSIVE_LOCKS_REQUIRED(m_recv_mutex);
+    /** Wipe m_recv_packet, returning its storage to the pool. */
+    void ReleaseReceivedPacket() noexcept EXCLUSIVE_LOCKS_REQUIRED(m_recv_mutex);
 
 public:
     static constexpr uint32_t MAX_GARBAGE_LEN = 4095;
@@ -638,11 +713,13 @@ public:
      *
      * @param[in] nodeid      the node's NodeId (only for debug log output).
      * @param[in] initiating  whether we are the initiator side.
+     * @param[in] recv_pool   pool to take receive buffers from, if any.
      */
-    V2Transport(NodeId nodeid, bool initiating) noexcept;
+    V2Transport(NodeId nodeid, bool initiating, std::shared_ptr<node::RecvBufferPool> recv_pool = nullptr) noexcept;
 
     /** Construct a V2 transport with specified keys and garbage (test use only). */
-    V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage) noexcept;
+    V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage,
+                std::shared_ptr<node::RecvBufferPool> recv_pool = nullptr) noexcept;
 
     // Receive side functions.
     bool ReceivedMessageComplete() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_recv_mutex);
@@ -652,6 +729,7 @@ public:
     // Send side functions.
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    bool GetBytesToSendBatch(bool have_next_message, std::vector<SendChunk>& chunks, size_t max_chunks) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
 
@@ -667,6 +745,7 @@ struct CNodeOptions
     bool prefer_evict = false;
     size_t recv_flood_size{DEFAULT_MAXRECEIVEBUFFER * 1000};
     bool use_v2transport = false;
+    std::shared_ptr<node::RecvBufferPool> recv_buffer_pool = nullptr;
 };
 
 /** Information about a peer */
@@ -1430,6 +1509,8 @@ private:
 
     unsigned int nSendBufferMaxSize{0};
     unsigned int nReceiveFloodSize{0};
+    //! Buffers that the payloads of received messages are read into, shared by all peers.
+    const std::shared_ptr<node::RecvBufferPool> m_recv_buffer_pool{std::make_shared<node::RecvBufferPool>(MAX_RECV_BUFFER_POOL_USAGE)};
 
     std::vector<ListenSocket> vhListenSocket;
     std::atomic<bool> fNetworkActive{true};
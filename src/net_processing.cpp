@@ -13,6 +13,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <common/bloom.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
@@ -30,6 +31,7 @@
 #include <netaddress.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
+#include <node/blockservecache.h>
 #include <node/blockstorage.h>
 #include <node/connection_types.h>
 #include <node/protocol_version.h>
@@ -37,6 +39,7 @@
 #include <node/txdownloadman.h>
 #include <node/txorphanage.h>
 #include <node/txreconciliation.h>
+#include <node/txrelayschedule.h>
 #include <node/warnings.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
@@ -71,6 +74,7 @@
 #include <functional>
 #include <future>
 #include <initializer_list>
+#include <ios>
 #include <iterator>
 #include <limits>
 #include <list>
@@ -96,6 +100,10 @@ static constexpr auto HEADERS_DOWNLOAD_TIMEOUT_BASE = 15min;
 static constexpr auto HEADERS_DOWNLOAD_TIMEOUT_PER_HEADER = 1ms;
 /** How long to wait for a peer to respond to a getheaders request */
 static constexpr auto HEADERS_RESPONSE_TIME{2min};
+/** Maximum number of threads checking the proof of work of received headers, besides the message handler thread. */
+static constexpr int MAX_HEADER_CHECK_THREADS{7};
+/** Number of headers a header check thread hashes at a time. */
+static constexpr unsigned int HEADER_CHECK_BATCH_SIZE{64};
 /** Protect at least this many outbound peers from disconnection due to slow/
  * behind headers chain.
  */
@@ -124,8 +132,20 @@ static const unsigned int MAX_LOCATOR_SZ = 101;
 static const unsigned int MAX_INV_SZ = 50000;
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
-/** Number of blocks that can be requested at any given time from a single peer. */
+/** Number of blocks that can be requested at any given time from a single peer, until its block
+ *  download rate has been measured. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Bounds on the number of blocks that can be requested at any given time from a single peer
+ *  during block download, based on its measured rate. */
+static constexpr int MIN_BLOCK_DOWNLOAD_DEPTH{2};
+static constexpr int MAX_BLOCK_DOWNLOAD_DEPTH{64};
+/** Time it should take a peer to deliver all blocks requested from it, at its measured rate. */
+static constexpr auto BLOCK_DOWNLOAD_QUEUE_TIME{4s};
+/** Number of requested blocks a peer has to deliver before its measured rate is used. */
+static constexpr uint64_t BLOCK_DOWNLOAD_MIN_SAMPLES{4};
+/** Minimum time the block holding back the download window must have been in flight before it
+ *  is also requested from another peer. */
+static constexpr auto BLOCK_REREQUEST_MIN_DELAY{1s};
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
@@ -134,6 +154,13 @@ static constexpr auto BLOCK_STALLING_TIMEOUT_MAX{64s};
 /** Maximum depth of blocks we're willing to serve as compact blocks to peers
  *  when requested. For older blocks, a regular BLOCK response will be sent. */
 static const int MAX_CMPCTBLOCK_DEPTH = 5;
+/** Maximum total size of the transactions, besides the coinbase, that we send in
+ *  full in a compact block announced to a high-bandwidth peer because it is
+ *  unlikely to have them. Keeps the announcement small enough to not delay it. */
+static constexpr size_t MAX_CMPCTBLOCK_PREFILL_BYTES{10'000};
+/** Transactions that entered our mempool more recently than this may not have
+ *  reached a peer yet, unless it announced them to us or we to it. */
+static constexpr auto CMPCTBLOCK_PREFILL_RECENT_TX_AGE{10s};
 /** Maximum depth of blocks we're willing to respond to GETBLOCKTXN requests for. */
 static const int MAX_BLOCKTXN_DEPTH = 10;
 static_assert(MAX_BLOCKTXN_DEPTH <= MIN_BLOCKS_TO_KEEP, "MAX_BLOCKTXN_DEPTH too high");
@@ -195,6 +222,8 @@ static constexpr double MAX_ADDR_RATE_PER_SECOND{0.1};
 static constexpr size_t MAX_ADDR_PROCESSING_TOKEN_BUCKET{MAX_ADDR_TO_SEND};
 /** The compactblocks version we support. See BIP 152. */
 static constexpr uint64_t CMPCTBLOCKS_VERSION{2};
+/** Maximum memory used by serialized blocks cached for serving them to peers. */
+static constexpr size_t MAX_BLOCK_SERVE_CACHE_SIZE{32 << 20};
 
 // Internal stuff
 namespace {
@@ -204,6 +233,62 @@ struct QueuedBlock {
     const CBlockIndex* pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested. */
+    std::chrono::microseconds m_requested_time;
+};
+
+/** Measured performance of a peer delivering the blocks we requested from it. */
+struct BlockDownloadStats {
+    /** Number of requested blocks received. */
+    uint64_t m_blocks{0};
+    /** Total size of the requested blocks received. */
+    uint64_t m_bytes{0};
+    /** Moving average of the time from requesting a block to receiving it. */
+    std::chrono::microseconds m_latency{0us};
+    /** Moving average of the time the peer takes to deliver a block once it is done with the
+     *  blocks requested before it. */
+    std::chrono::microseconds m_service_time{0us};
+    /** Moving average of the size of the requested blocks received. */
+    double m_avg_size{0};
+    /** When the last requested block was received. */
+    std::chrono::microseconds m_last_received{0us};
+    /** Number of blocks requested from this peer while already in flight from a stalling one. */
+    uint64_t m_rerequested{0};
+
+    void Add(std::chrono::microseconds requested_time, std::chrono::microseconds now, size_t size)
+    {
+        const auto latency{now - requested_time};
+        const auto service_time{now - std::max(requested_time, m_last_received)};
+        if (m_blocks == 0) {
+            m_latency = latency;
+            m_service_time = service_time;
+            m_avg_size = size;
+        } else {
+            // Exponential moving averages weighting the new sample with 1/8.
+            m_latency += (latency - m_latency) / 8;
+            m_service_time += (service_time - m_service_time) / 8;
+            m_avg_size += (size - m_avg_size) / 8;
+        }
+        ++m_blocks;
+        m_bytes += size;
+        m_last_received = now;
+    }
+
+    /** Download rate in bytes per second, or 0 if not known. */
+    double GetRate() const
+    {
+        if (m_service_time <= 0us) return 0;
+        return m_avg_size / Ticks<SecondsDouble>(m_service_time);
+    }
+
+    /** Number of blocks to keep in flight from the peer, so that it can deliver them in about
+     *  BLOCK_DOWNLOAD_QUEUE_TIME. */
+    int GetDepth() const
+    {
+        if (m_blocks < BLOCK_DOWNLOAD_MIN_SAMPLES) return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+        const auto depth{BLOCK_DOWNLOAD_QUEUE_TIME / std::max(m_service_time, 1us)};
+        return std::clamp<int64_t>(depth, MIN_BLOCK_DOWNLOAD_DEPTH, MAX_BLOCK_DOWNLOAD_DEPTH);
+    }
 };
 
 /**
@@ -299,9 +384,9 @@ struct Peer {
          *  the same (w)txid to a peer that already has the transaction. */
         CRollingBloomFilter m_tx_inventory_known_filter GUARDED_BY(m_tx_inventory_mutex){50000, 0.000001};
         /** Set of transaction ids we still have to announce (txid for
-         *  non-wtxid-relay peers, wtxid for wtxid-relay peers). We use the
-         *  mempool to sort transactions in dependency order before relay, so
-         *  this does not have to be sorted. */
+         *  non-wtxid-relay peers, wtxid for wtxid-relay peers). They are
+         *  announced in the order of the shared m_tx_relay_schedule, so this
+         *  does not have to be sorted. */
         std::set<GenTxid> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
         /** Whether the peer has requested us to send our complete mempool. Only
          *  permitted if the peer has NetPermissionFlags::Mempool or we advertise
@@ -449,6 +534,8 @@ struct CNodeState {
     std::list<QueuedBlock> vBlocksInFlight;
     //! When the first entry in vBlocksInFlight started downloading. Don't care when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! How well this peer delivered the blocks we requested from it.
+    BlockDownloadStats m_block_download;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /** Whether this peer wants invs or cmpctblocks (when possible) for block announcements. */
@@ -516,7 +603,7 @@ public:
     void BlockChecked(const CBlock& block, const BlockValidationState& state) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !m_peer_mutex);
 
     /** Implement NetEventsInterface */
     void InitializeNode(const CNode& node, ServiceFlags our_services) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_download_mutex);
@@ -563,6 +650,16 @@ private:
      *  May return an empty shared_ptr if the Peer object can't be found. */
     PeerRef GetPeerRef(NodeId id) const EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
 
+    /**
+     * Pick the transactions of a block to prefill in a compact block announced
+     * to a peer: the ones it is unlikely to have, up to MAX_CMPCTBLOCK_PREFILL_BYTES.
+     *
+     * @param[in] maybe_missing  Positions of the transactions any peer may lack,
+     *                           as we did not have them or only got them recently
+     * @return Sorted positions of the transactions to prefill
+     */
+    std::vector<size_t> GetCompactBlockPrefill(Peer& peer, const CBlock& block, std::span<const size_t> maybe_missing);
+
     /** Get a shared pointer to the Peer object and remove it from m_peer_map.
      *  May return an empty shared_ptr if the Peer object can't be found. */
     PeerRef RemovePeer(NodeId id) EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
@@ -649,16 +746,18 @@ private:
                                bool via_compact_block)
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     /** Various helpers for headers processing, invoked by ProcessHeadersMessage() */
-    /** Return true if headers are continuous and have valid proof-of-work (DoS points assigned on failure) */
-    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer);
+    /** Return true if headers are continuous and have valid proof-of-work (DoS points assigned on failure).
+     *  The hashes of the headers are returned in hashes, for the later processing steps to reuse. */
+    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes, const Consensus::Params& consensusParams, Peer& peer)
+        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
     /** Calculate an anti-DoS work threshold for headers chains */
     arith_uint256 GetAntiDoSWorkThreshold();
     /** Deal with state tracking and headers sync for peers that send
      * non-connecting headers (this can happen due to BIP 130 headers
      * announcements for blocks interacting with the 2hr (MAX_FUTURE_BLOCK_TIME) rule). */
     void HandleUnconnectingHeaders(CNode& pfrom, Peer& peer, const std::vector<CBlockHeader>& headers) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
-    /** Return true if the headers connect to each other, false otherwise */
-    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const;
+    /** Return true if the headers with the given hashes connect to each other, false otherwise */
+    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes) const;
     /** Try to continue a low-work headers sync that has already begun.
      * Assumes the caller has already verified the headers connect, and has
      * checked that each header satisfies the proof-of-work target included in
@@ -666,6 +765,7 @@ private:
      *  @param[in]  peer                            The peer we're syncing with.
      *  @param[in]  pfrom                           CNode of the peer
      *  @param[in,out] headers                      The headers to be processed.
+     *  @param[in,out] hashes                       The hashes of headers, replaced along with them.
      *  @return     True if the passed in headers were successfully processed
      *              as the continuation of a low-work headers sync in progress;
      *              false otherwise.
@@ -678,7 +778,7 @@ private:
      *              acceptance by the caller).
      */
     bool IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom,
-            std::vector<CBlockHeader>& headers)
+            std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
         EXCLUSIVE_LOCKS_REQUIRED(peer.m_headers_sync_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     /** Check work on a headers chain to be processed, and if insufficient,
      * initiate our anti-DoS headers sync mechanism.
@@ -687,13 +787,14 @@ private:
      * @param[in]   pfrom               CNode of the peer
      * @param[in]   chain_start_header  Where these headers connect in our index.
      * @param[in,out]   headers             The headers to be processed.
+     * @param[in,out]   hashes              The hashes of headers, cleared along with them.
      *
      * @return      True if chain was low work (headers will be empty after
      *              calling); false otherwise.
      */
     bool TryLowWorkHeadersSync(Peer& peer, CNode& pfrom,
                                   const CBlockIndex* chain_start_header,
-                                  std::vector<CBlockHeader>& headers)
+                                  std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
         EXCLUSIVE_LOCKS_REQUIRED(!peer.m_headers_sync_mutex, !m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
 
     /** Return true if the given header is an ancestor of
@@ -773,6 +874,11 @@ private:
 
     std::unique_ptr<TxReconciliationTracker> m_txreconciliation;
 
+    /** Order in which the transactions in the peers' m_tx_inventory_to_send are
+     *  announced. Every entry of those sets is added to it, and removed from it
+     *  when it leaves the set. */
+    node::TxRelaySchedule m_tx_relay_schedule;
+
     /** The height of the best chain */
     std::atomic<int> m_best_height{-1};
     /** The time of the best chain tip block */
@@ -858,6 +964,14 @@ private:
     uint256 m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
     std::unique_ptr<const std::map<GenTxid, CTransactionRef>> m_most_recent_block_txs GUARDED_BY(m_most_recent_block_mutex);
 
+    /** Serialized blocks recently served to peers, shared by their send queues. */
+    node::BlockServeCache m_block_serve_cache{MAX_BLOCK_SERVE_CACHE_SIZE};
+
+    /** Threads checking the proof of work of received headers, created on the
+     *  first headers message. Stays null on single core machines. */
+    std::unique_ptr<CCheckQueue<HeaderPoWCheck>> m_header_check_queue GUARDED_BY(g_msgproc_mutex);
+    bool m_header_check_queue_init GUARDED_BY(g_msgproc_mutex){false};
+
     // Data about the low-work headers synchronization, aggregated from all peers' HeadersSyncStates.
     /** Mutex guarding the other m_headers_presync_* variables. */
     Mutex m_headers_presync_mutex;
@@ -905,7 +1019,14 @@ private:
     /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
      *  at most count entries.
      */
-    void FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex*& stalling_block) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Whether to request a block that is holding back the download window from a peer, in
+     *  addition to the peer it is in flight from. */
+    bool ShouldRerequestBlock(const CNodeState& state, const CBlockIndex& block, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Update the download statistics of a peer that delivered a block we requested from it. */
+    void RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Request blocks for the background chainstate, if one is in use. */
     void TryDownloadingHistoricalBlocks(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, const CBlockIndex* from_tip, const CBlockIndex* target_block) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -936,8 +1057,10 @@ private:
     *                     indicates the download might be stalled because every
     *                     block in the window is in flight and no other peer is
     *                     trying to download the next block).
+    * \param stalling_block Optional pointer that will receive the block in flight
+    *                     from nodeStaller, set whenever nodeStaller is.
     */
-    void FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain=nullptr, NodeId* nodeStaller=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain=nullptr, NodeId* nodeStaller=nullptr, const CBlockIndex** stalling_block=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /* Multimap used to preserve insertion order */
     typedef std::multimap<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator>> BlockDownloadMap;
@@ -946,6 +1069,10 @@ private:
     /** When our tip was last updated. */
     std::atomic<std::chrono::seconds> m_last_tip_update{0s};
 
+    /** Announce transactions learnt to be missing by the peer through reconciliation, if they are still in our mempool. */
+    void AnnounceReconciledTxs(CNode& node, Peer::TxRelay& tx_relay, std::span<const Wtxid> wtxids)
+        EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex);
+
     /** Determine whether or not a peer can request a transaction, and return it (or nullptr if not found or not allowed). */
     CTransactionRef FindTxForGetData(const Peer::TxRelay& tx_relay, const CInv& inv)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
@@ -1006,6 +1133,8 @@ private:
     bool AlreadyHaveBlock(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     void ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
         EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex);
+    /** Read a block to serve it to a peer, decoding it from m_block_serve_cache if it is cached with witness data. */
+    bool ReadServedBlock(CBlock& block, const uint256& block_hash, const FlatFilePos& block_pos);
 
     /**
      * Validation logic for compact filters request handling.
@@ -1236,7 +1365,7 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
     RemoveBlockRequest(hash, nodeid);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr)});
+            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr), GetTime<std::chrono::microseconds>()});
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
         state->m_downloading_since = GetTime<std::chrono::microseconds>();
@@ -1371,7 +1500,7 @@ void PeerManagerImpl::UpdateBlockAvailability(NodeId nodeid, const uint256 &hash
 }
 
 // Logic for calculating which blocks to download from a given peer, given our current tip.
-void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller)
+void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex*& stalling_block)
 {
     if (count == 0)
         return;
@@ -1417,7 +1546,29 @@ void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int co
     // download that next block if the window were 1 larger.
     int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
 
-    FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller);
+    FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller, &stalling_block);
+}
+
+bool PeerManagerImpl::ShouldRerequestBlock(const CNodeState& state, const CBlockIndex& block, std::chrono::microseconds now)
+{
+    // Only request the block from one more peer, and only from one that delivered blocks before.
+    const auto range{mapBlocksInFlight.equal_range(block.GetBlockHash())};
+    if (range.first == range.second || std::next(range.first) != range.second) return false;
+    if (state.m_block_download.m_blocks == 0) return false;
+    // Re-request the block once it has been pending for longer than this peer usually takes to
+    // deliver a block, i.e. when this peer is likely to deliver it sooner.
+    const auto pending{now - range.first->second.second->m_requested_time};
+    return pending > std::max<std::chrono::microseconds>(BLOCK_REREQUEST_MIN_DELAY, state.m_block_download.m_latency);
+}
+
+void PeerManagerImpl::RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t size)
+{
+    for (auto range{mapBlocksInFlight.equal_range(hash)}; range.first != range.second; ++range.first) {
+        const auto& [node_id, queued_it]{range.first->second};
+        if (node_id != nodeid) continue;
+        Assert(State(nodeid))->m_block_download.Add(queued_it->m_requested_time, GetTime<std::chrono::microseconds>(), size);
+        return;
+    }
 }
 
 void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, const CBlockIndex *from_tip, const CBlockIndex* target_block)
@@ -1449,12 +1600,13 @@ void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned
     FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + BLOCK_DOWNLOAD_WINDOW, target_block->nHeight));
 }
 
-void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller)
+void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller, const CBlockIndex** stalling_block)
 {
     std::vector<const CBlockIndex*> vToFetch;
     int nMaxHeight = std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     bool is_limited_peer = IsLimitedPeer(peer);
     NodeId waitingfor = -1;
+    const CBlockIndex* waitingfor_block{nullptr};
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed) successors of pindexWalk (towards
         // pindexBestKnownBlock) into vToFetch. We fetch 128, because CBlockIndex::GetAncestor may be as expensive
@@ -1494,6 +1646,7 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, c
                 if (waitingfor == -1) {
                     // This is the first already-in-flight block.
                     waitingfor = mapBlocksInFlight.lower_bound(pindex->GetBlockHash())->second.first;
+                    waitingfor_block = pindex;
                 }
                 continue;
             }
@@ -1504,6 +1657,7 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, c
                 if (vBlocks.size() == 0 && waitingfor != peer.m_id) {
                     // We aren't able to fetch anything, but we would be if the download window was one larger.
                     if (nodeStaller) *nodeStaller = waitingfor;
+                    if (stalling_block) *stalling_block = waitingfor_block;
                 }
                 return;
             }
@@ -1610,6 +1764,12 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         assert(peer != nullptr);
         m_wtxid_relay_peers -= peer->m_wtxid_relay;
         assert(m_wtxid_relay_peers >= 0);
+        if (auto tx_relay = peer->GetTxRelay()) {
+            LOCK(tx_relay->m_tx_inventory_mutex);
+            auto& to_send{tx_relay->m_tx_inventory_to_send};
+            m_tx_relay_schedule.Remove(std::vector<GenTxid>{to_send.begin(), to_send.end()});
+            to_send.clear();
+        }
     }
     CNodeState *state = State(nodeid);
     assert(state != nullptr);
@@ -1714,6 +1874,12 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
             if (queue.pindex)
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
         }
+        stats.m_blocks_downloaded = state->m_block_download.m_blocks;
+        stats.m_block_bytes_downloaded = state->m_block_download.m_bytes;
+        stats.m_block_download_latency = state->m_block_download.m_latency;
+        stats.m_block_download_rate = state->m_block_download.GetRate();
+        stats.m_block_download_depth = state->m_block_download.GetDepth();
+        stats.m_blocks_rerequested = state->m_block_download.m_rerequested;
     }
 
     PeerRef peer = GetPeerRef(nodeid);
@@ -1765,6 +1931,7 @@ PeerManagerInfo PeerManagerImpl::GetInfo() const
     return PeerManagerInfo{
         .median_outbound_time_offset = m_outbound_time_offsets.Median(),
         .ignores_incoming_txs = m_opts.ignore_incoming_txs,
+        .block_serve_cache = m_block_serve_cache.GetStats(),
     };
 }
 
@@ -1926,11 +2093,12 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
       m_chainman(chainman),
       m_mempool(pool),
       m_txdownloadman(node::TxDownloadOptions{pool, m_rng, opts.deterministic_rng}),
+      m_tx_relay_schedule{pool},
       m_warnings{warnings},
       m_opts{opts}
 {
-    // While Erlay support is incomplete, it must be enabled explicitly via -txreconciliation.
-    // This argument can go away after Erlay support is complete.
+    // Erlay must be enabled explicitly via -txreconciliation until it has seen wider deployment.
+    // It does not implement sketch extensions yet: failed reconciliations fall back to flooding.
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
@@ -2022,6 +2190,19 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
 
     if (!DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT)) return;
 
+    // Transactions that we did not have either, or that we only received
+    // recently, may not have reached our peers yet. The block is not connected
+    // yet, so its transactions are still in the mempool if we had them.
+    std::vector<size_t> maybe_missing;
+    {
+        const auto recent{GetTime<std::chrono::seconds>() - CMPCTBLOCK_PREFILL_RECENT_TX_AGE};
+        LOCK(m_mempool.cs);
+        for (size_t i = 1; i < pblock->vtx.size(); ++i) {
+            const CTxMemPoolEntry* entry{m_mempool.GetEntry(pblock->vtx[i]->GetHash())};
+            if (!entry || entry->GetTime() > recent) maybe_missing.push_back(i);
+        }
+    }
+
     uint256 hashBlock(pblock->GetHash());
     const std::shared_future<CSerializedNetMsg> lazy_ser{
         std::async(std::launch::deferred, [&] { return NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
@@ -2040,7 +2221,7 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block_txs = std::move(most_recent_block_txs);
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    m_connman.ForEachNode([this, pindex, &pblock, &maybe_missing, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -2054,13 +2235,59 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
-            PushMessage(*pnode, ser_cmpctblock.Copy());
+            const PeerRef peer{GetPeerRef(pnode->GetId())};
+            const auto prefill{peer ? GetCompactBlockPrefill(*peer, *pblock, maybe_missing) : std::vector<size_t>{}};
+            if (prefill.empty()) {
+                const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
+                PushMessage(*pnode, ser_cmpctblock.Copy());
+            } else {
+                LogDebug(BCLog::CMPCTBLOCK, "Prefilling %u transactions of block %s for peer=%d\n", prefill.size(), hashBlock.ToString(), pnode->GetId());
+                CBlockHeaderAndShortTxIDs cmpctblock{*pblock, FastRandomContext().rand64(), prefill};
+                MakeAndPushMessage(*pnode, NetMsgType::CMPCTBLOCK, cmpctblock);
+            }
             state.pindexBestHeaderSent = pindex;
         }
     });
 }
 
+std::vector<size_t> PeerManagerImpl::GetCompactBlockPrefill(Peer& peer, const CBlock& block, std::span<const size_t> maybe_missing)
+{
+    auto tx_relay{peer.GetTxRelay()};
+    const auto peer_gtxid{[&](const CTransaction& tx) {
+        return peer.m_wtxid_relay ? GenTxid{tx.GetWitnessHash()} : GenTxid{tx.GetHash()};
+    }};
+
+    std::vector<size_t> candidates;
+    if (tx_relay) {
+        LOCK(tx_relay->m_tx_inventory_mutex);
+        auto next_missing{maybe_missing.begin()};
+        for (size_t i = 1; i < block.vtx.size(); ++i) {
+            const bool is_maybe_missing{next_missing != maybe_missing.end() && *next_missing == i};
+            if (is_maybe_missing) ++next_missing;
+            const GenTxid gtxid{peer_gtxid(*block.vtx[i])};
+            // The peer announced the transaction to us, or we to it.
+            if (tx_relay->m_tx_inventory_known_filter.contains(gtxid.ToUint256())) continue;
+            // Transactions still queued for announcement to the peer have not
+            // been announced to it by us yet.
+            if (is_maybe_missing || tx_relay->m_tx_inventory_to_send.contains(gtxid)) candidates.push_back(i);
+        }
+    } else {
+        // Without transaction relay (e.g. on block-relay-only connections) we
+        // know nothing about the peer's mempool.
+        candidates.assign(maybe_missing.begin(), maybe_missing.end());
+    }
+
+    std::vector<size_t> prefill;
+    size_t prefill_bytes{0};
+    for (size_t i : candidates) {
+        const size_t tx_size{block.vtx[i]->GetTotalSize()};
+        if (prefill_bytes + tx_size > MAX_CMPCTBLOCK_PREFILL_BYTES) continue;
+        prefill_bytes += tx_size;
+        prefill.push_back(i);
+    }
+    return prefill;
+}
+
 /**
  * Update our best height and announce any block hashes which weren't previously
  * in m_chainman.ActiveChain() to our peers.
@@ -2167,8 +2394,9 @@ void PeerManagerImpl::RelayTransaction(const Txid& txid, const Wtxid& wtxid)
         if (tx_relay->m_next_inv_send_time == 0s) continue;
 
         const auto gtxid{peer.m_wtxid_relay ? GenTxid{wtxid} : GenTxid{txid}};
-        if (!tx_relay->m_tx_inventory_known_filter.contains(gtxid.ToUint256())) {
-            tx_relay->m_tx_inventory_to_send.insert(gtxid);
+        if (!tx_relay->m_tx_inventory_known_filter.contains(gtxid.ToUint256()) &&
+            tx_relay->m_tx_inventory_to_send.insert(gtxid).second) {
+            m_tx_relay_schedule.Add(gtxid);
         }
     }
 }
@@ -2222,6 +2450,19 @@ void PeerManagerImpl::RelayAddress(NodeId originator,
     }
 }
 
+bool PeerManagerImpl::ReadServedBlock(CBlock& block, const uint256& block_hash, const FlatFilePos& block_pos)
+{
+    if (const auto payload{m_block_serve_cache.Get(block_hash, /*witness=*/true)}) {
+        try {
+            SpanReader{payload->data} >> TX_WITH_WITNESS(block);
+            if (block.GetHash() == block_hash) return true;
+        } catch (const std::ios_base::failure&) {
+            // Fall back to reading the block from disk.
+        }
+    }
+    return m_chainman.m_blockman.ReadBlock(block, block_pos, block_hash);
+}
+
 void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
 {
     std::shared_ptr<const CBlock> a_recent_block;
@@ -2297,44 +2538,67 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         block_pos = pindex->GetBlockPos();
     }
 
+    const auto read_failed{[&] {
+        if (WITH_LOCK(m_chainman.GetMutex(), return m_chainman.m_blockman.IsBlockPruned(*pindex))) {
+            LogDebug(BCLog::NET, "Block was pruned before it could be read, %s\n", pfrom.DisconnectMsg(fLogIPs));
+        } else {
+            LogError("Cannot load block from disk, %s\n", pfrom.DisconnectMsg(fLogIPs));
+        }
+        pfrom.fDisconnect = true;
+    }};
+
     std::shared_ptr<const CBlock> pblock;
-    if (a_recent_block && a_recent_block->GetHash() == inv.hash) {
-        pblock = a_recent_block;
-    } else if (inv.IsMsgWitnessBlk()) {
-        // Fast-path: in this case it is possible to serve the block directly from disk,
-        // as the network format matches the format on disk
-        std::vector<std::byte> block_data;
-        if (!m_chainman.m_blockman.ReadRawBlock(block_data, block_pos)) {
-            if (WITH_LOCK(m_chainman.GetMutex(), return m_chainman.m_blockman.IsBlockPruned(*pindex))) {
-                LogDebug(BCLog::NET, "Block was pruned before it could be read, %s\n", pfrom.DisconnectMsg(fLogIPs));
+    if (inv.IsMsgBlk() || inv.IsMsgWitnessBlk()) {
+        // Full blocks are served from a cache shared by all peers, so a block
+        // requested by many of them is read and serialized only once, and
+        // their send queues all refer to the same buffer.
+        const bool witness{inv.IsMsgWitnessBlk()};
+        auto payload{m_block_serve_cache.Get(inv.hash, witness)};
+        if (!payload) {
+            std::vector<unsigned char> block_data;
+            if (a_recent_block && a_recent_block->GetHash() == inv.hash) {
+                if (witness) {
+                    VectorWriter{block_data, 0, TX_WITH_WITNESS(*a_recent_block)};
+                } else {
+                    VectorWriter{block_data, 0, TX_NO_WITNESS(*a_recent_block)};
+                }
+            } else if (witness) {
+                // Fast-path: in this case it is possible to serve the block directly from disk,
+                // as the network format matches the format on disk
+                std::vector<std::byte> raw_block;
+                if (!m_chainman.m_blockman.ReadRawBlock(raw_block, block_pos)) {
+                    read_failed();
+                    return;
+                }
+                block_data.assign(UCharCast(raw_block.data()), UCharCast(raw_block.data() + raw_block.size()));
             } else {
-                LogError("Cannot load block from disk, %s\n", pfrom.DisconnectMsg(fLogIPs));
+                CBlock block;
+                if (!ReadServedBlock(block, inv.hash, block_pos)) {
+                    read_failed();
+                    return;
+                }
+                VectorWriter{block_data, 0, TX_NO_WITNESS(block)};
             }
-            pfrom.fDisconnect = true;
-            return;
+            payload = m_block_serve_cache.Add(inv.hash, witness, std::move(block_data));
         }
-        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, std::span{block_data});
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        msg.m_shared_payload = std::move(payload);
+        m_connman.PushMessage(&pfrom, std::move(msg));
         // Don't set pblock as we've sent the block
+    } else if (a_recent_block && a_recent_block->GetHash() == inv.hash) {
+        pblock = a_recent_block;
     } else {
         // Send block from disk
         std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
-        if (!m_chainman.m_blockman.ReadBlock(*pblockRead, block_pos, inv.hash)) {
-            if (WITH_LOCK(m_chainman.GetMutex(), return m_chainman.m_blockman.IsBlockPruned(*pindex))) {
-                LogDebug(BCLog::NET, "Block was pruned before it could be read, %s\n", pfrom.DisconnectMsg(fLogIPs));
-            } else {
-                LogError("Cannot load block from disk, %s\n", pfrom.DisconnectMsg(fLogIPs));
-            }
-            pfrom.fDisconnect = true;
+        if (!ReadServedBlock(*pblockRead, inv.hash, block_pos)) {
+            read_failed();
             return;
         }
         pblock = pblockRead;
     }
     if (pblock) {
-        if (inv.IsMsgBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_NO_WITNESS(*pblock));
-        } else if (inv.IsMsgWitnessBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_WITH_WITNESS(*pblock));
-        } else if (inv.IsMsgFilteredBlk()) {
+        if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
             if (auto tx_relay = peer.GetTxRelay(); tx_relay != nullptr) {
@@ -2391,6 +2655,25 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     }
 }
 
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, Peer::TxRelay& tx_relay, std::span<const Wtxid> wtxids)
+{
+    std::vector<CInv> vInv;
+    LOCK(tx_relay.m_tx_inventory_mutex);
+    for (const Wtxid& wtxid : wtxids) {
+        if (!m_mempool.exists(wtxid)) continue;
+        tx_relay.m_tx_inventory_known_filter.insert(wtxid.ToUint256());
+        vInv.emplace_back(MSG_WTX, wtxid.ToUint256());
+        if (vInv.size() == MAX_INV_SZ) {
+            MakeAndPushMessage(node, NetMsgType::INV, vInv);
+            vInv.clear();
+        }
+    }
+    if (!vInv.empty()) MakeAndPushMessage(node, NetMsgType::INV, vInv);
+    // Ensure we'll respond to GETDATA requests for anything we've just announced
+    LOCK(m_mempool.cs);
+    tx_relay.m_last_inv_sequence = m_mempool.GetSequence();
+}
+
 CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay, const CInv& inv)
 {
     auto gtxid{ToGenTxid(inv)};
@@ -2513,16 +2796,25 @@ void PeerManagerImpl::SendBlockTransactions(CNode& pfrom, Peer& peer, const CBlo
     MakeAndPushMessage(pfrom, NetMsgType::BLOCKTXN, resp);
 }
 
-bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer)
+bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes, const Consensus::Params& consensusParams, Peer& peer)
 {
+    if (!m_header_check_queue_init) {
+        m_header_check_queue_init = true;
+        const int worker_threads_num{std::clamp<int>(GetNumCores() - 1, 0, MAX_HEADER_CHECK_THREADS)};
+        if (worker_threads_num > 0) {
+            m_header_check_queue = std::make_unique<CCheckQueue<HeaderPoWCheck>>(HEADER_CHECK_BATCH_SIZE, worker_threads_num,
+                                                                                 "Header proof of work checks", "hdrchk");
+        }
+    }
+
     // Do these headers have proof-of-work matching what's claimed?
-    if (!HasValidProofOfWork(headers, consensusParams)) {
+    if (!CheckHeadersProofOfWork(headers, hashes, consensusParams, m_header_check_queue.get())) {
         Misbehaving(peer, "header with invalid proof of work");
         return false;
     }
 
     // Are these headers connected to each other?
-    if (!CheckHeadersAreContinuous(headers)) {
+    if (!CheckHeadersAreContinuous(headers, hashes)) {
         Misbehaving(peer, "non-continuous headers sequence");
         return false;
     }
@@ -2567,22 +2859,20 @@ void PeerManagerImpl::HandleUnconnectingHeaders(CNode& pfrom, Peer& peer,
     WITH_LOCK(cs_main, UpdateBlockAvailability(pfrom.GetId(), headers.back().GetHash()));
 }
 
-bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const
+bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes) const
 {
-    uint256 hashLastBlock;
-    for (const CBlockHeader& header : headers) {
-        if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+    for (size_t i{1}; i < headers.size(); ++i) {
+        if (headers[i].hashPrevBlock != hashes[i - 1]) {
             return false;
         }
-        hashLastBlock = header.GetHash();
     }
     return true;
 }
 
-bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom, std::vector<CBlockHeader>& headers)
+bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom, std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
 {
     if (peer.m_headers_sync) {
-        auto result = peer.m_headers_sync->ProcessNextHeaders(headers, headers.size() == m_opts.max_headers_result);
+        auto result = peer.m_headers_sync->ProcessNextHeaders(headers, headers.size() == m_opts.max_headers_result, hashes);
         // If it is a valid continuation, we should treat the existing getheaders request as responded to.
         if (result.success) peer.m_last_getheaders_timestamp = {};
         if (result.request_more) {
@@ -2651,6 +2941,7 @@ bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfro
             // We only overwrite the headers passed in if processing was
             // successful.
             headers.swap(result.pow_validated_headers);
+            hashes.swap(result.pow_validated_hashes);
         }
 
         return result.success;
@@ -2661,7 +2952,7 @@ bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfro
     return false;
 }
 
-bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlockIndex* chain_start_header, std::vector<CBlockHeader>& headers)
+bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlockIndex* chain_start_header, std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
 {
     // Calculate the claimed total work on this chain.
     arith_uint256 total_work = chain_start_header->nChainWork + CalculateClaimedHeadersWork(headers);
@@ -2693,7 +2984,7 @@ bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlo
             // Now a HeadersSyncState object for tracking this synchronization
             // is created, process the headers using it as normal. Failures are
             // handled inside of IsContinuationOfLowWorkHeadersSync.
-            (void)IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers);
+            (void)IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers, hashes);
         } else {
             LogDebug(BCLog::NET, "Ignoring low-work chain (height=%u) from peer=%d\n", chain_start_header->nHeight + headers.size(), pfrom.GetId());
         }
@@ -2701,6 +2992,7 @@ bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlo
         // The peer has not yet given us a chain that meets our work threshold,
         // so we want to prevent further processing of the headers in any case.
         headers = {};
+        hashes = {};
         return true;
     }
 
@@ -2880,8 +3172,10 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     // Before we do any processing, make sure these pass basic sanity checks.
     // We'll rely on headers having valid proof-of-work further down, as an
     // anti-DoS criteria (note: this check is required before passing any
-    // headers into HeadersSyncState).
-    if (!CheckHeadersPoW(headers, m_chainparams.GetConsensus(), peer)) {
+    // headers into HeadersSyncState). The headers are hashed once here, in
+    // parallel, and their hashes are reused by all the steps below.
+    std::vector<uint256> hashes;
+    if (!CheckHeadersPoW(headers, hashes, m_chainparams.GetConsensus(), peer)) {
         // Misbehaving() calls are handled within CheckHeadersPoW(), so we can
         // just return. (Note that even if a header is announced via compact
         // block, the header itself should be valid, so this type of error can
@@ -2903,7 +3197,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     {
         LOCK(peer.m_headers_sync_mutex);
 
-        already_validated_work = IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers);
+        already_validated_work = IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers, hashes);
 
         // The headers we passed in may have been:
         // - untouched, perhaps if no headers-sync was in progress, or some
@@ -2946,7 +3240,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     const CBlockIndex *last_received_header{nullptr};
     {
         LOCK(cs_main);
-        last_received_header = m_chainman.m_blockman.LookupBlockIndex(headers.back().GetHash());
+        last_received_header = m_chainman.m_blockman.LookupBlockIndex(hashes.back());
         if (IsAncestorOfBestHeaderOrTip(last_received_header)) {
             already_validated_work = true;
         }
@@ -2963,7 +3257,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     // Do anti-DoS checks to determine if we should process or store for later
     // processing.
     if (!already_validated_work && TryLowWorkHeadersSync(peer, pfrom,
-                chain_start_header, headers)) {
+                chain_start_header, headers, hashes)) {
         // If we successfully started a low-work headers sync, then there
         // should be no headers to process any further.
         Assume(headers.empty());
@@ -2981,7 +3275,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     BlockValidationState state;
     const bool processed{m_chainman.ProcessNewBlockHeaders(headers,
                                                            /*min_pow_checked=*/true,
-                                                           state, &pindexLast)};
+                                                           state, &pindexLast, hashes)};
     if (!processed) {
         if (state.IsInvalid()) {
             MaybePunishNodeForBlock(pfrom.GetId(), state, via_compact_block, "invalid header received");
@@ -3951,6 +4245,46 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON || msg_type == NetMsgType::SKETCH || msg_type == NetMsgType::RECONCILDIFF) {
+        auto* tx_relay = peer->GetTxRelay();
+        if (!m_txreconciliation || !tx_relay || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "%s from peer=%d ignored, as we do not reconcile transactions with it\n", msg_type, pfrom.GetId());
+            return;
+        }
+
+        if (msg_type == NetMsgType::REQRECON) {
+            uint16_t peer_set_size, peer_q;
+            vRecv >> peer_set_size >> peer_q;
+            const auto skdata{m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_set_size, peer_q, GetTime<std::chrono::microseconds>())};
+            if (!skdata) {
+                Misbehaving(*peer, "unexpected reqrecon");
+                return;
+            }
+            MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *skdata);
+        } else if (msg_type == NetMsgType::SKETCH) {
+            std::vector<uint8_t> skdata;
+            vRecv >> skdata;
+            const auto result{m_txreconciliation->HandleSketch(pfrom.GetId(), skdata)};
+            if (!result) {
+                Misbehaving(*peer, "unexpected sketch");
+                return;
+            }
+            MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, uint8_t{result->success}, result->ask_shortids);
+            AnnounceReconciledTxs(pfrom, *tx_relay, result->announce);
+        } else {
+            uint8_t success;
+            std::vector<uint32_t> ask_shortids;
+            vRecv >> success >> ask_shortids;
+            const auto announce{m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success, ask_shortids)};
+            if (!announce) {
+                Misbehaving(*peer, "unexpected reconcildiff");
+                return;
+            }
+            AnnounceReconciledTxs(pfrom, *tx_relay, *announce);
+        }
+        return;
+    }
+
     if (msg_type == NetMsgType::INV) {
         std::vector<CInv> vInv;
         vRecv >> vInv;
@@ -3961,53 +4295,69 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         }
 
         const bool reject_tx_invs{RejectIncomingTxs(pfrom)};
-
-        LOCK2(cs_main, m_tx_download_mutex);
+        // Read before taking m_tx_download_mutex: until it latches, this locks
+        // cs_main, which is always acquired before m_tx_download_mutex.
+        const bool is_ibd{m_chainman.IsInitialBlockDownload()};
 
         const auto current_time{GetTime<std::chrono::microseconds>()};
-        uint256* best_block{nullptr};
+        // Transaction announcements only need the transaction download state,
+        // so they are not held up by validation holding cs_main. Block
+        // announcements are handled afterwards.
+        std::vector<uint256> block_invs;
+        {
+            LOCK(m_tx_download_mutex);
+            for (CInv& inv : vInv) {
+                if (interruptMsgProc) return;
+
+                // Ignore INVs that don't match wtxidrelay setting.
+                // Note that orphan parent fetching always uses MSG_TX GETDATAs regardless of the wtxidrelay setting.
+                // This is fine as no INV messages are involved in that process.
+                if (peer->m_wtxid_relay) {
+                    if (inv.IsMsgTx()) continue;
+                } else {
+                    if (inv.IsMsgWtx()) continue;
+                }
 
-        for (CInv& inv : vInv) {
-            if (interruptMsgProc) return;
+                if (inv.IsMsgBlk()) {
+                    block_invs.push_back(inv.hash);
+                } else if (inv.IsGenTxMsg()) {
+                    if (reject_tx_invs) {
+                        LogDebug(BCLog::NET, "transaction (%s) inv sent in violation of protocol, %s\n", inv.hash.ToString(), pfrom.DisconnectMsg(fLogIPs));
+                        pfrom.fDisconnect = true;
+                        return;
+                    }
+                    const GenTxid gtxid = ToGenTxid(inv);
+                    AddKnownTx(*peer, inv.hash);
 
-            // Ignore INVs that don't match wtxidrelay setting.
-            // Note that orphan parent fetching always uses MSG_TX GETDATAs regardless of the wtxidrelay setting.
-            // This is fine as no INV messages are involved in that process.
-            if (peer->m_wtxid_relay) {
-                if (inv.IsMsgTx()) continue;
-            } else {
-                if (inv.IsMsgWtx()) continue;
+                    if (!is_ibd) {
+                        const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
+                        LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
+                    }
+                } else {
+                    LogDebug(BCLog::NET, "Unknown inv type \"%s\" received from peer=%d\n", inv.ToString(), pfrom.GetId());
+                }
             }
+        }
+        if (block_invs.empty()) return;
 
-            if (inv.IsMsgBlk()) {
-                const bool fAlreadyHave = AlreadyHaveBlock(inv.hash);
-                LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
-
-                UpdateBlockAvailability(pfrom.GetId(), inv.hash);
-                if (!fAlreadyHave && !m_chainman.m_blockman.LoadingBlocks() && !IsBlockRequested(inv.hash)) {
-                    // Headers-first is the primary method of announcement on
-                    // the network. If a node fell back to sending blocks by
-                    // inv, it may be for a re-org, or because we haven't
-                    // completed initial headers sync. The final block hash
-                    // provided should be the highest, so send a getheaders and
-                    // then fetch the blocks we need to catch up.
-                    best_block = &inv.hash;
-                }
-            } else if (inv.IsGenTxMsg()) {
-                if (reject_tx_invs) {
-                    LogDebug(BCLog::NET, "transaction (%s) inv sent in violation of protocol, %s\n", inv.hash.ToString(), pfrom.DisconnectMsg(fLogIPs));
-                    pfrom.fDisconnect = true;
-                    return;
-                }
-                const GenTxid gtxid = ToGenTxid(inv);
-                AddKnownTx(*peer, inv.hash);
+        LOCK(cs_main);
+        uint256* best_block{nullptr};
 
-                if (!m_chainman.IsInitialBlockDownload()) {
-                    const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
-                    LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
-                }
-            } else {
-                LogDebug(BCLog::NET, "Unknown inv type \"%s\" received from peer=%d\n", inv.ToString(), pfrom.GetId());
+        for (uint256& hash : block_invs) {
+            if (interruptMsgProc) return;
+
+            const bool fAlreadyHave = AlreadyHaveBlock(hash);
+            LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", CInv{MSG_BLOCK, hash}.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
+
+            UpdateBlockAvailability(pfrom.GetId(), hash);
+            if (!fAlreadyHave && !m_chainman.m_blockman.LoadingBlocks() && !IsBlockRequested(hash)) {
+                // Headers-first is the primary method of announcement on
+                // the network. If a node fell back to sending blocks by
+                // inv, it may be for a re-org, or because we haven't
+                // completed initial headers sync. The final block hash
+                // provided should be the highest, so send a getheaders and
+                // then fetch the blocks we need to catch up.
+                best_block = &hash;
             }
         }
 
@@ -4650,6 +5000,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> TX_WITH_WITNESS(*pblock);
 
@@ -4674,6 +5025,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDownload(pfrom.GetId(), hash, block_size);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -5433,22 +5785,6 @@ void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::mi
     }
 }
 
-namespace {
-class CompareInvMempoolOrder
-{
-    const CTxMemPool* m_mempool;
-public:
-    explicit CompareInvMempoolOrder(CTxMemPool* mempool) : m_mempool{mempool} {}
-
-    bool operator()(std::set<GenTxid>::iterator a, std::set<GenTxid>::iterator b)
-    {
-        /* As std::make_heap produces a max-heap, we want the entries with the
-         * fewest ancestors/highest fee to sort later. */
-        return m_mempool->CompareDepthAndScore(*b, *a);
-    }
-};
-} // namespace
-
 bool PeerManagerImpl::RejectIncomingTxs(const CNode& peer) const
 {
     // block-relay-only peers may never send txs to us
@@ -5728,6 +6064,13 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             peer->m_blocks_for_inv_relay.clear();
         }
 
+        // Give up on a reconciliation round the peer stopped responding in, and
+        // announce the transactions it was about right away.
+        if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr && m_txreconciliation) {
+            const auto expired{m_txreconciliation->MaybeExpireReconciliation(pto->GetId(), current_time)};
+            if (!expired.empty()) AnnounceReconciledTxs(*pto, *tx_relay, expired);
+        }
+
         if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
                 LOCK(tx_relay->m_tx_inventory_mutex);
                 // Check whether periodic sends should happen
@@ -5744,7 +6087,11 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                 // Time to send but the peer has requested we not relay transactions.
                 if (fSendTrickle) {
                     LOCK(tx_relay->m_bloom_filter_mutex);
-                    if (!tx_relay->m_relay_txs) tx_relay->m_tx_inventory_to_send.clear();
+                    if (!tx_relay->m_relay_txs) {
+                        auto& to_send{tx_relay->m_tx_inventory_to_send};
+                        m_tx_relay_schedule.Remove(std::vector<GenTxid>{to_send.begin(), to_send.end()});
+                        to_send.clear();
+                    }
                 }
 
                 // Respond to BIP35 mempool requests
@@ -5762,7 +6109,9 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                                 txinfo.tx->GetWitnessHash().ToUint256() :
                                 txinfo.tx->GetHash().ToUint256(),
                         };
-                        tx_relay->m_tx_inventory_to_send.erase(ToGenTxid(inv));
+                        if (tx_relay->m_tx_inventory_to_send.erase(ToGenTxid(inv))) {
+                            m_tx_relay_schedule.Remove(std::array{ToGenTxid(inv)});
+                        }
 
                         // Don't send transactions that peers will not put into their mempool
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
@@ -5782,47 +6131,53 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
 
                 // Determine transactions to relay
                 if (fSendTrickle) {
-                    // Produce a vector with all candidates for sending
-                    std::vector<std::set<GenTxid>::iterator> vInvTx;
-                    vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                    for (std::set<GenTxid>::iterator it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end(); it++) {
-                        vInvTx.push_back(it);
+                    // Walk the shared schedule, which sorts the queued transactions
+                    // topologically and by fee rate for privacy and priority reasons,
+                    // and pick the ones queued for this peer.
+                    const auto schedule{m_tx_relay_schedule.Get()};
+                    auto& to_send{tx_relay->m_tx_inventory_to_send};
+                    std::vector<GenTxid> removed;
+                    // Transactions that were not in the mempool anymore when the
+                    // schedule was computed are not worth sending.
+                    for (auto it{to_send.begin()}; it != to_send.end();) {
+                        if (schedule->ids.contains(*it)) {
+                            ++it;
+                        } else {
+                            removed.push_back(*it);
+                            it = to_send.erase(it);
+                        }
                     }
                     const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
-                    // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
-                    // A heap is used so that not all items need sorting if only a few are being sent.
-                    CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool);
-                    std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
                     LOCK(tx_relay->m_bloom_filter_mutex);
-                    size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
+                    size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
-                    while (!vInvTx.empty() && nRelayedTransactions < broadcast_max) {
-                        // Fetch the top element from the heap
-                        std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                        std::set<GenTxid>::iterator it = vInvTx.back();
-                        vInvTx.pop_back();
-                        GenTxid hash = *it;
-                        Assume(peer->m_wtxid_relay == hash.IsWtxid());
-                        CInv inv(peer->m_wtxid_relay ? MSG_WTX : MSG_TX, hash.ToUint256());
+                    for (const auto& [hash, txinfo] : schedule->entries) {
+                        if (to_send.empty() || nRelayedTransactions >= broadcast_max) break;
+                        if (hash.IsWtxid() != peer->m_wtxid_relay) continue;
                         // Remove it from the to-be-sent set
-                        tx_relay->m_tx_inventory_to_send.erase(it);
+                        if (!to_send.erase(hash)) continue;
+                        removed.push_back(hash);
+                        CInv inv(peer->m_wtxid_relay ? MSG_WTX : MSG_TX, hash.ToUint256());
                         // Check if not in the filter already
                         if (tx_relay->m_tx_inventory_known_filter.contains(hash.ToUint256())) {
                             continue;
                         }
-                        // Not in the mempool anymore? don't bother sending it.
-                        auto txinfo{std::visit([&](const auto& id) { return m_mempool.info(id); }, hash)};
-                        if (!txinfo.tx) {
-                            continue;
-                        }
                         // Peer told you to not send transactions at that feerate? Don't bother sending it.
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Leave it to the next reconciliation with the peer, unless it was
+                        // picked to still receive the transaction by flooding.
+                        if (m_txreconciliation && hash.IsWtxid() &&
+                            !m_txreconciliation->ShouldFanoutTo(std::get<Wtxid>(hash), pto->GetId()) &&
+                            m_txreconciliation->AddToSet(pto->GetId(), std::get<Wtxid>(hash))) {
+                            tx_relay->m_tx_inventory_known_filter.insert(hash.ToUint256());
+                            continue;
+                        }
                         // Send
                         vInv.push_back(inv);
                         nRelayedTransactions++;
@@ -5832,11 +6187,20 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         }
                         tx_relay->m_tx_inventory_known_filter.insert(hash.ToUint256());
                     }
+                    m_tx_relay_schedule.Remove(removed);
 
                     // Ensure we'll respond to GETDATA requests for anything we've just announced
                     LOCK(m_mempool.cs);
                     tx_relay->m_last_inv_sequence = m_mempool.GetSequence();
                 }
+
+                // Ask the peer for a sketch of its reconciliation set if it is time to
+                // reconcile with it.
+                if (m_txreconciliation) {
+                    if (const auto request{m_txreconciliation->MaybeRequestReconciliation(pto->GetId(), current_time)}) {
+                        MakeAndPushMessage(*pto, NetMsgType::REQRECON, request->first, request->second);
+                    }
+                }
         }
         if (!vInv.empty())
             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
@@ -5912,16 +6276,19 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        // Keep more blocks in flight from peers that deliver them faster.
+        const int download_depth{state.m_block_download.GetDepth()};
+        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && static_cast<int>(state.vBlocksInFlight.size()) < download_depth) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+            const CBlockIndex* stalling_block{nullptr};
+            auto get_inflight_budget = [&state, download_depth]() {
+                return std::max(0, download_depth - static_cast<int>(state.vBlocksInFlight.size()));
             };
 
             // If a snapshot chainstate is in use, we want to find its next blocks
             // before the background chainstate to prioritize getting to network tip.
-            FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload, staller);
+            FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload, staller, stalling_block);
             if (m_chainman.BackgroundSyncInProgress() && !IsLimitedPeer(*peer)) {
                 // If the background tip is not an ancestor of the snapshot block,
                 // we need to start requesting blocks from their last common ancestor.
@@ -5944,6 +6311,16 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     State(staller)->m_stalling_since = current_time;
                     LogDebug(BCLog::NET, "Stall started peer=%d\n", staller);
                 }
+                // Don't wait for the staller to time out if this peer is likely to deliver the
+                // block holding back the window sooner: request it from this peer as well. The
+                // original request stays pending, whichever peer delivers first wins.
+                if (stalling_block && ShouldRerequestBlock(state, *stalling_block, current_time)) {
+                    vGetData.emplace_back(MSG_BLOCK | GetFetchFlags(*peer), stalling_block->GetBlockHash());
+                    BlockRequested(pto->GetId(), *stalling_block);
+                    ++state.m_block_download.m_rerequested;
+                    LogDebug(BCLog::NET, "Requesting block %s (%d) held back by peer=%d from peer=%d too\n",
+                             stalling_block->GetBlockHash().ToString(), stalling_block->nHeight, staller, pto->GetId());
+                }
             }
         }
 
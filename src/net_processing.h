@@ -8,6 +8,7 @@
 
 #include <consensus/amount.h>
 #include <net.h>
+#include <node/blockservecache.h>
 #include <node/txorphanage.h>
 #include <protocol.h>
 #include <threadsafety.h>
@@ -53,6 +54,12 @@ struct CNodeStateStats {
     int m_starting_height = -1;
     std::chrono::microseconds m_ping_wait;
     std::vector<int> vHeightInFlight;
+    uint64_t m_blocks_downloaded{0};
+    uint64_t m_block_bytes_downloaded{0};
+    std::chrono::microseconds m_block_download_latency{0};
+    double m_block_download_rate{0};
+    int m_block_download_depth{0};
+    uint64_t m_blocks_rerequested{0};
     bool m_relay_txs;
     CAmount m_fee_filter_received;
     uint64_t m_addr_processed = 0;
@@ -66,6 +73,7 @@ struct CNodeStateStats {
 struct PeerManagerInfo {
     std::chrono::seconds median_outbound_time_offset{0s};
     bool ignores_incoming_txs{false};
+    node::BlockServeCacheStats block_serve_cache;
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface
@@ -0,0 +1,58 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockservecache.h>
+
+namespace node {
+BlockServeCache::Payload BlockServeCache::Get(const uint256& block_hash, bool witness)
+{
+    LOCK(m_mutex);
+    const auto it{m_entries.find({block_hash, witness})};
+    if (it == m_entries.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    ++m_hits;
+    m_bytes_saved += it->second->second->data.size();
+    return it->second->second;
+}
+
+BlockServeCache::Payload BlockServeCache::Add(const uint256& block_hash, bool witness, std::vector<unsigned char> data)
+{
+    auto payload{std::make_shared<const SharedNetMsgPayload>(std::move(data))};
+    const size_t size{payload->data.size()};
+    if (size > m_max_usage) return payload;
+
+    LOCK(m_mutex);
+    const Key key{block_hash, witness};
+    if (const auto it{m_entries.find(key)}; it != m_entries.end()) {
+        m_usage -= it->second->second->data.size();
+        m_lru.erase(it->second);
+        m_entries.erase(it);
+    }
+    while (m_usage + size > m_max_usage) {
+        m_usage -= m_lru.back().second->data.size();
+        m_entries.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+    m_lru.emplace_front(key, payload);
+    m_entries.emplace(key, m_lru.begin());
+    m_usage += size;
+    return payload;
+}
+
+BlockServeCacheStats BlockServeCache::GetStats() const
+{
+    LOCK(m_mutex);
+    return {
+        .hits = m_hits,
+        .misses = m_misses,
+        .bytes_saved = m_bytes_saved,
+        .entries = m_entries.size(),
+        .usage = m_usage,
+        .max_usage = m_max_usage,
+    };
+}
+} // namespace node
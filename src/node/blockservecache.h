@@ -0,0 +1,82 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKSERVECACHE_H
+#define BITCOIN_NODE_BLOCKSERVECACHE_H
+
+#include <net.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace node {
+struct BlockServeCacheStats {
+    //! Lookups answered from the cache.
+    uint64_t hits{0};
+    //! Lookups that had to fall back to reading the block from disk.
+    uint64_t misses{0};
+    //! Bytes served from the cache that would otherwise have been read from disk.
+    uint64_t bytes_saved{0};
+    //! Number of serialized blocks currently cached.
+    size_t entries{0};
+    //! Bytes currently used by the cached blocks.
+    size_t usage{0};
+    //! Maximum number of bytes the cached blocks may use.
+    size_t max_usage{0};
+};
+
+/**
+ * Bounded cache of serialized blocks served to peers, with and without
+ * witness data. When several peers request the same block, e.g. a recent one
+ * or one during another node's IBD, it is read from disk and serialized only
+ * once.
+ *
+ * The cached buffers are immutable and reference counted, so the send queues
+ * of all peers share them without copying, and evicting a block from the cache
+ * does not affect messages still queued for sending.
+ */
+class BlockServeCache
+{
+public:
+    using Payload = std::shared_ptr<const SharedNetMsgPayload>;
+
+    explicit BlockServeCache(size_t max_usage) : m_max_usage{max_usage} {}
+
+    /** Look up the serialization of a block, returning nullptr if not cached. */
+    Payload Get(const uint256& block_hash, bool witness) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Cache the serialization of a block, evicting the least recently used
+     * blocks beyond the memory budget. Blocks larger than the budget are not
+     * cached. Returns the payload to be sent.
+     */
+    Payload Add(const uint256& block_hash, bool witness, std::vector<unsigned char> data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    BlockServeCacheStats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    using Key = std::pair<uint256, bool>;
+    //! Cached blocks, most recently used first.
+    using LruList = std::list<std::pair<Key, Payload>>;
+
+    const size_t m_max_usage;
+
+    mutable Mutex m_mutex;
+    LruList m_lru GUARDED_BY(m_mutex);
+    std::map<Key, LruList::iterator> m_entries GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    uint64_t m_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_misses GUARDED_BY(m_mutex){0};
+    uint64_t m_bytes_saved GUARDED_BY(m_mutex){0};
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKSERVECACHE_H
@@ -205,10 +205,15 @@ const CBlockIndex* BlockManager::LookupBlockIndex(const uint256& hash) const
 }
 
 CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header)
+{
+    return AddToBlockIndex(block, block.GetHash(), best_header);
+}
+
+CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint256& hash, CBlockIndex*& best_header)
 {
     AssertLockHeld(cs_main);
 
-    auto [mi, inserted] = m_block_index.try_emplace(block.GetHash(), block);
+    auto [mi, inserted] = m_block_index.try_emplace(hash, block);
     if (!inserted) {
         return &mi->second;
     }
@@ -1007,6 +1012,11 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
         return false;
     }
 
+    return ParseBlock(block, block_data, pos, expected_hash);
+}
+
+bool BlockManager::ParseBlock(CBlock& block, std::span<const std::byte> block_data, const FlatFilePos& pos, const std::optional<uint256>& expected_hash) const
+{
     try {
         // Read block
         SpanReader{block_data} >> TX_WITH_WITNESS(block);
@@ -1015,11 +1025,7 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
         return false;
     }
 
-    const auto block_hash{block.GetHash()};
-
-    // Check the header
-    if (!CheckProofOfWork(block_hash, block.nBits, GetConsensus())) {
-        LogError("Errors in block header at %s while reading block", pos.ToString());
+    if (!CheckReadBlockHeader(block, pos, expected_hash)) {
         return false;
     }
 
@@ -1029,6 +1035,19 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
         return false;
     }
 
+    return true;
+}
+
+bool BlockManager::CheckReadBlockHeader(const CBlockHeader& header, const FlatFilePos& pos, const std::optional<uint256>& expected_hash) const
+{
+    const auto block_hash{header.GetHash()};
+
+    // Check the header
+    if (!CheckProofOfWork(block_hash, header.nBits, GetConsensus())) {
+        LogError("Errors in block header at %s while reading block", pos.ToString());
+        return false;
+    }
+
     if (expected_hash && block_hash != *expected_hash) {
         LogError("GetHash() doesn't match index at %s while reading block (%s != %s)",
                  pos.ToString(), block_hash.ToString(), expected_hash->ToString());
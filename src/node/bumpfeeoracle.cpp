@@ -0,0 +1,139 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/bumpfeeoracle.h>
+
+#include <kernel/mempool_entry.h>
+#include <txmempool.h>
+#include <util/check.h>
+
+#include <algorithm>
+#include <set>
+
+namespace node {
+namespace {
+/** Whether a kept cluster still matches the mempool. A transaction added to the
+ * cluster changes the descendant count of its parents, a removed one is missing
+ * or changes the ancestor size of its children, and a prioritised one changes
+ * its modified fee. */
+bool IsCurrent(const CTxMemPool& mempool, const MiniMinerCluster& cluster) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs)
+{
+    AssertLockHeld(mempool.cs);
+    return std::ranges::all_of(cluster.entries, [&](const MiniMinerMempoolEntry& entry) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs) {
+        const Txid& txid{entry.GetTx().GetHash()};
+        const auto it{mempool.GetIter(txid)};
+        return it &&
+               (*it)->GetTxSize() == entry.GetTxSize() &&
+               (*it)->GetModifiedFee() == entry.GetModifiedFee() &&
+               (*it)->GetSizeWithAncestors() == entry.GetSizeWithAncestors() &&
+               (*it)->GetModFeesWithAncestors() == entry.GetModFeesWithAncestors() &&
+               (*it)->GetCountWithDescendants() == cluster.descendants.at(txid).size();
+    });
+}
+} // namespace
+
+std::vector<std::map<COutPoint, CAmount>> BumpFeeOracle::CalculateBumpFees(const std::vector<COutPoint>& outpoints, std::span<const CFeeRate> target_feerates)
+{
+    const auto clusters{GetClusters(outpoints)};
+    if (!clusters) return {};
+    std::vector<const MiniMinerCluster*> cluster_ptrs;
+    for (const auto& cluster : *clusters) cluster_ptrs.push_back(cluster.get());
+    return MiniMiner(cluster_ptrs, outpoints).CalculateBumpFees(target_feerates);
+}
+
+std::optional<CAmount> BumpFeeOracle::CalculateTotalBumpFee(const std::vector<COutPoint>& outpoints, const CFeeRate& target_feerate)
+{
+    const auto clusters{GetClusters(outpoints)};
+    if (!clusters) return std::nullopt;
+    std::vector<const MiniMinerCluster*> cluster_ptrs;
+    for (const auto& cluster : *clusters) cluster_ptrs.push_back(cluster.get());
+    return MiniMiner(cluster_ptrs, outpoints).CalculateTotalBumpFees(target_feerate);
+}
+
+size_t BumpFeeOracle::Size() const
+{
+    LOCK(m_mutex);
+    return m_clusters.size();
+}
+
+std::optional<std::vector<std::shared_ptr<const MiniMinerCluster>>> BumpFeeOracle::GetClusters(const std::vector<COutPoint>& outpoints)
+{
+    LOCK2(m_mempool.cs, m_mutex);
+    // Every change to the mempool in this epoch must have been notified, and
+    // have dropped the clusters it changed. Otherwise start a new epoch, in
+    // which the kept clusters are compared against the mempool before use.
+    if (m_mempool_sequence + m_num_changes != m_mempool.GetSequence() ||
+        static_cast<unsigned int>(m_transactions_updated + m_num_changes) != m_mempool.GetTransactionsUpdated()) {
+        ++m_epoch;
+        m_mempool_sequence = m_mempool.GetSequence();
+        m_transactions_updated = m_mempool.GetTransactionsUpdated();
+        m_num_changes = 0;
+    }
+
+    std::vector<std::shared_ptr<const MiniMinerCluster>> clusters;
+    for (const auto& outpoint : outpoints) {
+        if (auto it{m_clusters.find(outpoint.hash)}; it != m_clusters.end()) {
+            const auto kept{it->second};
+            if (kept->epoch == m_epoch || IsCurrent(m_mempool, *kept->cluster)) {
+                kept->epoch = m_epoch;
+                clusters.push_back(kept->cluster);
+                continue;
+            }
+            Invalidate(outpoint.hash);
+        }
+        if (!m_mempool.exists(outpoint.hash)) continue;
+
+        auto cluster{GetMiniMinerCluster(m_mempool, outpoint.hash)};
+        if (!cluster) return std::nullopt;
+        if (m_clusters.size() + cluster->entries.size() > MAX_KEPT_TRANSACTIONS) m_clusters.clear();
+        auto kept{std::make_shared<KeptCluster>(KeptCluster{std::make_shared<const MiniMinerCluster>(std::move(*cluster)), m_epoch})};
+        for (const auto& entry : kept->cluster->entries) {
+            // Drop outdated clusters that the transaction was kept in.
+            Invalidate(entry.GetTx().GetHash());
+            m_clusters.emplace(entry.GetTx().GetHash(), kept);
+        }
+        clusters.push_back(kept->cluster);
+    }
+
+    // Outpoints of the same cluster share its copy.
+    std::set<const MiniMinerCluster*> distinct;
+    size_t num_transactions{0};
+    for (const auto& cluster : clusters) {
+        if (distinct.insert(cluster.get()).second) num_transactions += cluster->entries.size();
+    }
+    if (num_transactions > MAX_REQUEST_TRANSACTIONS) return std::nullopt;
+    return clusters;
+}
+
+void BumpFeeOracle::Invalidate(const Txid& txid)
+{
+    AssertLockHeld(m_mutex);
+    const auto it{m_clusters.find(txid)};
+    if (it == m_clusters.end()) return;
+    const auto kept{it->second};
+    for (const auto& entry : kept->cluster->entries) {
+        m_clusters.erase(entry.GetTx().GetHash());
+    }
+}
+
+void BumpFeeOracle::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    // Changes from before the epoch started are compared against anyway.
+    if (mempool_sequence < m_mempool_sequence) return;
+    ++m_num_changes;
+    // The new transaction joins the clusters of its parents.
+    for (const auto& input : tx.info.m_tx->vin) {
+        Invalidate(input.prevout.hash);
+    }
+}
+
+void BumpFeeOracle::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    if (mempool_sequence < m_mempool_sequence) return;
+    ++m_num_changes;
+    Invalidate(tx->GetHash());
+}
+} // namespace node
@@ -0,0 +1,93 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BUMPFEEORACLE_H
+#define BITCOIN_NODE_BUMPFEEORACLE_H
+
+#include <consensus/amount.h>
+#include <node/mini_miner.h>
+#include <policy/feerate.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <validationinterface.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+class CTxMemPool;
+
+namespace node {
+/**
+ * Calculates bump fees like MiniMiner, keeping the mempool clusters it copied
+ * for later requests.
+ *
+ * Copying the cluster of a transaction out of the mempool (and calculating the
+ * descendant sets in it) is the costly part of constructing a MiniMiner. The
+ * copies are kept until a transaction is added to or removed from their
+ * cluster, which the mempool notifies. When the mempool changed in a way that
+ * was not notified (yet), like a prioritisation, the removal of a block's
+ * transactions, or a change whose notification is still queued, the kept
+ * copies are compared against the mempool again before they are used.
+ */
+class BumpFeeOracle final : public CValidationInterface
+{
+public:
+    //! Number of transactions in the kept clusters above which they are all dropped.
+    static constexpr size_t MAX_KEPT_TRANSACTIONS{10'000};
+    //! Number of transactions in the clusters of one request above which its bump fees are not
+    //! calculated, like the limit CTxMemPool::GatherClusters() puts on a MiniMiner.
+    static constexpr size_t MAX_REQUEST_TRANSACTIONS{500};
+
+    explicit BumpFeeOracle(const CTxMemPool& mempool) : m_mempool{mempool} {}
+
+    /** Calculate the bump fees of the outpoints for each of the target feerates, see
+     * MiniMiner::CalculateBumpFees(). Returns one map per target feerate, in the same order, or an
+     * empty vector if they cannot be calculated. */
+    std::vector<std::map<COutPoint, CAmount>> CalculateBumpFees(const std::vector<COutPoint>& outpoints, std::span<const CFeeRate> target_feerates) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Calculate the combined bump fee of the outpoints, see MiniMiner::CalculateTotalBumpFees(). */
+    std::optional<CAmount> CalculateTotalBumpFee(const std::vector<COutPoint>& outpoints, const CFeeRate& target_feerate) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Number of transactions in the kept clusters.
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+protected:
+    void TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence) override EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    /** Get the clusters of the outpoints' transactions that are in the mempool, copying the ones
+     * that are not kept. Returns std::nullopt if one of them, or all of them together, are too
+     * large. */
+    std::optional<std::vector<std::shared_ptr<const MiniMinerCluster>>> GetClusters(const std::vector<COutPoint>& outpoints) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Drop the kept cluster of a transaction, if any */
+    void Invalidate(const Txid& txid) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    struct KeptCluster {
+        std::shared_ptr<const MiniMinerCluster> cluster;
+        //! Value of m_epoch when the cluster was last known to match the mempool.
+        uint64_t epoch;
+    };
+
+    const CTxMemPool& m_mempool;
+
+    mutable Mutex m_mutex;
+    //! Kept clusters, by the txids of their transactions.
+    std::map<Txid, std::shared_ptr<KeptCluster>> m_clusters GUARDED_BY(m_mutex);
+    //! Incremented whenever the mempool changed in a way that was not notified.
+    uint64_t m_epoch GUARDED_BY(m_mutex){0};
+    //! Mempool sequence number and update counter at the start of the epoch.
+    uint64_t m_mempool_sequence GUARDED_BY(m_mutex){0};
+    unsigned int m_transactions_updated GUARDED_BY(m_mutex){0};
+    //! Number of mempool changes notified since the start of the epoch.
+    uint64_t m_num_changes GUARDED_BY(m_mutex){0};
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_BUMPFEEORACLE_H
@@ -58,6 +58,7 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
     }
     // Subtract 1 because the main thread counts towards the par threads.
     opts.worker_threads_num = script_threads - 1;
+    opts.pin_worker_threads = args.GetBoolArg("-parpin", DEFAULT_SCRIPTCHECK_PIN_THREADS);
 
     if (auto max_size = args.GetIntArg("-maxsigcachesize")) {
         // 1. When supplied with a max_size of 0, both the signature cache and
@@ -13,7 +13,9 @@
 #include <net.h>
 #include <net_processing.h>
 #include <netgroup.h>
+#include <node/bumpfeeoracle.h>
 #include <node/kernel_notifications.h>
+#include <node/miner.h>
 #include <node/warnings.h>
 #include <policy/fees.h>
 #include <scheduler.h>
@@ -40,6 +40,8 @@ class SignalInterrupt;
 }
 
 namespace node {
+class BlockTemplateCache;
+class BumpFeeOracle;
 class KernelNotifications;
 class Warnings;
 
@@ -74,11 +76,15 @@ struct NodeContext {
     ArgsManager* args{nullptr}; // Currently a raw pointer because the memory is not managed by this struct
     std::vector<BaseIndex*> indexes; // raw pointers because memory is not managed by this struct
     std::unique_ptr<interfaces::Chain> chain;
+    //! Mempool clusters kept for the bump fee calculations of the chain interface
+    std::unique_ptr<BumpFeeOracle> bump_fee_oracle;
     //! List of all chain clients (wallet processes or other client) connected to node.
     std::vector<std::unique_ptr<interfaces::ChainClient>> chain_clients;
     //! Reference to chain client that should used to load or create wallets
     //! opened by the gui.
     std::unique_ptr<interfaces::Mining> mining;
+    //! Block template kept up to date with the mempool for the mining interface
+    std::unique_ptr<BlockTemplateCache> block_template_cache;
     interfaces::WalletLoader* wallet_loader{nullptr};
     std::unique_ptr<CScheduler> scheduler;
     std::function<void()> rpc_interruption_point = [] {};
@@ -30,6 +30,7 @@
 #include <netaddress.h>
 #include <netbase.h>
 #include <node/blockstorage.h>
+#include <node/bumpfeeoracle.h>
 #include <node/coin.h>
 #include <node/context.h>
 #include <node/interface_ui.h>
@@ -708,6 +709,10 @@ public:
             }
             return bump_fees;
         }
+        if (m_node.bump_fee_oracle) {
+            auto bump_fees{m_node.bump_fee_oracle->CalculateBumpFees(outpoints, std::span{&target_feerate, 1})};
+            return bump_fees.empty() ? std::map<COutPoint, CAmount>{} : std::move(bump_fees.front());
+        }
         return MiniMiner(*m_node.mempool, outpoints).CalculateBumpFees(target_feerate);
     }
 
@@ -716,6 +721,7 @@ public:
         if (!m_node.mempool) {
             return 0;
         }
+        if (m_node.bump_fee_oracle) return m_node.bump_fee_oracle->CalculateTotalBumpFee(outpoints, target_feerate);
         return MiniMiner(*m_node.mempool, outpoints).CalculateTotalBumpFees(target_feerate);
     }
     void getPackageLimits(unsigned int& limit_ancestor_count, unsigned int& limit_descendant_count) override
@@ -921,6 +927,11 @@ public:
         return TransactionMerklePath(m_block_template->block, 0);
     }
 
+    bool isValidated() override
+    {
+        return *m_block_template->validated;
+    }
+
     bool submitSolution(uint32_t version, uint32_t timestamp, uint32_t nonce, CTransactionRef coinbase) override
     {
         AddMerkleRootAndCoinbase(m_block_template->block, std::move(coinbase), version, timestamp, nonce);
@@ -929,7 +940,7 @@ public:
 
     std::unique_ptr<BlockTemplate> waitNext(BlockWaitOptions options) override
     {
-        auto new_template = WaitAndCreateNewBlock(chainman(), notifications(), m_node.mempool.get(), m_block_template, options, m_assemble_options);
+        auto new_template = WaitAndCreateNewBlock(chainman(), notifications(), m_node.mempool.get(), m_node.block_template_cache.get(), m_block_template, options, m_assemble_options);
         if (new_template) return std::make_unique<BlockTemplateImpl>(m_assemble_options, std::move(new_template), m_node);
         return nullptr;
     }
@@ -975,6 +986,9 @@ public:
 
         BlockAssembler::Options assemble_options{options};
         ApplyArgsManOptions(*Assert(m_node.args), assemble_options);
+        if (m_node.block_template_cache) {
+            return std::make_unique<BlockTemplateImpl>(assemble_options, m_node.block_template_cache->Get(assemble_options), m_node);
+        }
         return std::make_unique<BlockTemplateImpl>(assemble_options, BlockAssembler{chainman().ActiveChainstate(), context()->mempool.get(), assemble_options}.CreateNewBlock(), m_node);
     }
 
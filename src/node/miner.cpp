@@ -24,6 +24,7 @@
 #include <primitives/transaction.h>
 #include <util/moneystr.h>
 #include <util/signalinterrupt.h>
+#include <util/thread.h>
 #include <util/time.h>
 #include <validation.h>
 
@@ -119,6 +120,13 @@ void BlockAssembler::resetBlock()
 }
 
 std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock()
+{
+    LOCK(::cs_main);
+    SelectTransactions();
+    return FinishBlock(std::move(pblocktemplate), m_options.coinbase_output_script, m_options.test_block_validity);
+}
+
+void BlockAssembler::SelectTransactions()
 {
     const auto time_start{SteadyClock::now()};
 
@@ -131,12 +139,11 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock()
     // getblocktemplate RPC and mining interface consumers must not use it.
     pblock->vtx.emplace_back();
 
-    LOCK(::cs_main);
-    CBlockIndex* pindexPrev = m_chainstate.m_chain.Tip();
-    assert(pindexPrev != nullptr);
-    nHeight = pindexPrev->nHeight + 1;
+    m_prev_block = m_chainstate.m_chain.Tip();
+    assert(m_prev_block != nullptr);
+    nHeight = m_prev_block->nHeight + 1;
 
-    pblock->nVersion = m_chainstate.m_chainman.m_versionbitscache.ComputeBlockVersion(pindexPrev, chainparams.GetConsensus());
+    pblock->nVersion = m_chainstate.m_chainman.m_versionbitscache.ComputeBlockVersion(m_prev_block, chainparams.GetConsensus());
     // -regtest only: allow overriding block.nVersion with
     // -blockversion=N to test forking scenarios
     if (chainparams.MineBlocksOnDemand()) {
@@ -144,15 +151,33 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock()
     }
 
     pblock->nTime = TicksSinceEpoch<std::chrono::seconds>(NodeClock::now());
-    m_lock_time_cutoff = pindexPrev->GetMedianTimePast();
+    m_lock_time_cutoff = m_prev_block->GetMedianTimePast();
 
     int nPackagesSelected = 0;
     int nDescendantsUpdated = 0;
     if (m_mempool) {
+        LOCK(m_mempool->cs);
         addPackageTxs(nPackagesSelected, nDescendantsUpdated);
     }
 
-    const auto time_1{SteadyClock::now()};
+    m_lowest_package_feerate.reset();
+    for (const FeeFrac& package_feerate : pblocktemplate->m_package_feerates) {
+        if (!m_lowest_package_feerate || package_feerate << *m_lowest_package_feerate) m_lowest_package_feerate = package_feerate;
+    }
+
+    LogDebug(BCLog::BENCH, "CreateNewBlock() packages: %.2fms (%d packages, %d updated descendants)\n",
+             Ticks<MillisecondsDouble>(SteadyClock::now() - time_start), nPackagesSelected, nDescendantsUpdated);
+}
+
+std::unique_ptr<CBlockTemplate> BlockAssembler::GetBlockTemplate(const CScript& coinbase_output_script, bool test_block_validity) const
+{
+    return FinishBlock(std::make_unique<CBlockTemplate>(*Assert(pblocktemplate)), coinbase_output_script, test_block_validity);
+}
+
+std::unique_ptr<CBlockTemplate> BlockAssembler::FinishBlock(std::unique_ptr<CBlockTemplate> block_template, const CScript& coinbase_output_script, bool test_block_validity) const
+{
+    const auto time_start{SteadyClock::now()};
+    CBlock* const pblock = &block_template->block; // pointer for convenience
 
     m_last_block_num_txs = nBlockTx;
     m_last_block_weight = nBlockWeight;
@@ -163,35 +188,79 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock()
     coinbaseTx.vin[0].prevout.SetNull();
     coinbaseTx.vin[0].nSequence = CTxIn::MAX_SEQUENCE_NONFINAL; // Make sure timelock is enforced.
     coinbaseTx.vout.resize(1);
-    coinbaseTx.vout[0].scriptPubKey = m_options.coinbase_output_script;
+    coinbaseTx.vout[0].scriptPubKey = coinbase_output_script;
     coinbaseTx.vout[0].nValue = nFees + GetBlockSubsidy(nHeight, chainparams.GetConsensus());
     coinbaseTx.vin[0].scriptSig = CScript() << nHeight << OP_0;
     Assert(nHeight > 0);
     coinbaseTx.nLockTime = static_cast<uint32_t>(nHeight - 1);
     pblock->vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
-    pblocktemplate->vchCoinbaseCommitment = m_chainstate.m_chainman.GenerateCoinbaseCommitment(*pblock, pindexPrev);
+    block_template->vchCoinbaseCommitment = m_chainstate.m_chainman.GenerateCoinbaseCommitment(*pblock, m_prev_block);
 
     LogPrintf("CreateNewBlock(): block weight: %u txs: %u fees: %ld sigops %d\n", GetBlockWeight(*pblock), nBlockTx, nFees, nBlockSigOpsCost);
 
     // Fill in header
-    pblock->hashPrevBlock  = pindexPrev->GetBlockHash();
-    UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev);
-    pblock->nBits          = GetNextWorkRequired(pindexPrev, pblock, chainparams.GetConsensus());
+    pblock->hashPrevBlock  = m_prev_block->GetBlockHash();
+    UpdateTime(pblock, chainparams.GetConsensus(), m_prev_block);
+    pblock->nBits          = GetNextWorkRequired(m_prev_block, pblock, chainparams.GetConsensus());
     pblock->nNonce         = 0;
 
-    if (m_options.test_block_validity) {
+    if (test_block_validity) {
         if (BlockValidationState state{TestBlockValidity(m_chainstate, *pblock, /*check_pow=*/false, /*check_merkle_root=*/false)}; !state.IsValid()) {
             throw std::runtime_error(strprintf("TestBlockValidity failed: %s", state.ToString()));
         }
     }
-    const auto time_2{SteadyClock::now()};
+    block_template->validated = std::make_shared<std::atomic_bool>(test_block_validity);
 
-    LogDebug(BCLog::BENCH, "CreateNewBlock() packages: %.2fms (%d packages, %d updated descendants), validity: %.2fms (total %.2fms)\n",
-             Ticks<MillisecondsDouble>(time_1 - time_start), nPackagesSelected, nDescendantsUpdated,
-             Ticks<MillisecondsDouble>(time_2 - time_1),
-             Ticks<MillisecondsDouble>(time_2 - time_start));
+    LogDebug(BCLog::BENCH, "CreateNewBlock() validity: %.2fms\n", Ticks<MillisecondsDouble>(SteadyClock::now() - time_start));
 
-    return std::move(pblocktemplate);
+    return block_template;
+}
+
+bool BlockAssembler::AddTransaction(const Txid& txid)
+{
+    const auto& mempool{*Assert(m_mempool)};
+    AssertLockHeld(mempool.cs);
+
+    // Transactions that were removed again, or were already in the mempool
+    // when the transactions were selected, need no update.
+    const auto it{mempool.GetIter(txid)};
+    if (!it || inBlock.contains(txid)) return true;
+
+    auto package{mempool.AssumeCalculateMemPoolAncestors(__func__, **it, CTxMemPool::Limits::NoLimits(), /*fSearchForParents=*/false)};
+    onlyUnconfirmed(package);
+    package.insert(*it);
+
+    uint64_t package_size{0};
+    CAmount package_fees{0};
+    int64_t package_sigops_cost{0};
+    for (CTxMemPool::txiter entry : package) {
+        package_size += entry->GetTxSize();
+        package_fees += entry->GetModifiedFee();
+        package_sigops_cost += entry->GetSigOpCost();
+    }
+    if (package_fees < m_options.blockMinFeeRate.GetFee(package_size)) {
+        return true;
+    }
+
+    // A package paying a higher fee rate than a selected one would have been
+    // considered before it.
+    const FeeFrac package_feerate{package_fees, static_cast<int32_t>(package_size)};
+    if (m_lowest_package_feerate && package_feerate >> *m_lowest_package_feerate) {
+        return false;
+    }
+
+    // Otherwise it would have been considered after all selected packages.
+    if (!TestPackage(package_size, package_sigops_cost) || !TestPackageTransactions(package)) {
+        return true;
+    }
+    std::vector<CTxMemPool::txiter> sortedEntries;
+    SortForBlock(package, sortedEntries);
+    for (CTxMemPool::txiter entry : sortedEntries) {
+        AddToBlock(entry);
+    }
+    pblocktemplate->m_package_feerates.push_back(package_feerate);
+    m_lowest_package_feerate = package_feerate;
+    return true;
 }
 
 void BlockAssembler::onlyUnconfirmed(CTxMemPool::setEntries& testSet)
@@ -302,7 +371,7 @@ void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package, std::ve
 void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated)
 {
     const auto& mempool{*Assert(m_mempool)};
-    LOCK(mempool.cs);
+    AssertLockHeld(mempool.cs);
 
     // mapModifiedTx will store sorted packages after they are modified
     // because some of their txs are already in the block
@@ -454,9 +523,212 @@ void AddMerkleRootAndCoinbase(CBlock& block, CTransactionRef coinbase, uint32_t
     block.hashMerkleRoot = BlockMerkleRoot(block);
 }
 
+BlockTemplateCache::BlockTemplateCache(ChainstateManager& chainman, const CTxMemPool& mempool)
+    : m_chainman{chainman}, m_mempool{mempool}
+{
+}
+
+BlockTemplateCache::~BlockTemplateCache()
+{
+    std::thread validation_thread;
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+        validation_thread = std::move(m_validation_thread);
+    }
+    m_validation_cv.notify_all();
+    if (validation_thread.joinable()) validation_thread.join();
+}
+
+std::unique_ptr<CBlockTemplate> BlockTemplateCache::Get(const BlockAssembler::Options& options)
+{
+    if (!options.use_mempool) {
+        return BlockAssembler{m_chainman.ActiveChainstate(), nullptr, options}.CreateNewBlock();
+    }
+
+    LOCK2(::cs_main, m_mutex);
+    if (!Update(options)) {
+        {
+            LOCK(m_mempool.cs);
+            m_mempool_sequence = m_mempool.GetSequence();
+            m_transactions_updated = m_mempool.GetTransactionsUpdated();
+        }
+        m_num_changes = 0;
+        m_added.clear();
+        m_removed.clear();
+        m_validated = std::make_shared<std::atomic_bool>(false);
+        ++m_generation;
+        m_assembler.emplace(m_chainman.ActiveChainstate(), &m_mempool, options);
+        m_assembler->SelectTransactions();
+    }
+
+    // The validity only needs checking again once transactions were added.
+    if (!options.test_block_validity || *m_validated) {
+        auto block_template{m_assembler->GetBlockTemplate(options.coinbase_output_script, /*test_block_validity=*/false)};
+        block_template->validated = m_validated;
+        return block_template;
+    }
+    if (!options.defer_validity_check || m_validate_before_handout) {
+        try {
+            auto block_template{m_assembler->GetBlockTemplate(options.coinbase_output_script, /*test_block_validity=*/true)};
+            *m_validated = true;
+            block_template->validated = m_validated;
+            m_validate_before_handout = false;
+            return block_template;
+        } catch (const std::runtime_error&) {
+            m_assembler.reset();
+            throw;
+        }
+    }
+
+    if (!m_validation_thread.joinable()) {
+        m_validation_thread = std::thread(&util::TraceThread, "tmplcheck", [this] { ThreadValidate(); });
+    }
+    auto block_template{m_assembler->GetBlockTemplate(options.coinbase_output_script, /*test_block_validity=*/false)};
+    block_template->validated = m_validated;
+    if (m_validation_generation != m_generation || (!m_validation_queued && !m_validating)) {
+        m_validation_queued = std::make_shared<const CBlock>(block_template->block);
+        m_validation_generation = m_generation;
+        m_validation_result = m_validated;
+        m_validation_cv.notify_all();
+    }
+    return block_template;
+}
+
+bool BlockTemplateCache::WaitForValidation()
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_validation_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_validation_queued && !m_validating; });
+    return *m_validated;
+}
+
+void BlockTemplateCache::ThreadValidate()
+{
+    while (true) {
+        std::shared_ptr<const CBlock> block;
+        std::shared_ptr<std::atomic_bool> result;
+        uint64_t generation;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_validation_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_validation_queued; });
+            if (m_stop) return;
+            block = std::move(m_validation_queued);
+            m_validation_queued.reset();
+            result = m_validation_result;
+            generation = m_validation_generation;
+            m_validating = true;
+        }
+
+        // Whether the template still builds on the tip, and no stored block
+        // extending the tip is about to be connected and outdate it anyway.
+        const auto still_current{[&]() EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+            const CBlockIndex* tip{m_chainman.ActiveChain().Tip()};
+            const CBlockIndex* best_header{m_chainman.m_best_header};
+            const bool connecting_block{best_header && best_header->pprev == tip && (best_header->nStatus & BLOCK_HAVE_DATA)};
+            return tip && tip->GetBlockHash() == block->hashPrevBlock && !connecting_block;
+        }};
+
+        // Read the spent coins into the coins cache first, a batch per
+        // cs_main acquisition, so that a block arriving meanwhile is not held
+        // up by the disk reads, and the check below runs from memory.
+        bool current{true};
+        for (size_t begin{1}; current && begin < block->vtx.size(); begin += PREFETCH_BATCH_TXS) {
+            LOCK(::cs_main);
+            current = still_current();
+            if (!current) break;
+            const CCoinsViewCache& coins_tip{m_chainman.ActiveChainstate().CoinsTip()};
+            for (size_t i{begin}; i < std::min(begin + PREFETCH_BATCH_TXS, block->vtx.size()); ++i) {
+                for (const CTxIn& txin : block->vtx[i]->vin) {
+                    coins_tip.HaveCoin(txin.prevout);
+                }
+            }
+        }
+
+        std::optional<BlockValidationState> state;
+        if (current) {
+            LOCK(::cs_main);
+            if (still_current()) {
+                state = TestBlockValidity(m_chainman.ActiveChainstate(), *block, /*check_pow=*/false, /*check_merkle_root=*/false);
+            }
+        }
+
+        {
+            LOCK(m_mutex);
+            m_validating = false;
+            if (state && generation == m_generation) {
+                if (state->IsValid()) {
+                    *result = true;
+                } else {
+                    LogError("Block template failed validity check: %s", state->ToString());
+                    m_assembler.reset();
+                    m_validate_before_handout = true;
+                }
+            }
+        }
+        m_validation_cv.notify_all();
+    }
+}
+
+bool BlockTemplateCache::Update(const BlockAssembler::Options& options)
+{
+    AssertLockHeld(::cs_main);
+    AssertLockHeld(m_mutex);
+
+    if (!m_assembler || m_assembler->GetPrevBlock() != m_chainman.ActiveChain().Tip()) return false;
+    const auto& kept_options{m_assembler->GetOptions()};
+    if (kept_options.nBlockMaxWeight != options.nBlockMaxWeight ||
+        kept_options.blockMinFeeRate != options.blockMinFeeRate ||
+        kept_options.block_reserved_weight != options.block_reserved_weight ||
+        kept_options.coinbase_output_max_additional_sigops != options.coinbase_output_max_additional_sigops) {
+        return false;
+    }
+
+    LOCK(m_mempool.cs);
+    // Every change to the mempool since the transactions were selected must
+    // have been notified and be pending here. Removals for a block and
+    // prioritisations are not notified, and notifications may still be
+    // queued.
+    if (m_mempool_sequence + m_num_changes != m_mempool.GetSequence() ||
+        static_cast<unsigned int>(m_transactions_updated + m_num_changes) != m_mempool.GetTransactionsUpdated()) {
+        return false;
+    }
+    if (std::ranges::any_of(m_removed, [&](const Txid& txid) { return m_assembler->InBlock(txid); })) {
+        return false;
+    }
+    m_removed.clear();
+    if (!m_added.empty()) {
+        m_validated = std::make_shared<std::atomic_bool>(false);
+        ++m_generation;
+    }
+    for (const Txid& txid : m_added) {
+        if (!m_assembler->AddTransaction(txid)) return false;
+    }
+    m_added.clear();
+    return true;
+}
+
+void BlockTemplateCache::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    if (!m_assembler || mempool_sequence < m_mempool_sequence) return;
+    m_added.push_back(tx.info.m_tx->GetHash());
+    ++m_num_changes;
+    if (m_added.size() + m_removed.size() > MAX_PENDING_CHANGES) m_assembler.reset();
+}
+
+void BlockTemplateCache::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    if (!m_assembler || mempool_sequence < m_mempool_sequence) return;
+    m_removed.push_back(tx->GetHash());
+    ++m_num_changes;
+    if (m_added.size() + m_removed.size() > MAX_PENDING_CHANGES) m_assembler.reset();
+}
+
 std::unique_ptr<CBlockTemplate> WaitAndCreateNewBlock(ChainstateManager& chainman,
                                                       KernelNotifications& kernel_notifications,
                                                       CTxMemPool* mempool,
+                                                      BlockTemplateCache* block_template_cache,
                                                       const std::unique_ptr<CBlockTemplate>& block_template,
                                                       const BlockWaitOptions& options,
                                                       const BlockAssembler::Options& assemble_options)
@@ -512,11 +784,12 @@ std::unique_ptr<CBlockTemplate> WaitAndCreateNewBlock(ChainstateManager& chainma
          * We'll also create a new template if the tip changed during this iteration.
          */
         if (options.fee_threshold < MAX_MONEY || tip_changed) {
-            auto new_tmpl{BlockAssembler{
-                chainman.ActiveChainstate(),
-                mempool,
-                assemble_options}
-                              .CreateNewBlock()};
+            auto new_tmpl{block_template_cache ? block_template_cache->Get(assemble_options) :
+                                                 BlockAssembler{
+                                                     chainman.ActiveChainstate(),
+                                                     mempool,
+                                                     assemble_options}
+                                                     .CreateNewBlock()};
 
             // If the tip changed, return the new template regardless of its fees.
             if (tip_changed) return new_tmpl;
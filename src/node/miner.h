@@ -12,10 +12,15 @@
 #include <primitives/block.h>
 #include <txmempool.h>
 #include <util/feefrac.h>
+#include <validationinterface.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <thread>
+#include <vector>
 
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/indexed_by.hpp>
@@ -50,6 +55,10 @@ struct CBlockTemplate
     /* A vector of package fee rates, ordered by the sequence in which
      * packages are selected for inclusion in the block template.*/
     std::vector<FeeFrac> m_package_feerates;
+    /* Set once the block passed TestBlockValidity. Templates handed out before
+     * their check finished (see BlockCreateOptions::defer_validity_check) share
+     * it with the check running in the background. */
+    std::shared_ptr<std::atomic_bool> validated{std::make_shared<std::atomic_bool>(false)};
 };
 
 // Container for tracking updates to ancestor feerate as we include (parent)
@@ -161,8 +170,11 @@ private:
     std::unordered_set<Txid, SaltedTxidHasher> inBlock;
 
     // Chain context for the block
+    const CBlockIndex* m_prev_block{nullptr};
     int nHeight;
     int64_t m_lock_time_cutoff;
+    // Lowest fee rate of the selected packages, unset while none is selected
+    std::optional<FeeFrac> m_lowest_package_feerate;
 
     const CChainParams& chainparams;
     const CTxMemPool* const m_mempool;
@@ -183,6 +195,38 @@ public:
     /** Construct a new block template */
     std::unique_ptr<CBlockTemplate> CreateNewBlock();
 
+    /**
+     * Select the transactions for a new block on top of the current tip and
+     * keep them in the assembler. Together with AddTransaction() and
+     * GetBlockTemplate() this allows keeping a block template up to date with
+     * the mempool and handing it out repeatedly.
+     */
+    void SelectTransactions() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Update the selected transactions for a transaction that was added to
+     * the mempool after they were selected. If the package of the transaction
+     * pays a lower fee rate than every selected package, it is appended when
+     * it fits, as addPackageTxs() would have done.
+     *
+     * @returns false if the transaction may displace selected ones, in which
+     *          case the transactions must be selected again.
+     *
+     * @pre BlockAssembler::m_mempool must not be nullptr
+     */
+    bool AddTransaction(const Txid& txid) EXCLUSIVE_LOCKS_REQUIRED(m_mempool->cs);
+
+    /** Whether the transaction is one of the selected transactions */
+    bool InBlock(const Txid& txid) const { return inBlock.contains(txid); }
+
+    /** The tip the selected transactions were selected on top of */
+    const CBlockIndex* GetPrevBlock() const { return m_prev_block; }
+
+    const Options& GetOptions() const { return m_options; }
+
+    /** Hand out a block template with the selected transactions */
+    std::unique_ptr<CBlockTemplate> GetBlockTemplate(const CScript& coinbase_output_script, bool test_block_validity) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     /** The number of transactions in the last assembled block (excluding coinbase transaction) */
     inline static std::optional<int64_t> m_last_block_num_txs{};
     /** The weight of the last assembled block (including reserved weight for block header, txs count and coinbase tx) */
@@ -196,6 +240,8 @@ private:
     void resetBlock();
     /** Add a tx to the block */
     void AddToBlock(CTxMemPool::txiter iter);
+    /** Add the coinbase transaction and the header to the block template, and check the block's validity */
+    std::unique_ptr<CBlockTemplate> FinishBlock(std::unique_ptr<CBlockTemplate> block_template, const CScript& coinbase_output_script, bool test_block_validity) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     // Methods for how to add transactions to a block.
     /** Add transactions based on feerate including unconfirmed ancestors
@@ -204,7 +250,7 @@ private:
       *
       * @pre BlockAssembler::m_mempool must not be nullptr
     */
-    void addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated) EXCLUSIVE_LOCKS_REQUIRED(!m_mempool->cs);
+    void addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated) EXCLUSIVE_LOCKS_REQUIRED(m_mempool->cs);
 
     // helper functions for addPackageTxs()
     /** Remove confirmed (inBlock) entries from given set */
@@ -220,6 +266,84 @@ private:
     void SortForBlock(const CTxMemPool::setEntries& package, std::vector<CTxMemPool::txiter>& sortedEntries);
 };
 
+/**
+ * Block template that is kept up to date with the mempool.
+ *
+ * The selected transactions are kept between requests for a template, and
+ * updated from the mempool notifications: transactions that pay a lower fee
+ * rate than everything selected are appended if they fit, and removals of
+ * transactions that were not selected are ignored. Any other change (a new
+ * tip, a removed selected transaction, a better paying transaction, or a
+ * change to the mempool that was not notified, like a prioritisation) makes
+ * the next request select the transactions again.
+ *
+ * The validity of the kept template is checked by a background thread, so a
+ * template is handed out without waiting for TestBlockValidity(). The check
+ * is skipped when the template is outdated by a block that is about to be
+ * connected, so it does not delay connecting it. If a check fails, the
+ * template is dropped and the next one is checked before it is handed out.
+ */
+class BlockTemplateCache final : public CValidationInterface
+{
+public:
+    //! Number of changes to the mempool to remember between requests before giving up on the template.
+    static constexpr size_t MAX_PENDING_CHANGES{10'000};
+
+    BlockTemplateCache(ChainstateManager& chainman, const CTxMemPool& mempool);
+    ~BlockTemplateCache();
+
+    /** Get a block template on top of the current tip, updating the kept one if possible */
+    std::unique_ptr<CBlockTemplate> Get(const BlockAssembler::Options& options) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait for the pending validity check to finish, and return whether the kept template passed it */
+    bool WaitForValidation() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Number of transactions whose spent coins are read into the coins cache
+    //! per cs_main acquisition before a template's validity check.
+    static constexpr size_t PREFETCH_BATCH_TXS{100};
+
+protected:
+    void TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence) override EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    /** Apply the pending changes to the kept template, returns false if it must be rebuilt */
+    bool Update(const BlockAssembler::Options& options) EXCLUSIVE_LOCKS_REQUIRED(::cs_main, m_mutex);
+    /** Check the validity of the templates queued by Get() */
+    void ThreadValidate() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    ChainstateManager& m_chainman;
+    const CTxMemPool& m_mempool;
+
+    Mutex m_mutex;
+    std::condition_variable m_validation_cv;
+    std::optional<BlockAssembler> m_assembler GUARDED_BY(m_mutex);
+    //! Incremented whenever the transactions of the kept template change.
+    uint64_t m_generation GUARDED_BY(m_mutex){0};
+    //! Whether the validity of the kept template was checked since transactions were added to it,
+    //! shared with the templates handed out for it.
+    std::shared_ptr<std::atomic_bool> m_validated GUARDED_BY(m_mutex){std::make_shared<std::atomic_bool>(false)};
+    //! Whether the validity of the kept template must be checked before handing it out.
+    bool m_validate_before_handout GUARDED_BY(m_mutex){false};
+    //! Template waiting for its validity check, with the generation it belongs to.
+    std::shared_ptr<const CBlock> m_validation_queued GUARDED_BY(m_mutex);
+    uint64_t m_validation_generation GUARDED_BY(m_mutex){0};
+    std::shared_ptr<std::atomic_bool> m_validation_result GUARDED_BY(m_mutex);
+    bool m_validating GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    //! Mempool sequence number and update counter when the transactions were selected.
+    uint64_t m_mempool_sequence GUARDED_BY(m_mutex){0};
+    unsigned int m_transactions_updated GUARDED_BY(m_mutex){0};
+    //! Number of mempool changes notified since the transactions were selected.
+    uint64_t m_num_changes GUARDED_BY(m_mutex){0};
+    //! Notified changes not applied to the template yet.
+    std::vector<Txid> m_added GUARDED_BY(m_mutex);
+    std::vector<Txid> m_removed GUARDED_BY(m_mutex);
+
+    //! Only started once a template is requested with a deferred validity check.
+    std::thread m_validation_thread GUARDED_BY(m_mutex);
+};
+
 /**
  * Get the minimum time a miner should use in the next block. This always
  * accounts for the BIP94 timewarp rule, so does not necessarily reflect the
@@ -245,6 +369,7 @@ void AddMerkleRootAndCoinbase(CBlock& block, CTransactionRef coinbase, uint32_t
 std::unique_ptr<CBlockTemplate> WaitAndCreateNewBlock(ChainstateManager& chainman,
                                                       KernelNotifications& kernel_notifications,
                                                       CTxMemPool* mempool,
+                                                      BlockTemplateCache* block_template_cache,
                                                       const std::unique_ptr<CBlockTemplate>& block_template,
                                                       const BlockWaitOptions& options,
                                                       const BlockAssembler::Options& assemble_options);
@@ -132,6 +132,36 @@ MiniMiner::MiniMiner(const CTxMemPool& mempool, const std::vector<COutPoint>& ou
     SanityCheck();
 }
 
+std::optional<MiniMinerCluster> GetMiniMinerCluster(const CTxMemPool& mempool, const Txid& txid)
+{
+    AssertLockHeld(mempool.cs);
+    const auto cluster{mempool.GatherClusters({txid.ToUint256()})};
+    // An empty cluster means that the transaction is missing from the mempool or DoS limit was hit.
+    if (cluster.empty()) return std::nullopt;
+
+    MiniMinerCluster result;
+    result.entries.reserve(cluster.size());
+    for (const auto& txiter : cluster) {
+        const CTransaction& tx{txiter->GetTx()};
+        result.entries.emplace_back(/*tx_in=*/txiter->GetSharedTx(),
+                                    /*vsize_self=*/txiter->GetTxSize(),
+                                    /*vsize_ancestor=*/txiter->GetSizeWithAncestors(),
+                                    /*fee_self=*/txiter->GetModifiedFee(),
+                                    /*fee_ancestor=*/txiter->GetModFeesWithAncestors());
+        CTxMemPool::setEntries descendants;
+        mempool.CalculateDescendants(txiter, descendants);
+        auto& descendant_txids{result.descendants[tx.GetHash()]};
+        for (const auto& desc_txiter : descendants) {
+            descendant_txids.insert(desc_txiter->GetTx().GetHash());
+        }
+        // The parents of a mempool transaction are part of its cluster.
+        for (const auto& input : tx.vin) {
+            if (mempool.exists(input.prevout.hash)) result.spenders.emplace(input.prevout, tx.GetHash());
+        }
+    }
+    return result;
+}
+
 MiniMiner::MiniMiner(const std::vector<MiniMinerMempoolEntry>& manual_entries,
                      const std::map<Txid, std::set<Txid>>& descendant_caches)
 {
@@ -174,6 +204,75 @@ MiniMiner::MiniMiner(const std::vector<MiniMinerMempoolEntry>& manual_entries,
     SanityCheck();
 }
 
+MiniMiner::MiniMiner(const std::vector<const MiniMinerCluster*>& clusters, const std::vector<COutPoint>& outpoints)
+{
+    std::map<uint256, const MiniMinerCluster*> cluster_by_txid;
+    for (const auto* cluster : clusters) {
+        for (const auto& [txid, _] : cluster->descendants) {
+            cluster_by_txid.emplace(txid, cluster);
+        }
+    }
+
+    // Find which outpoints to calculate bump fees for, like the mempool constructor does.
+    for (const auto& outpoint : outpoints) {
+        const auto cluster_it{cluster_by_txid.find(outpoint.hash)};
+        if (cluster_it == cluster_by_txid.end()) {
+            m_bump_fees.emplace(outpoint, 0);
+            continue;
+        }
+        m_requested_outpoints_by_txid[outpoint.hash].push_back(outpoint);
+
+        // The transaction spending this outpoint and its descendants are to-be-replaced.
+        const MiniMinerCluster& cluster{*cluster_it->second};
+        if (const auto spender_it{cluster.spenders.find(outpoint)}; spender_it != cluster.spenders.end()) {
+            for (const auto& desc_txid : cluster.descendants.at(spender_it->second)) {
+                m_to_be_replaced.insert(desc_txid);
+            }
+        }
+    }
+
+    // Only the clusters of the requested outpoints are needed.
+    std::set<const MiniMinerCluster*> needed_clusters;
+    for (const auto& [txid, _] : m_requested_outpoints_by_txid) {
+        needed_clusters.insert(cluster_by_txid.at(txid));
+    }
+
+    // Add every entry to m_entries_by_txid and m_entries, except the ones that will be replaced.
+    for (const auto* cluster : needed_clusters) {
+        for (const auto& entry : cluster->entries) {
+            const auto& txid{entry.GetTx().GetHash()};
+            if (!m_to_be_replaced.count(txid)) {
+                auto [mapiter, success] = m_entries_by_txid.emplace(txid, entry);
+                if (Assume(success)) m_entries.push_back(mapiter);
+            } else if (auto outpoints_it{m_requested_outpoints_by_txid.find(txid)}; outpoints_it != m_requested_outpoints_by_txid.end()) {
+                // Spending the output of a to-be-replaced transaction is impossible, see the mempool
+                // constructor.
+                for (const auto& outpoint : outpoints_it->second) {
+                    m_bump_fees.emplace(outpoint, 0);
+                }
+                m_requested_outpoints_by_txid.erase(outpoints_it);
+            }
+        }
+    }
+
+    // Build the m_descendant_set_by_txid cache.
+    for (const auto* cluster : needed_clusters) {
+        for (const auto& [txid, desc_txids] : cluster->descendants) {
+            if (m_to_be_replaced.count(txid)) continue;
+            std::vector<MockEntryMap::iterator> cached_descendants;
+            for (const auto& desc_txid : desc_txids) {
+                if (auto desc_it{m_entries_by_txid.find(desc_txid)}; desc_it != m_entries_by_txid.end()) {
+                    cached_descendants.push_back(desc_it);
+                }
+            }
+            m_descendant_set_by_txid.emplace(txid, std::move(cached_descendants));
+        }
+    }
+
+    Assume(m_requested_outpoints_by_txid.size() <= outpoints.size());
+    SanityCheck();
+}
+
 // Compare by min(ancestor feerate, individual feerate), then txid
 //
 // Under the ancestor-based mining approach, high-feerate children can pay for parents, but high-feerate
@@ -245,10 +344,8 @@ void MiniMiner::SanityCheck() const
         [&](const auto& txid){return m_entries_by_txid.find(txid) == m_entries_by_txid.end();}));
 }
 
-void MiniMiner::BuildMockTemplate(std::optional<CFeeRate> target_feerate)
+void MiniMiner::SelectPackages(std::optional<CFeeRate> target_feerate)
 {
-    const auto num_txns{m_entries_by_txid.size()};
-    uint32_t sequence_num{0};
     while (!m_entries_by_txid.empty()) {
         // Sort again, since transaction removal may change some m_entries' ancestor feerates.
         std::sort(m_entries.begin(), m_entries.end(), AncestorFeerateComparator());
@@ -286,48 +383,38 @@ void MiniMiner::BuildMockTemplate(std::optional<CFeeRate> target_feerate)
         }
         // Track the order in which transactions were selected.
         for (const auto& ancestor : ancestors) {
-            m_inclusion_order.emplace(Txid::FromUint256(ancestor->first), sequence_num);
+            m_inclusion_order.emplace(Txid::FromUint256(ancestor->first), m_sequence_num);
         }
         DeleteAncestorPackage(ancestors);
         SanityCheck();
-        ++sequence_num;
+        ++m_sequence_num;
     }
+}
+
+void MiniMiner::BuildMockTemplate(std::optional<CFeeRate> target_feerate)
+{
+    const auto num_txns{m_entries_by_txid.size()};
+    SelectPackages(target_feerate);
     if (!target_feerate.has_value()) {
         Assume(m_in_block.size() == num_txns);
     } else {
         Assume(m_in_block.empty() || m_total_fees >= target_feerate->GetFee(m_total_vsize));
     }
-    Assume(m_in_block.empty() || sequence_num > 0);
+    Assume(m_in_block.empty() || m_sequence_num > 0);
     Assume(m_in_block.size() == m_inclusion_order.size());
     // Do not try to continue building the block template with a different feerate.
     m_ready_to_calculate = false;
 }
 
-
 std::map<Txid, uint32_t> MiniMiner::Linearize()
 {
     BuildMockTemplate(std::nullopt);
     return m_inclusion_order;
 }
 
-std::map<COutPoint, CAmount> MiniMiner::CalculateBumpFees(const CFeeRate& target_feerate)
+std::map<COutPoint, CAmount> MiniMiner::GetBumpFees(const CFeeRate& target_feerate) const
 {
-    if (!m_ready_to_calculate) return {};
-    // Build a block template until the target feerate is hit.
-    BuildMockTemplate(target_feerate);
-
-    // Each transaction that "made it into the block" has a bumpfee of 0, i.e. they are part of an
-    // ancestor package with at least the target feerate and don't need to be bumped.
-    for (const auto& txid : m_in_block) {
-        // Not all of the block transactions were necessarily requested.
-        auto it = m_requested_outpoints_by_txid.find(txid);
-        if (it != m_requested_outpoints_by_txid.end()) {
-            for (const auto& outpoint : it->second) {
-                m_bump_fees.emplace(outpoint, 0);
-            }
-            m_requested_outpoints_by_txid.erase(it);
-        }
-    }
+    std::map<COutPoint, CAmount> bump_fees{m_bump_fees};
 
     // A transactions and its ancestors will only be picked into a block when
     // both the ancestor set feerate and the individual feerate meet the target
@@ -374,6 +461,14 @@ std::map<COutPoint, CAmount> MiniMiner::CalculateBumpFees(const CFeeRate& target
     // By picking the maximum from the two, we ensure that a transaction meets
     // both criteria.
     for (const auto& [txid, outpoints] : m_requested_outpoints_by_txid) {
+        // Each transaction that "made it into the block" has a bumpfee of 0, i.e. they are part of
+        // an ancestor package with at least the target feerate and don't need to be bumped.
+        if (m_in_block.count(txid)) {
+            for (const auto& outpoint : outpoints) {
+                bump_fees.emplace(outpoint, 0);
+            }
+            continue;
+        }
         auto it = m_entries_by_txid.find(txid);
         Assume(it != m_entries_by_txid.end());
         if (it != m_entries_by_txid.end()) {
@@ -383,11 +478,40 @@ std::map<COutPoint, CAmount> MiniMiner::CalculateBumpFees(const CFeeRate& target
             const CAmount bump_fee{std::max(bump_fee_with_ancestors, bump_fee_individual)};
             Assume(bump_fee >= 0);
             for (const auto& outpoint : outpoints) {
-                m_bump_fees.emplace(outpoint, bump_fee);
+                bump_fees.emplace(outpoint, bump_fee);
             }
         }
     }
-    return m_bump_fees;
+    return bump_fees;
+}
+
+std::map<COutPoint, CAmount> MiniMiner::CalculateBumpFees(const CFeeRate& target_feerate)
+{
+    if (!m_ready_to_calculate) return {};
+    // Build a block template until the target feerate is hit.
+    BuildMockTemplate(target_feerate);
+    return GetBumpFees(target_feerate);
+}
+
+std::vector<std::map<COutPoint, CAmount>> MiniMiner::CalculateBumpFees(std::span<const CFeeRate> target_feerates)
+{
+    if (!m_ready_to_calculate) return {};
+    // The transactions are selected in the same order whatever the target feerate is, a lower one
+    // only lets the block template grow further. So build it once, stopping at each target feerate
+    // from the highest to the lowest one to calculate its bump fees.
+    std::vector<size_t> order(target_feerates.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return target_feerates[a] > target_feerates[b]; });
+
+    std::vector<std::map<COutPoint, CAmount>> bump_fees(target_feerates.size());
+    for (const size_t i : order) {
+        SelectPackages(target_feerates[i]);
+        bump_fees[i] = GetBumpFees(target_feerates[i]);
+    }
+    Assume(m_in_block.size() == m_inclusion_order.size());
+    // Do not try to continue building the block template with a different feerate.
+    m_ready_to_calculate = false;
+    return bump_fees;
 }
 
 std::optional<CAmount> MiniMiner::CalculateTotalBumpFees(const CFeeRate& target_feerate)
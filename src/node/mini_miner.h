@@ -14,6 +14,7 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <vector>
 
 class CFeeRate;
@@ -57,6 +58,22 @@ public:
     }
 };
 
+/** The mempool data MiniMiner needs about a cluster of transactions, copied out of the mempool so
+ * that it can be kept and reused for as long as the cluster does not change. */
+struct MiniMinerCluster
+{
+    std::vector<MiniMinerMempoolEntry> entries;
+    //! Descendant set of each transaction, including itself.
+    std::map<Txid, std::set<Txid>> descendants;
+    //! Outpoints of the transactions that are spent by other transactions of the cluster.
+    std::map<COutPoint, Txid> spenders;
+};
+
+/** Copy the cluster of a mempool transaction out of the mempool. Must be called while holding
+ * mempool.cs. Returns std::nullopt if the transaction is not in the mempool or its cluster is too
+ * large. */
+std::optional<MiniMinerCluster> GetMiniMinerCluster(const CTxMemPool& mempool, const Txid& txid);
+
 // Comparator needed for std::set<MockEntryMap::iterator>
 struct IteratorComparator
 {
@@ -103,6 +120,7 @@ class MiniMiner
     // Information on the current status of the block
     CAmount m_total_fees{0};
     int32_t m_total_vsize{0};
+    uint32_t m_sequence_num{0};
 
     /** Main data structure holding the entries, can be indexed by txid */
     std::map<uint256, MiniMinerMempoolEntry> m_entries_by_txid;
@@ -120,6 +138,14 @@ class MiniMiner
     /** Perform some checks. */
     void SanityCheck() const;
 
+    /** Continue building the block template until the target feerate is hit, or until all
+     * transactions have been selected if target_feerate is not given. */
+    void SelectPackages(std::optional<CFeeRate> target_feerate);
+
+    /** Bump fees of the requested outpoints once the block template was built up to the target
+     * feerate. */
+    std::map<COutPoint, CAmount> GetBumpFees(const CFeeRate& target_feerate) const;
+
 public:
     /** Returns true if CalculateBumpFees may be called, false if not. */
     bool IsReadyToCalculate() const { return m_ready_to_calculate; }
@@ -150,12 +176,24 @@ public:
     MiniMiner(const std::vector<MiniMinerMempoolEntry>& manual_entries,
               const std::map<Txid, std::set<Txid>>& descendant_caches);
 
+    /** Constructor that takes copies of the clusters of the transactions in the mempool that the
+     * outpoints belong to, see GetMiniMinerCluster(). Outpoints of transactions that are not in any
+     * of the clusters are treated like outpoints of transactions that are not in the mempool.
+     */
+    MiniMiner(const std::vector<const MiniMinerCluster*>& clusters, const std::vector<COutPoint>& outpoints);
+
     /** Construct a new block template and, for each outpoint corresponding to a transaction that
      * did not make it into the block, calculate the cost of bumping those transactions (and their
      * ancestors) to the minimum feerate. Returns a map from outpoint to bump fee, or an empty map
      * if they cannot be calculated. */
     std::map<COutPoint, CAmount> CalculateBumpFees(const CFeeRate& target_feerate);
 
+    /** Like CalculateBumpFees(), for several target feerates at once. The block template is only
+     * constructed once, and the bump fees for each target feerate are calculated as it is reached.
+     * Returns the bump fees in the order of the target feerates, or an empty vector if they cannot
+     * be calculated. */
+    std::vector<std::map<COutPoint, CAmount>> CalculateBumpFees(std::span<const CFeeRate> target_feerates);
+
     /** Construct a new block template and, calculate the cost of bumping all transactions that did
      * not make it into the block to the target feerate. Returns the total bump fee, or std::nullopt
      * if it cannot be calculated. */
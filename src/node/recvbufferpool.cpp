@@ -0,0 +1,38 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/recvbufferpool.h>
+
+#include <utility>
+
+namespace node {
+SerializeData RecvBufferPool::Get(size_t size)
+{
+    if (size < MIN_POOLED_CAPACITY) return {};
+    LOCK(m_mutex);
+    const auto it{m_buffers.lower_bound(size)};
+    // Don't hand out buffers more than twice as large as needed, they are
+    // better kept for larger messages.
+    if (it == m_buffers.end() || it->first / 2 > size) return {};
+    m_usage -= it->first;
+    return std::move(m_buffers.extract(it).mapped());
+}
+
+void RecvBufferPool::Put(SerializeData&& buffer)
+{
+    const size_t capacity{buffer.capacity()};
+    if (capacity < MIN_POOLED_CAPACITY) return;
+    buffer.clear();
+    LOCK(m_mutex);
+    if (m_usage + capacity > m_max_usage) return;
+    m_buffers.emplace(capacity, std::move(buffer));
+    m_usage += capacity;
+}
+
+size_t RecvBufferPool::GetUsage() const
+{
+    LOCK(m_mutex);
+    return m_usage;
+}
+} // namespace node
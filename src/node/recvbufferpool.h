@@ -0,0 +1,56 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_RECVBUFFERPOOL_H
+#define BITCOIN_NODE_RECVBUFFERPOOL_H
+
+#include <support/allocators/zeroafterfree.h>
+#include <sync.h>
+
+#include <cstddef>
+#include <map>
+
+namespace node {
+/**
+ * Pool of buffers that received message payloads are read into, shared by
+ * the transports of all peers.
+ *
+ * A buffer is taken from the pool when the size of a message is known, and
+ * returned when the message has been processed, so that bursts of large
+ * messages (e.g. blocks arriving from several peers) reuse the same storage
+ * instead of allocating and freeing it for every message. Small buffers are
+ * not pooled, and the pool keeps at most max_usage bytes of idle storage.
+ */
+class RecvBufferPool
+{
+public:
+    //! Buffers with less capacity are left to the allocator.
+    static constexpr size_t MIN_POOLED_CAPACITY{4096};
+
+    explicit RecvBufferPool(size_t max_usage) : m_max_usage{max_usage} {}
+
+    /**
+     * Take an empty buffer with a capacity of at least `size` bytes, but not
+     * much more, out of the pool. Returns a buffer without capacity if there
+     * is no such buffer, or if `size` is too small to be pooled.
+     */
+    SerializeData Get(size_t size) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return a buffer to the pool, or free it if it is not worth keeping. */
+    void Put(SerializeData&& buffer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Capacity of the idle buffers in the pool, in bytes.
+    size_t GetUsage() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const size_t m_max_usage;
+
+    mutable Mutex m_mutex;
+    //! Idle buffers, by capacity.
+    std::multimap<size_t, SerializeData> m_buffers GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_RECVBUFFERPOOL_H
@@ -169,6 +169,15 @@ void TxDownloadManagerImpl::DisconnectedPeer(NodeId nodeid)
 
 bool TxDownloadManagerImpl::AddTxAnnouncement(NodeId peer, const GenTxid& gtxid, std::chrono::microseconds now)
 {
+    // Most transactions are announced by many peers. After the first announcement, the transaction is being downloaded,
+    // which by the lock invariants means that it is not in the orphanage, nor in any of the recent rejects or confirmed
+    // filters. It is forgotten when it enters the mempool through us. So the checks below can be skipped, and the
+    // announcement only has to be added to m_txrequest.
+    if (m_txrequest.HaveTxHash(gtxid.ToUint256())) {
+        AddToTxRequest(peer, gtxid, now);
+        return false;
+    }
+
     // If this is an orphan we are trying to resolve, consider this peer as a orphan resolution candidate instead.
     // - is wtxid matching something in orphanage
     // - exists in orphanage
@@ -199,12 +208,18 @@ bool TxDownloadManagerImpl::AddTxAnnouncement(NodeId peer, const GenTxid& gtxid,
     // If this is an inv received from a peer and we already have it, we can drop it.
     if (AlreadyHaveTx(gtxid, /*include_reconsiderable=*/true)) return true;
 
+    AddToTxRequest(peer, gtxid, now);
+    return false;
+}
+
+void TxDownloadManagerImpl::AddToTxRequest(NodeId peer, const GenTxid& gtxid, std::chrono::microseconds now)
+{
     auto it = m_peer_info.find(peer);
-    if (it == m_peer_info.end()) return false;
+    if (it == m_peer_info.end()) return;
     const auto& info = it->second.m_connection_info;
     if (!info.m_relay_permissions && m_txrequest.Count(peer) >= MAX_PEER_TX_ANNOUNCEMENTS) {
         // Too many queued announcements for this peer
-        return false;
+        return;
     }
     // Decide the TxRequestTracker parameters for this announcement:
     // - "preferred": if fPreferredDownload is set (= outbound, or NetPermissionFlags::NoBan permission)
@@ -220,8 +235,6 @@ bool TxDownloadManagerImpl::AddTxAnnouncement(NodeId peer, const GenTxid& gtxid,
     if (overloaded) delay += OVERLOADED_PEER_TX_DELAY;
 
     m_txrequest.ReceivedInv(peer, gtxid, info.m_preferred, now + delay);
-
-    return false;
 }
 
 bool TxDownloadManagerImpl::MaybeAddOrphanResolutionCandidate(const std::vector<Txid>& unique_parents, const Wtxid& wtxid, NodeId nodeid, std::chrono::microseconds now)
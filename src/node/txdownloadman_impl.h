@@ -199,6 +199,9 @@ protected:
      * @returns whether this transaction was a valid orphan resolution candidate.
      * */
     bool MaybeAddOrphanResolutionCandidate(const std::vector<Txid>& unique_parents, const Wtxid& wtxid, NodeId nodeid, std::chrono::microseconds now);
+
+    /** Add an announcement of a transaction we do not have to m_txrequest, unless the peer has too many queued. */
+    void AddToTxRequest(NodeId peer, const GenTxid& gtxid, std::chrono::microseconds now);
 };
 } // namespace node
 #endif // BITCOIN_NODE_TXDOWNLOADMAN_IMPL_H
@@ -5,9 +5,15 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
 #include <util/check.h>
+#include <util/hasher.h>
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <variant>
 
@@ -18,6 +24,22 @@ namespace {
 const std::string RECON_STATIC_SALT = "Tx Relay Salting";
 const HashWriter RECON_SALT_HASHER = TaggedHash(RECON_STATIC_SALT);
 
+/**
+ * Maximum number of transactions whose fanout peers are remembered. Transactions are usually
+ * announced to all peers within a few trickle intervals, so this covers many of them.
+ */
+constexpr size_t MAX_FANOUT_CACHE_SIZE{10'000};
+
+/** Fixed-point precision of the q coefficient sent in reqrecon messages, see BIP-330. */
+constexpr double Q_PRECISION{(2 << 14) - 1};
+/**
+ * Initial estimate of q, the coefficient of the expected set difference that is not explained by
+ * the difference in set sizes. It is refined after every successful reconciliation.
+ */
+constexpr double RECON_Q{0.25};
+/** Size of a serialized sketch element. */
+constexpr size_t SKETCH_ELEMENT_SIZE{4};
+
 /**
  * Salt (specified by BIP-330) constructed from contributions from both peers. It is used
  * to compute transaction short IDs, which are then used to construct a sketch representing a set
@@ -29,6 +51,15 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/** Where a peer is in the reconciliation round, see TxReconciliationTracker. */
+enum class ReconciliationPhase {
+    NONE,
+    /** Initiator: sent reqrecon, waiting for the sketch. */
+    INIT_REQUESTED,
+    /** Responder: sent the sketch, waiting for reconcildiff. */
+    INIT_RESPONDED,
+};
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +67,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,16 +75,67 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to reconcile with the peer in the next round, by short ID. */
+    std::unordered_map<uint32_t, Wtxid> m_local_set;
+
+    /** Responder: the set put aside while the initiator computes the difference. */
+    std::unordered_map<uint32_t, Wtxid> m_local_set_snapshot;
+
+    ReconciliationPhase m_phase{ReconciliationPhase::NONE};
+
+    /** When we entered the current phase, if it is not NONE. */
+    std::chrono::microseconds m_phase_start{0};
+
+    /** Initiator: when to request the next reconciliation. */
+    std::chrono::microseconds m_next_request_time{0};
+
+    /** Initiator: current estimate of q, see RECON_Q. */
+    double m_q{RECON_Q};
+
+    /** Initiator: set size the peer reported when we last asked it for a sketch. */
+    uint16_t m_remote_set_size{0};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Short ID of a transaction, see BIP-330. */
+    uint32_t ComputeShortID(const Wtxid& wtxid) const
+    {
+        const uint64_t s{SipHashUint256(m_k0, m_k1, wtxid.ToUint256())};
+        return 1 + static_cast<uint32_t>(s % 0xFFFFFFFF);
+    }
 };
 
+/**
+ * Capacity of a sketch that can decode the difference between sets of the given sizes with high
+ * probability, see BIP-330.
+ */
+size_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, double q)
+{
+    const size_t set_size_diff{local_set_size > remote_set_size ? local_set_size - remote_set_size : remote_set_size - local_set_size};
+    const size_t min_size{std::min(local_set_size, remote_set_size)};
+    const size_t estimated_diff{1 + set_size_diff + static_cast<size_t>(q * min_size)};
+    return Minisketch::ComputeCapacity(/*bits=*/32, estimated_diff, /*fpbits=*/16);
+}
+
+Minisketch ComputeSketch(const std::unordered_map<uint32_t, Wtxid>& set, size_t capacity)
+{
+    Minisketch sketch{node::MakeMinisketch32(capacity)};
+    for (const auto& [short_id, _] : set) sketch.Add(short_id);
+    return sketch;
+}
+
+std::vector<Wtxid> AllTransactions(const std::unordered_map<uint32_t, Wtxid>& set)
+{
+    std::vector<Wtxid> result;
+    result.reserve(set.size());
+    for (const auto& [_, wtxid] : set) result.push_back(wtxid);
+    return result;
+}
+
 } // namespace
 
 /** Actual implementation for TxReconciliationTracker's data structure. */
@@ -76,6 +155,53 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Salt of the pseudorandom selection of fanout peers. */
+    const uint64_t m_fanout_k0{FastRandomContext().rand64()}, m_fanout_k1{FastRandomContext().rand64()};
+
+    /**
+     * The reconciling peers (of both directions) a transaction is flooded to, sorted, so that the
+     * selection is made once per transaction rather than once per peer it is announced to. Cleared
+     * whenever the set of registered peers changes, or it grows too large.
+     */
+    std::unordered_map<Wtxid, std::vector<NodeId>, SaltedTxidHasher> m_fanout_cache GUARDED_BY(m_txreconciliation_mutex);
+
+    TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    /** Select the reconciling peers a transaction is flooded to, in O(peers). */
+    std::vector<NodeId> SelectFanoutPeers(const Wtxid& wtxid) const EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        // Rank the reconciling peers in the same direction by a salted hash of the transaction
+        // and the peer, so every transaction gets flooded to a different subset of them.
+        std::vector<std::pair<uint64_t, NodeId>> outbound, inbound;
+        for (const auto& [id, state] : m_states) {
+            const auto* recon_state{std::get_if<TxReconciliationState>(&state)};
+            if (!recon_state) continue;
+            const uint64_t rank_key{SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid.ToUint256(), static_cast<uint32_t>(id))};
+            (recon_state->m_we_initiate ? outbound : inbound).emplace_back(rank_key, id);
+        }
+
+        // Round the fractional number of inbound destinations up or down pseudorandomly, so that
+        // the fraction holds on average even with few inbound peers.
+        const double inbound_fanout{inbound.size() * INBOUND_FANOUT_DESTINATIONS_FRACTION};
+        size_t inbound_destinations{static_cast<size_t>(inbound_fanout)};
+        const uint64_t round_key{SipHashUint256(m_fanout_k0, m_fanout_k1, wtxid.ToUint256())};
+        if ((round_key >> 11) * 0x1.0p-53 < inbound_fanout - inbound_destinations) ++inbound_destinations;
+
+        std::vector<NodeId> selected;
+        for (auto [ranked, destinations] : {std::pair{&outbound, OUTBOUND_FANOUT_DESTINATIONS}, std::pair{&inbound, inbound_destinations}}) {
+            destinations = std::min(destinations, ranked->size());
+            std::nth_element(ranked->begin(), ranked->begin() + destinations, ranked->end());
+            for (size_t i{0}; i < destinations; ++i) selected.push_back((*ranked)[i].second);
+        }
+        std::ranges::sort(selected);
+        return selected;
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -122,6 +248,7 @@ public:
 
         const uint256 full_salt{ComputeSalt(local_salt, remote_salt)};
         recon_state->second = TxReconciliationState(!is_peer_inbound, full_salt.GetUint64(0), full_salt.GetUint64(1));
+        m_fanout_cache.clear();
         return ReconciliationRegisterResult::SUCCESS;
     }
 
@@ -130,6 +257,7 @@ public:
         AssertLockNotHeld(m_txreconciliation_mutex);
         LOCK(m_txreconciliation_mutex);
         if (m_states.erase(peer_id)) {
+            m_fanout_cache.clear();
             LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Forget txreconciliation state of peer=%d\n", peer_id);
         }
     }
@@ -142,6 +270,158 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        if (!GetRegisteredPeerState(peer_id)) return true;
+
+        auto it{m_fanout_cache.find(wtxid)};
+        if (it == m_fanout_cache.end()) {
+            if (m_fanout_cache.size() >= MAX_FANOUT_CACHE_SIZE) m_fanout_cache.clear();
+            it = m_fanout_cache.emplace(wtxid, SelectFanoutPeers(wtxid)).first;
+        }
+        return std::ranges::binary_search(it->second, peer_id);
+    }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_local_set.size() >= MAX_RECONSET_SIZE) return false;
+        peer_state->m_local_set.emplace(peer_state->ComputeShortID(wtxid), wtxid);
+        return true;
+    }
+
+    std::optional<std::pair<uint16_t, uint16_t>> MaybeRequestReconciliation(NodeId peer_id, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || !peer_state->m_we_initiate) return std::nullopt;
+        if (peer_state->m_phase != ReconciliationPhase::NONE || peer_state->m_next_request_time > now) return std::nullopt;
+
+        peer_state->m_phase = ReconciliationPhase::INIT_REQUESTED;
+        peer_state->m_phase_start = now;
+        peer_state->m_next_request_time = now + RECON_REQUEST_INTERVAL;
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request reconciliation from peer=%d (set size %d)\n",
+                      peer_id, peer_state->m_local_set.size());
+        return std::make_pair(static_cast<uint16_t>(peer_state->m_local_set.size()),
+                              static_cast<uint16_t>(peer_state->m_q * Q_PRECISION));
+    }
+
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_we_initiate || peer_state->m_phase != ReconciliationPhase::NONE) return std::nullopt;
+
+        peer_state->m_local_set_snapshot = std::move(peer_state->m_local_set);
+        peer_state->m_local_set.clear();
+        peer_state->m_phase = ReconciliationPhase::INIT_RESPONDED;
+        peer_state->m_phase_start = now;
+
+        const double q{peer_q / Q_PRECISION};
+        const size_t capacity{EstimateSketchCapacity(peer_state->m_local_set_snapshot.size(), peer_set_size, q)};
+        if (capacity > MAX_SKETCH_CAPACITY) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Difference with peer=%d too large to reconcile\n", peer_id);
+            return std::vector<uint8_t>{};
+        }
+        return ComputeSketch(peer_state->m_local_set_snapshot, capacity).Serialize();
+    }
+
+    std::optional<ReconciliationResult> HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || !peer_state->m_we_initiate || peer_state->m_phase != ReconciliationPhase::INIT_REQUESTED) return std::nullopt;
+        if (skdata.size() % SKETCH_ELEMENT_SIZE != 0 || skdata.size() / SKETCH_ELEMENT_SIZE > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        // Whatever the outcome, the peer learns about all of our set in this round.
+        const auto local_set{std::move(peer_state->m_local_set)};
+        peer_state->m_local_set.clear();
+        peer_state->m_phase = ReconciliationPhase::NONE;
+
+        ReconciliationResult result;
+        const size_t capacity{skdata.size() / SKETCH_ELEMENT_SIZE};
+        if (capacity > 0) {
+            Minisketch sketch{node::MakeMinisketch32(capacity)};
+            sketch.Deserialize(skdata);
+            sketch.Merge(ComputeSketch(local_set, capacity));
+            std::vector<uint64_t> differences(capacity);
+            result.success = sketch.Decode(differences);
+            if (result.success) {
+                for (const uint64_t short_id : differences) {
+                    if (auto it{local_set.find(static_cast<uint32_t>(short_id))}; it != local_set.end()) {
+                        result.announce.push_back(it->second);
+                    } else {
+                        result.ask_shortids.push_back(static_cast<uint32_t>(short_id));
+                    }
+                }
+                // Refine q from the part of the difference that the set sizes do not explain.
+                const size_t remote_set_size{local_set.size() - result.announce.size() + result.ask_shortids.size()};
+                const size_t min_size{std::min(local_set.size(), remote_set_size)};
+                if (min_size > 0) {
+                    const size_t size_diff{local_set.size() > remote_set_size ? local_set.size() - remote_set_size : remote_set_size - local_set.size()};
+                    peer_state->m_q = std::clamp((double(differences.size()) - double(size_diff)) / min_size, 0.0, 2.0 - 1.0 / Q_PRECISION);
+                }
+            }
+        }
+        if (!result.success) result.announce = AllTransactions(local_set);
+
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug,
+                      "Reconciliation with peer=%d %s: announcing %d, requesting %d\n", peer_id,
+                      result.success ? "succeeded" : "failed", result.announce.size(), result.ask_shortids.size());
+        return result;
+    }
+
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_we_initiate || peer_state->m_phase != ReconciliationPhase::INIT_RESPONDED) return std::nullopt;
+
+        const auto snapshot{std::move(peer_state->m_local_set_snapshot)};
+        peer_state->m_local_set_snapshot.clear();
+        peer_state->m_phase = ReconciliationPhase::NONE;
+
+        if (!success) return AllTransactions(snapshot);
+        std::vector<Wtxid> result;
+        for (const uint32_t short_id : ask_shortids) {
+            if (auto it{snapshot.find(short_id)}; it != snapshot.end()) result.push_back(it->second);
+        }
+        return result;
+    }
+
+    std::vector<Wtxid> MaybeExpireReconciliation(NodeId peer_id, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_phase == ReconciliationPhase::NONE) return {};
+        if (peer_state->m_phase_start + RECON_RESPONSE_TIMEOUT > now) return {};
+
+        // The initiator is waiting for a sketch of the set it advertised, the
+        // responder for the outcome for the set it put aside. Either way, the
+        // peer does not learn about those transactions unless we flood them.
+        auto& stuck_set{peer_state->m_phase == ReconciliationPhase::INIT_REQUESTED ? peer_state->m_local_set : peer_state->m_local_set_snapshot};
+        const auto stuck{std::move(stuck_set)};
+        stuck_set.clear();
+        peer_state->m_phase = ReconciliationPhase::NONE;
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d timed out, announcing %d\n",
+                      peer_id, stuck.size());
+        return AllTransactions(stuck);
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +448,38 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const
+{
+    return m_impl->ShouldFanoutTo(wtxid, peer_id);
+}
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::MaybeRequestReconciliation(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->MaybeRequestReconciliation(peer_id, now);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, peer_set_size, peer_q, now);
+}
+
+std::optional<ReconciliationResult> TxReconciliationTracker::HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata)
+{
+    return m_impl->HandleSketch(peer_id, skdata);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids);
+}
+
+std::vector<Wtxid> TxReconciliationTracker::MaybeExpireReconciliation(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->MaybeExpireReconciliation(peer_id, now);
+}
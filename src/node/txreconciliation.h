@@ -7,12 +7,32 @@
 
 #include <net.h>
 #include <sync.h>
+#include <util/transaction_identifier.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** How often we request a reconciliation from each peer we initiate reconciliations with. */
+static constexpr std::chrono::seconds RECON_REQUEST_INTERVAL{8};
+/** How long we wait for the peer's next message in a reconciliation round, before giving up on
+ *  the round and announcing the transactions it was about. */
+static constexpr std::chrono::seconds RECON_RESPONSE_TIMEOUT{60};
+/** Maximum number of transactions queued for reconciliation with a single peer. Transactions
+ *  that do not fit are announced right away instead. */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+/** Maximum number of elements of a sketch we send or accept. */
+static constexpr uint32_t MAX_SKETCH_CAPACITY{2 << 12};
+/** Number of outbound reconciling peers we still flood each transaction to. */
+static constexpr size_t OUTBOUND_FANOUT_DESTINATIONS{1};
+/** Fraction of inbound reconciling peers we still flood each transaction to. */
+static constexpr double INBOUND_FANOUT_DESTINATIONS_FRACTION{0.1};
 
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
@@ -21,6 +41,16 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** Outcome of a reconciliation round, as seen by its initiator. */
+struct ReconciliationResult {
+    /** Whether the set difference could be computed from the sketches. */
+    bool success{false};
+    /** Short IDs of the transactions only the peer has, to request in a reconcildiff message. */
+    std::vector<uint32_t> ask_shortids;
+    /** Transactions only we have, to announce to the peer. On failure, our whole set. */
+    std::vector<Wtxid> announce;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -84,6 +114,54 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Whether a transaction should still be flooded to the peer rather than reconciled. This is
+     * the case for peers not registered for reconciliation, and for a small, per-transaction
+     * pseudorandom selection of the reconciling peers, so that transactions keep propagating fast.
+     */
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const;
+
+    /**
+     * Step 1. Queue a transaction for the next reconciliation with the peer. Returns false if the
+     * peer is not registered or its set is full, in which case the transaction should be announced
+     * right away.
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Step 2 (initiator). If it is time to reconcile with the peer, returns the size of our set
+     * and the q coefficient to send in a reqrecon message.
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> MaybeRequestReconciliation(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2 (responder). Handle a reqrecon message and return the sketch of our set to send back.
+     * The set is put aside until the initiator tells us the outcome. An empty sketch tells the
+     * initiator that the difference is too large to be reconciled. Returns std::nullopt if the
+     * peer should not have sent the request.
+     */
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q, std::chrono::microseconds now);
+
+    /**
+     * Step 3 (initiator). Handle the sketch sent by the peer in response to our request and compute
+     * the difference between both sets. Returns std::nullopt if the peer should not have sent it.
+     */
+    std::optional<ReconciliationResult> HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata);
+
+    /**
+     * Step 4 (responder). Handle the reconcildiff message finishing the round and return the
+     * transactions to announce to the peer: those it asked for, or all of the set put aside for
+     * the round on failure. Returns std::nullopt if the peer should not have sent it.
+     */
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids);
+
+    /**
+     * If the peer has not answered within RECON_RESPONSE_TIMEOUT of the current step of a round,
+     * give up on the round and return the transactions it was about, to announce to the peer
+     * right away. A message of the abandoned round arriving later is unexpected.
+     */
+    std::vector<Wtxid> MaybeExpireReconciliation(NodeId peer_id, std::chrono::microseconds now);
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
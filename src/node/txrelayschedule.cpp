@@ -0,0 +1,56 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txrelayschedule.h>
+
+#include <util/check.h>
+
+namespace node {
+void TxRelaySchedule::Add(const GenTxid& gtxid)
+{
+    LOCK(m_mutex);
+    if (m_queued[gtxid]++ == 0) m_added = true;
+}
+
+void TxRelaySchedule::Remove(std::span<const GenTxid> gtxids)
+{
+    LOCK(m_mutex);
+    for (const auto& gtxid : gtxids) {
+        auto it{m_queued.find(gtxid)};
+        if (!Assume(it != m_queued.end())) continue;
+        if (--it->second == 0) m_queued.erase(it);
+    }
+}
+
+std::shared_ptr<const TxRelaySchedule::Schedule> TxRelaySchedule::Get()
+{
+    // The mempool lock is taken first, as when the mempool is looked up while
+    // holding a peer's inventory lock.
+    LOCK2(m_mempool.cs, m_mutex);
+    // Prioritisations and block updates only change the update counter.
+    if (!m_added && m_schedule->mempool_sequence == m_mempool.GetSequence() &&
+        m_schedule->transactions_updated == m_mempool.GetTransactionsUpdated()) {
+        return m_schedule;
+    }
+
+    std::vector<GenTxid> queued;
+    queued.reserve(m_queued.size());
+    for (const auto& [gtxid, _] : m_queued) queued.push_back(gtxid);
+
+    auto schedule{std::make_shared<Schedule>()};
+    schedule->mempool_sequence = m_mempool.GetSequence();
+    schedule->transactions_updated = m_mempool.GetTransactionsUpdated();
+    schedule->entries = m_mempool.InfoSortedByDepthAndScore(queued);
+    for (const auto& [gtxid, _] : schedule->entries) schedule->ids.insert(gtxid);
+    m_schedule = std::move(schedule);
+    m_added = false;
+    return m_schedule;
+}
+
+size_t TxRelaySchedule::Size() const
+{
+    LOCK(m_mutex);
+    return m_queued.size();
+}
+} // namespace node
@@ -0,0 +1,73 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_TXRELAYSCHEDULE_H
+#define BITCOIN_NODE_TXRELAYSCHEDULE_H
+
+#include <sync.h>
+#include <txmempool.h>
+#include <util/transaction_identifier.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace node {
+/**
+ * Order in which the transactions queued for announcement are announced,
+ * shared by all peers.
+ *
+ * Every transaction queued in the inventory of at least one peer is known to
+ * the schedule, by the id it is announced with (txid or wtxid). When a peer's
+ * announcements are due, the queued transactions that are still in the
+ * mempool are sorted into dependency and fee rate order once, and the peer
+ * only has to walk that order and pick its own ones. The order is recomputed
+ * when transactions were queued or the mempool changed since it was last
+ * computed, so peers whose announcements are due at the same time (like all
+ * inbound peers) share the work.
+ */
+class TxRelaySchedule
+{
+public:
+    struct Schedule {
+        //! Mempool sequence number and update counter at the time the schedule was computed.
+        uint64_t mempool_sequence{0};
+        unsigned int transactions_updated{0};
+        //! Queued transactions that were in the mempool, best to announce first.
+        std::vector<std::pair<GenTxid, TxMempoolInfo>> entries;
+        //! Ids of the entries.
+        std::set<GenTxid> ids;
+    };
+
+    explicit TxRelaySchedule(const CTxMemPool& mempool) : m_mempool{mempool} {}
+
+    //! Record that the transaction was queued for announcement to one more peer.
+    void Add(const GenTxid& gtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    //! Record that the transactions are no longer queued for one of the peers.
+    void Remove(std::span<const GenTxid> gtxids) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Get the current schedule, computing it first if it is outdated.
+    std::shared_ptr<const Schedule> Get() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    //! Number of distinct transaction ids queued for any peer.
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    const CTxMemPool& m_mempool;
+
+    mutable Mutex m_mutex;
+    //! Number of peers each transaction is queued for.
+    std::map<GenTxid, size_t> m_queued GUARDED_BY(m_mutex);
+    //! Whether transactions were queued since the schedule was computed.
+    bool m_added GUARDED_BY(m_mutex){false};
+    std::shared_ptr<const Schedule> m_schedule GUARDED_BY(m_mutex){std::make_shared<const Schedule>()};
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_TXRELAYSCHEDULE_H
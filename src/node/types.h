@@ -47,6 +47,12 @@ struct BlockCreateOptions {
      * transaction outputs.
      */
     size_t coinbase_output_max_additional_sigops{400};
+    /**
+     * Return a kept template right away instead of checking its validity
+     * first. The check then runs in the background, and
+     * interfaces::BlockTemplate::isValidated() tells whether it passed.
+     */
+    bool defer_validity_check{false};
     /**
      * Script to put in the coinbase transaction. The default is an
      * anyone-can-spend dummy.
@@ -27,10 +27,12 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdio>
 #include <cstdint>
 #include <exception>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 // The current format written, and the version required to read. Must be
 // increased to at least 289900+1 on the next breaking change.
@@ -65,116 +67,40 @@ struct EncodedDoubleFormatter
     }
 };
 
-} // namespace
-
-/**
- * We will instantiate an instance of this class to track transactions that were
- * included in a block. We will lump transactions into a bucket according to their
- * approximate feerate and then track how long it took for those txs to be included in a block
- *
- * The tracking of unconfirmed (mempool) transactions is completely independent of the
- * historical tracking of transactions that have been confirmed in a block.
- */
-class TxConfirmStats
+/** The data points a block added, as logged after processing it. */
+struct BlockLogEntry
 {
-private:
-    //Define the buckets we will group transactions into
-    const std::vector<double>& buckets;              // The upper-bound of the range for the bucket (inclusive)
-    const std::map<double, unsigned int>& bucketMap; // Map of bucket upper-bound to index into all vectors by bucket
-
-    // For each bucket X:
-    // Count the total # of txs in each bucket
-    // Track the historical moving average of this total over blocks
-    std::vector<double> txCtAvg;
-
-    // Count the total # of txs confirmed within Y blocks in each bucket
-    // Track the historical moving average of these totals over blocks
-    std::vector<std::vector<double>> confAvg; // confAvg[Y][X]
-
-    // Track moving avg of txs which have been evicted from the mempool
-    // after failing to be confirmed within Y blocks
-    std::vector<std::vector<double>> failAvg; // failAvg[Y][X]
-
-    // Sum the total feerate of all tx's in each bucket
-    // Track the historical moving average of this total over blocks
-    std::vector<double> m_feerate_avg;
-
-    // Combine the conf counts with tx counts to calculate the confirmation % for each Y,X
-    // Combine the total value with the tx counts to calculate the avg feerate per bucket
-
-    double decay;
-
-    // Resolution (# of blocks) with which confirmations are tracked
-    unsigned int scale;
-
-    // Mempool counts of outstanding transactions
-    // For each bucket X, track the number of transactions in the mempool
-    // that are unconfirmed for each possible confirmation value Y
-    std::vector<std::vector<int> > unconfTxs;  //unconfTxs[Y][X]
-    // transactions still unconfirmed after GetMaxConfirms for each bucket
-    std::vector<int> oldUnconfTxs;
-
-    void resizeInMemoryCounters(size_t newbuckets);
-
-public:
-    /**
-     * Create new TxConfirmStats. This is called by BlockPolicyEstimator's
-     * constructor with default values.
-     * @param defaultBuckets contains the upper limits for the bucket boundaries
-     * @param maxPeriods max number of periods to track
-     * @param decay how much to decay the historical moving average per block
-     */
-    TxConfirmStats(const std::vector<double>& defaultBuckets, const std::map<double, unsigned int>& defaultBucketMap,
-                   unsigned int maxPeriods, double decay, unsigned int scale);
-
-    /** Roll the circular buffer for unconfirmed txs*/
-    void ClearCurrent(unsigned int nBlockHeight);
-
-    /**
-     * Record a new transaction data point in the current block stats
-     * @param blocksToConfirm the number of blocks it took this transaction to confirm
-     * @param val the feerate of the transaction
-     * @warning blocksToConfirm is 1-based and has to be >= 1
-     */
-    void Record(int blocksToConfirm, double val);
-
-    /** Record a new transaction entering the mempool*/
-    unsigned int NewTx(unsigned int nBlockHeight, double val);
-
-    /** Remove a transaction from mempool tracking stats*/
-    void removeTx(unsigned int entryHeight, unsigned int nBestSeenHeight,
-                  unsigned int bucketIndex, bool inBlock);
-
-    /** Update our estimates by decaying our historical moving average and updating
-        with the data gathered from the current block */
-    void UpdateMovingAverages();
-
-    /**
-     * Calculate a feerate estimate.  Find the lowest value bucket (or range of buckets
-     * to make sure we have enough data points) whose transactions still have sufficient likelihood
-     * of being confirmed within the target number of confirmations
-     * @param confTarget target number of confirmations
-     * @param sufficientTxVal required average number of transactions per block in a bucket range
-     * @param minSuccess the success probability we require
-     * @param nBlockHeight the current block height
-     */
-    double EstimateMedianVal(int confTarget, double sufficientTxVal,
-                             double minSuccess, unsigned int nBlockHeight,
-                             EstimationResult *result = nullptr) const;
-
-    /** Return the max number of confirms we're tracking */
-    unsigned int GetMaxConfirms() const { return scale * confAvg.size(); }
-
-    /** Write state of estimation data to a file*/
-    void Write(AutoFile& fileout) const;
-
-    /**
-     * Read saved state of estimation data from a file and replace all internal data structures and
-     * variables with this state.
-     */
-    void Read(AutoFile& filein, size_t numBuckets);
+    unsigned int height{0};
+    //! Blocks ago and bucket of the tracked transactions that left the
+    //! mempool unconfirmed since the previous block
+    std::vector<std::pair<unsigned int, unsigned int>> failures;
+    //! Blocks to confirm and feerate of the tracked transactions confirmed in the block
+    std::vector<unsigned int> confirmed_blocks;
+    std::vector<double> confirmed_feerates;
+
+    SERIALIZE_METHODS(BlockLogEntry, obj)
+    {
+        READWRITE(obj.height, obj.failures, obj.confirmed_blocks, Using<VectorFormatter<EncodedDoubleFormatter>>(obj.confirmed_feerates));
+    }
 };
 
+/** Write serialized data to the unbuffered log in a single call, so that it
+ * reaches the OS as a whole or not at all. */
+template <typename... Args>
+bool WriteToLog(AutoFile& log_file, const fs::path& log_filepath, const Args&... args)
+{
+    DataStream data;
+    (data << ... << args);
+    try {
+        log_file.write(data);
+    } catch (const std::exception& e) {
+        LogDebug(BCLog::ESTIMATEFEE, "Failed to write to fee estimates log %s: %s\n", fs::PathToString(log_filepath), e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
 
 TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
                                 const std::map<double, unsigned int>& defaultBucketMap,
@@ -202,14 +128,63 @@ void TxConfirmStats::resizeInMemoryCounters(size_t newbuckets) {
         unconfTxs[i].resize(newbuckets);
     }
     oldUnconfTxs.resize(newbuckets);
+    unconfSums.resize(newbuckets);
+    for (unsigned int j = 0; j < unconfSums.size(); j++) {
+        std::vector<int>& sums = unconfSums[j];
+        sums.assign(unconfTxs.size() + 1, 0);
+        for (size_t i = 1; i < sums.size(); i++) {
+            sums[i] += unconfTxs[i - 1][j];
+            if (size_t parent = i + (i & -i); parent < sums.size()) sums[parent] += sums[i];
+        }
+    }
+}
+
+void TxConfirmStats::AddUnconfirmed(unsigned int blockIndex, unsigned int bucketindex, int count)
+{
+    unconfTxs[blockIndex][bucketindex] += count;
+    std::vector<int>& sums = unconfSums[bucketindex];
+    for (size_t i = blockIndex + 1; i < sums.size(); i += i & -i) {
+        sums[i] += count;
+    }
+}
+
+int TxConfirmStats::SumUnconfirmed(unsigned int bucketindex, unsigned int count) const
+{
+    const std::vector<int>& sums = unconfSums[bucketindex];
+    int sum = 0;
+    for (size_t i = count; i > 0; i -= i & -i) {
+        sum += sums[i];
+    }
+    return sum;
+}
+
+int TxConfirmStats::UnconfirmedSince(unsigned int confTarget, unsigned int nBlockHeight, unsigned int bucketindex) const
+{
+    const unsigned int bins = unconfTxs.size();
+    if (nBlockHeight < bins) {
+        // The slots wrap around through the unsigned subtraction before the
+        // first GetMaxConfirms blocks, count them one by one.
+        int count = 0;
+        for (unsigned int confct = confTarget; confct < GetMaxConfirms(); confct++)
+            count += unconfTxs[(nBlockHeight - confct) % bins][bucketindex];
+        return count;
+    }
+    if (confTarget >= bins) return 0;
+    // Transactions unconfirmed for bins - 1 down to confTarget blocks are in
+    // the bins - confTarget slots following the current block's one.
+    const unsigned int first = (nBlockHeight + 1) % bins;
+    const unsigned int end = first + bins - confTarget;
+    if (end <= bins) return SumUnconfirmed(bucketindex, end) - SumUnconfirmed(bucketindex, first);
+    return SumUnconfirmed(bucketindex, bins) - SumUnconfirmed(bucketindex, first) + SumUnconfirmed(bucketindex, end - bins);
 }
 
 // Roll the unconfirmed txs circular buffer
 void TxConfirmStats::ClearCurrent(unsigned int nBlockHeight)
 {
+    const unsigned int blockIndex = nBlockHeight % unconfTxs.size();
     for (unsigned int j = 0; j < buckets.size(); j++) {
-        oldUnconfTxs[j] += unconfTxs[nBlockHeight % unconfTxs.size()][j];
-        unconfTxs[nBlockHeight%unconfTxs.size()][j] = 0;
+        oldUnconfTxs[j] += unconfTxs[blockIndex][j];
+        AddUnconfirmed(blockIndex, j, -unconfTxs[blockIndex][j]);
     }
 }
 
@@ -270,7 +245,6 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
     double partialNum = 0;
 
     bool foundAnswer = false;
-    unsigned int bins = unconfTxs.size();
     bool newBucketRange = true;
     bool passing = true;
     EstimatorBucket passBucket;
@@ -287,8 +261,7 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
         partialNum += txCtAvg[bucket];
         totalNum += txCtAvg[bucket];
         failNum += failAvg[periodTarget - 1][bucket];
-        for (unsigned int confct = confTarget; confct < GetMaxConfirms(); confct++)
-            extraNum += unconfTxs[(nBlockHeight - confct) % bins][bucket];
+        extraNum += UnconfirmedSince(confTarget, nBlockHeight, bucket);
         extraNum += oldUnconfTxs[bucket];
         // If we have enough transaction data points in this range of buckets,
         // we can test for success
@@ -478,7 +451,7 @@ unsigned int TxConfirmStats::NewTx(unsigned int nBlockHeight, double val)
 {
     unsigned int bucketindex = bucketMap.lower_bound(val)->second;
     unsigned int blockIndex = nBlockHeight % unconfTxs.size();
-    unconfTxs[blockIndex][bucketindex]++;
+    AddUnconfirmed(blockIndex, bucketindex, 1);
     return bucketindex;
 }
 
@@ -504,13 +477,20 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
     else {
         unsigned int blockIndex = entryHeight % unconfTxs.size();
         if (unconfTxs[blockIndex][bucketindex] > 0) {
-            unconfTxs[blockIndex][bucketindex]--;
+            AddUnconfirmed(blockIndex, bucketindex, -1);
         } else {
             LogDebug(BCLog::ESTIMATEFEE, "Blockpolicy error, mempool tx removed from blockIndex=%u,bucketIndex=%u already\n",
                      blockIndex, bucketindex);
         }
     }
-    if (!inBlock && (unsigned int)blocksAgo >= scale) { // Only counts as a failure if not confirmed for entire period
+    if (!inBlock) {
+        RecordFailure(blocksAgo, bucketindex);
+    }
+}
+
+void TxConfirmStats::RecordFailure(unsigned int blocksAgo, unsigned int bucketindex)
+{
+    if (blocksAgo >= scale) { // Only counts as a failure if not confirmed for entire period
         assert(scale != 0);
         unsigned int periodsAgo = blocksAgo / scale;
         for (size_t i = 0; i < periodsAgo && i < failAvg.size(); i++) {
@@ -533,6 +513,13 @@ bool CBlockPolicyEstimator::_removeTx(const uint256& hash, bool inBlock)
         feeStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
         shortStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
         longStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
+        if (nBestSeenHeight > pos->second.blockHeight) {
+            if (!inBlock) m_pending_failures.emplace_back(nBestSeenHeight - pos->second.blockHeight, pos->second.bucketIndex);
+            m_smart_fee_cache.clear();
+        } else if (nBestSeenHeight < longStats->GetMaxConfirms()) {
+            // See processTransaction.
+            m_smart_fee_cache.clear();
+        }
         mapMemPoolTxs.erase(hash);
         return true;
     } else {
@@ -541,7 +528,8 @@ bool CBlockPolicyEstimator::_removeTx(const uint256& hash, bool inBlock)
 }
 
 CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates)
-    : m_estimation_filepath{estimation_filepath}
+    : m_estimation_filepath{estimation_filepath},
+      m_log_filepath{fs::path{estimation_filepath}.replace_extension(".log")}
 {
     static_assert(MIN_BUCKET_FEERATE > 0, "Min feerate must be nonzero");
     size_t bucketIndex = 0;
@@ -560,23 +548,33 @@ CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath
 
     AutoFile est_file{fsbridge::fopen(m_estimation_filepath, "rb")};
 
+    bool read_estimates{false};
     if (est_file.IsNull()) {
         LogPrintf("%s is not found. Continue anyway.\n", fs::PathToString(m_estimation_filepath));
-        return;
-    }
-
-    std::chrono::hours file_age = GetFeeEstimatorFileAge();
-    if (file_age > MAX_FILE_AGE && !read_stale_estimates) {
+    } else if (std::chrono::hours file_age = GetFeeEstimatorFileAge(); file_age > MAX_FILE_AGE && !read_stale_estimates) {
         LogPrintf("Fee estimation file %s too old (age=%lld > %lld hours) and will not be used to avoid serving stale estimates.\n", fs::PathToString(m_estimation_filepath), Ticks<std::chrono::hours>(file_age), Ticks<std::chrono::hours>(MAX_FILE_AGE));
-        return;
+    } else if (!Read(est_file)) {
+        LogPrintf("Failed to read fee estimates from %s. Continue anyway.\n", fs::PathToString(m_estimation_filepath));
+    } else {
+        read_estimates = true;
     }
 
-    if (!Read(est_file)) {
-        LogPrintf("Failed to read fee estimates from %s. Continue anyway.\n", fs::PathToString(m_estimation_filepath));
+    // Blocks processed after the estimation file was last written, before the
+    // node stopped without writing it, are in the log. Write them to the file right away, so
+    // that the log can start over.
+    if (read_estimates && WITH_LOCK(m_cs_fee_estimator, return ReplayLog()) > 0) {
+        FlushFeeEstimates();
+    } else {
+        LOCK(m_cs_fee_estimator);
+        ResetLog();
     }
 }
 
-CBlockPolicyEstimator::~CBlockPolicyEstimator() = default;
+CBlockPolicyEstimator::~CBlockPolicyEstimator()
+{
+    LOCK(m_cs_fee_estimator);
+    CloseLog();
+}
 
 void CBlockPolicyEstimator::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t /*unused*/)
 {
@@ -636,6 +634,11 @@ void CBlockPolicyEstimator::processTransaction(const NewMempoolTransactionInfo&
     assert(bucketIndex == bucketIndex2);
     unsigned int bucketIndex3 = longStats->NewTx(txHeight, static_cast<double>(feeRate.GetFeePerK()));
     assert(bucketIndex == bucketIndex3);
+
+    // Estimates only count transactions unconfirmed for at least one block, so
+    // a new one does not change them until the next block, unless the
+    // circular buffers of unconfirmed transactions still wrap around.
+    if (txHeight < longStats->GetMaxConfirms()) m_smart_fee_cache.clear();
 }
 
 bool CBlockPolicyEstimator::processBlockTx(unsigned int nBlockHeight, const RemovedMempoolTransactionInfo& tx)
@@ -694,11 +697,24 @@ void CBlockPolicyEstimator::processBlock(const std::vector<RemovedMempoolTransac
     shortStats->UpdateMovingAverages();
     longStats->UpdateMovingAverages();
 
+    BlockLogEntry log_entry;
+    log_entry.height = nBlockHeight;
+    log_entry.failures = std::move(m_pending_failures);
+    m_pending_failures.clear();
+
     unsigned int countedTxs = 0;
     // Update averages with data points from current block
     for (const auto& tx : txs_removed_for_block) {
-        if (processBlockTx(nBlockHeight, tx))
+        if (processBlockTx(nBlockHeight, tx)) {
             countedTxs++;
+            log_entry.confirmed_blocks.push_back(nBlockHeight - tx.info.txHeight);
+            log_entry.confirmed_feerates.push_back(CFeeRate(tx.info.m_fee, tx.info.m_virtual_transaction_size).GetFeePerK());
+        }
+    }
+    m_smart_fee_cache.clear();
+    if (m_log_file && !WriteToLog(*m_log_file, m_log_filepath, log_entry)) {
+        // Entries appended after a failed one could not be replayed.
+        CloseLog();
     }
 
     if (firstRecordedHeight == 0 && countedTxs > 0) {
@@ -872,10 +888,28 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
 {
     LOCK(m_cs_fee_estimator);
 
-    if (feeCalc) {
-        feeCalc->desiredTarget = confTarget;
-        feeCalc->returnedTarget = confTarget;
+    const auto key{std::make_pair(confTarget, conservative)};
+    auto it{m_smart_fee_cache.find(key)};
+    if (it == m_smart_fee_cache.end()) {
+        FeeCalculation calc;
+        const CFeeRate feerate{_estimateSmartFee(confTarget, calc, conservative)};
+        // Only cache the targets that can be tracked, which bounds the cache size.
+        if (confTarget <= 0 || (unsigned int)confTarget > longStats->GetMaxConfirms()) {
+            if (feeCalc) *feeCalc = calc;
+            return feerate;
+        }
+        it = m_smart_fee_cache.emplace(key, std::make_pair(feerate, calc)).first;
     }
+    if (feeCalc) *feeCalc = it->second.second;
+    return it->second.first;
+}
+
+CFeeRate CBlockPolicyEstimator::_estimateSmartFee(int confTarget, FeeCalculation& feeCalc, bool conservative) const
+{
+    AssertLockHeld(m_cs_fee_estimator);
+
+    feeCalc.desiredTarget = confTarget;
+    feeCalc.returnedTarget = confTarget;
 
     double median = -1;
     EstimationResult tempResult;
@@ -892,7 +926,7 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     if ((unsigned int)confTarget > maxUsableEstimate) {
         confTarget = maxUsableEstimate;
     }
-    if (feeCalc) feeCalc->returnedTarget = confTarget;
+    feeCalc.returnedTarget = confTarget;
 
     if (confTarget <= 1) return CFeeRate(0); // error condition
 
@@ -916,36 +950,28 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
      * See: https://github.com/bitcoin/bitcoin/issues/11800#issuecomment-349697807
      */
     double halfEst = estimateCombinedFee(confTarget/2, HALF_SUCCESS_PCT, true, &tempResult);
-    if (feeCalc) {
-        feeCalc->est = tempResult;
-        feeCalc->reason = FeeReason::HALF_ESTIMATE;
-    }
+    feeCalc.est = tempResult;
+    feeCalc.reason = FeeReason::HALF_ESTIMATE;
     median = halfEst;
     double actualEst = estimateCombinedFee(confTarget, SUCCESS_PCT, true, &tempResult);
     if (actualEst > median) {
         median = actualEst;
-        if (feeCalc) {
-            feeCalc->est = tempResult;
-            feeCalc->reason = FeeReason::FULL_ESTIMATE;
-        }
+        feeCalc.est = tempResult;
+        feeCalc.reason = FeeReason::FULL_ESTIMATE;
     }
     double doubleEst = estimateCombinedFee(2 * confTarget, DOUBLE_SUCCESS_PCT, !conservative, &tempResult);
     if (doubleEst > median) {
         median = doubleEst;
-        if (feeCalc) {
-            feeCalc->est = tempResult;
-            feeCalc->reason = FeeReason::DOUBLE_ESTIMATE;
-        }
+        feeCalc.est = tempResult;
+        feeCalc.reason = FeeReason::DOUBLE_ESTIMATE;
     }
 
     if (conservative || median == -1) {
         double consEst =  estimateConservativeFee(2 * confTarget, &tempResult);
         if (consEst > median) {
             median = consEst;
-            if (feeCalc) {
-                feeCalc->est = tempResult;
-                feeCalc->reason = FeeReason::CONSERVATIVE;
-            }
+            feeCalc.est = tempResult;
+            feeCalc.reason = FeeReason::CONSERVATIVE;
         }
     }
 
@@ -961,8 +987,9 @@ void CBlockPolicyEstimator::Flush() {
 
 void CBlockPolicyEstimator::FlushFeeEstimates()
 {
+    LOCK(m_cs_fee_estimator);
     AutoFile est_file{fsbridge::fopen(m_estimation_filepath, "wb")};
-    if (est_file.IsNull() || !Write(est_file)) {
+    if (est_file.IsNull() || !_Write(est_file)) {
         LogPrintf("Failed to write fee estimates to %s. Continue anyway.\n", fs::PathToString(m_estimation_filepath));
         (void)est_file.fclose();
         return;
@@ -971,13 +998,20 @@ void CBlockPolicyEstimator::FlushFeeEstimates()
         LogError("Failed to close fee estimates file %s: %s. Continuing anyway.", fs::PathToString(m_estimation_filepath), SysErrorString(errno));
         return;
     }
+    ResetLog();
     LogPrintf("Flushed fee estimates to %s.\n", fs::PathToString(m_estimation_filepath.filename()));
 }
 
 bool CBlockPolicyEstimator::Write(AutoFile& fileout) const
 {
+    LOCK(m_cs_fee_estimator);
+    return _Write(fileout);
+}
+
+bool CBlockPolicyEstimator::_Write(AutoFile& fileout) const
+{
+    AssertLockHeld(m_cs_fee_estimator);
     try {
-        LOCK(m_cs_fee_estimator);
         fileout << CURRENT_FEES_FILE_VERSION;
         fileout << int{0}; // Unused dummy field. Written files may contain any value in [0, 289900]
         fileout << nBestSeenHeight;
@@ -1052,6 +1086,7 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
             nBestSeenHeight = nFileBestSeenHeight;
             historicalFirst = nFileHistoricalFirst;
             historicalBest = nFileHistoricalBest;
+            m_smart_fee_cache.clear();
         }
     }
     catch (const std::exception& e) {
@@ -1061,6 +1096,93 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
     return true;
 }
 
+void CBlockPolicyEstimator::ResetLog()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    // The failures so far are in the data the new log starts from.
+    m_pending_failures.clear();
+    CloseLog();
+    std::FILE* file{fsbridge::fopen(m_log_filepath, "wb")};
+    if (!file) {
+        LogPrintf("Failed to open fee estimates log %s. Continue anyway.\n", fs::PathToString(m_log_filepath));
+        return;
+    }
+    // Each entry is written in one call while processing its block. Without a
+    // stdio buffer, it is in the OS's hands right away and survives the node
+    // crashing.
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    m_log_file = std::make_unique<AutoFile>(file);
+    if (!WriteToLog(*m_log_file, m_log_filepath, CURRENT_FEES_FILE_VERSION, nBestSeenHeight)) {
+        LogWarning("Unable to write fee estimates log (non-fatal)");
+        CloseLog();
+    }
+}
+
+void CBlockPolicyEstimator::CloseLog()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    if (m_log_file && m_log_file->fclose() != 0) {
+        LogError("Failed to close fee estimates log %s: %s. Continuing anyway.", fs::PathToString(m_log_filepath), SysErrorString(errno));
+    }
+    m_log_file.reset();
+}
+
+unsigned int CBlockPolicyEstimator::ReplayLog()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    AutoFile log_file{fsbridge::fopen(m_log_filepath, "rb")};
+    if (log_file.IsNull()) return 0;
+
+    unsigned int replayed{0};
+    try {
+        int version;
+        unsigned int start_height;
+        log_file >> version >> start_height;
+        // The log only applies on top of the data it was started from.
+        if (version != CURRENT_FEES_FILE_VERSION || start_height != nBestSeenHeight) return 0;
+        while (true) {
+            BlockLogEntry entry;
+            log_file >> entry;
+            if (entry.height <= nBestSeenHeight || entry.confirmed_blocks.size() != entry.confirmed_feerates.size() ||
+                std::ranges::any_of(entry.failures, [&](const auto& failure) { return failure.second >= buckets.size(); }) ||
+                std::ranges::any_of(entry.confirmed_feerates, [&](double feerate) { return !(feerate >= 0 && feerate <= buckets.back()); })) {
+                throw std::runtime_error("Corrupt fee estimates log entry");
+            }
+            // Same as processBlock, for the data that is written to the
+            // estimation file. Unconfirmed transactions are not written.
+            for (const auto& [blocks_ago, bucket_index] : entry.failures) {
+                feeStats->RecordFailure(blocks_ago, bucket_index);
+                shortStats->RecordFailure(blocks_ago, bucket_index);
+                longStats->RecordFailure(blocks_ago, bucket_index);
+            }
+            feeStats->UpdateMovingAverages();
+            shortStats->UpdateMovingAverages();
+            longStats->UpdateMovingAverages();
+            for (size_t i{0}; i < entry.confirmed_blocks.size(); ++i) {
+                feeStats->Record(entry.confirmed_blocks[i], entry.confirmed_feerates[i]);
+                shortStats->Record(entry.confirmed_blocks[i], entry.confirmed_feerates[i]);
+                longStats->Record(entry.confirmed_blocks[i], entry.confirmed_feerates[i]);
+            }
+            // Extend the historical data if it ends at the previous block, like
+            // the file written after processing the blocks would have.
+            if (historicalFirst != 0 && historicalBest == nBestSeenHeight) {
+                historicalBest = entry.height;
+            } else if (firstRecordedHeight == 0 && !entry.confirmed_blocks.empty()) {
+                firstRecordedHeight = entry.height;
+            }
+            nBestSeenHeight = entry.height;
+            ++replayed;
+        }
+    } catch (const std::exception&) {
+        // The end of the log, or an entry cut short by the unclean shutdown.
+    }
+    m_smart_fee_cache.clear();
+    if (replayed > 0) {
+        LogPrintf("Replayed %u blocks from fee estimates log %s.\n", replayed, fs::PathToString(m_log_filepath.filename()));
+    }
+    return replayed;
+}
+
 void CBlockPolicyEstimator::FlushUnconfirmed()
 {
     const auto startclear{SteadyClock::now()};
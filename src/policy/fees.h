@@ -20,6 +20,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -36,7 +37,6 @@ static constexpr std::chrono::hours MAX_FILE_AGE{60};
 static constexpr bool DEFAULT_ACCEPT_STALE_FEE_ESTIMATES{false};
 
 class AutoFile;
-class TxConfirmStats;
 struct RemovedMempoolTransactionInfo;
 struct NewMempoolTransactionInfo;
 
@@ -97,6 +97,128 @@ struct FeeCalculation
     int returnedTarget = 0;
 };
 
+/**
+ * We will instantiate an instance of this class to track transactions that were
+ * included in a block. We will lump transactions into a bucket according to their
+ * approximate feerate and then track how long it took for those txs to be included in a block
+ *
+ * The tracking of unconfirmed (mempool) transactions is completely independent of the
+ * historical tracking of transactions that have been confirmed in a block.
+ */
+class TxConfirmStats
+{
+private:
+    //Define the buckets we will group transactions into
+    const std::vector<double>& buckets;              // The upper-bound of the range for the bucket (inclusive)
+    const std::map<double, unsigned int>& bucketMap; // Map of bucket upper-bound to index into all vectors by bucket
+
+    // For each bucket X:
+    // Count the total # of txs in each bucket
+    // Track the historical moving average of this total over blocks
+    std::vector<double> txCtAvg;
+
+    // Count the total # of txs confirmed within Y blocks in each bucket
+    // Track the historical moving average of these totals over blocks
+    std::vector<std::vector<double>> confAvg; // confAvg[Y][X]
+
+    // Track moving avg of txs which have been evicted from the mempool
+    // after failing to be confirmed within Y blocks
+    std::vector<std::vector<double>> failAvg; // failAvg[Y][X]
+
+    // Sum the total feerate of all tx's in each bucket
+    // Track the historical moving average of this total over blocks
+    std::vector<double> m_feerate_avg;
+
+    // Combine the conf counts with tx counts to calculate the confirmation % for each Y,X
+    // Combine the total value with the tx counts to calculate the avg feerate per bucket
+
+    double decay;
+
+    // Resolution (# of blocks) with which confirmations are tracked
+    unsigned int scale;
+
+    // Mempool counts of outstanding transactions
+    // For each bucket X, track the number of transactions in the mempool
+    // that are unconfirmed for each possible confirmation value Y
+    std::vector<std::vector<int> > unconfTxs;  //unconfTxs[Y][X]
+    // transactions still unconfirmed after GetMaxConfirms for each bucket
+    std::vector<int> oldUnconfTxs;
+    // For each bucket X, a Fenwick tree over the circular buffer of unconfTxs,
+    // to sum the transactions unconfirmed for a range of Y without a loop
+    std::vector<std::vector<int>> unconfSums; // unconfSums[X][Y + 1]
+
+    void resizeInMemoryCounters(size_t newbuckets);
+
+    /** Add to the unconfirmed transactions of a bucket in a slot of the circular buffer */
+    void AddUnconfirmed(unsigned int blockIndex, unsigned int bucketindex, int count);
+    /** Number of unconfirmed transactions of a bucket in the first count slots of the circular buffer */
+    int SumUnconfirmed(unsigned int bucketindex, unsigned int count) const;
+
+public:
+    /**
+     * Create new TxConfirmStats. This is called by BlockPolicyEstimator's
+     * constructor with default values.
+     * @param defaultBuckets contains the upper limits for the bucket boundaries
+     * @param maxPeriods max number of periods to track
+     * @param decay how much to decay the historical moving average per block
+     */
+    TxConfirmStats(const std::vector<double>& defaultBuckets, const std::map<double, unsigned int>& defaultBucketMap,
+                   unsigned int maxPeriods, double decay, unsigned int scale);
+
+    /** Roll the circular buffer for unconfirmed txs*/
+    void ClearCurrent(unsigned int nBlockHeight);
+
+    /**
+     * Record a new transaction data point in the current block stats
+     * @param blocksToConfirm the number of blocks it took this transaction to confirm
+     * @param val the feerate of the transaction
+     * @warning blocksToConfirm is 1-based and has to be >= 1
+     */
+    void Record(int blocksToConfirm, double val);
+
+    /** Record a new transaction entering the mempool*/
+    unsigned int NewTx(unsigned int nBlockHeight, double val);
+
+    /** Remove a transaction from mempool tracking stats*/
+    void removeTx(unsigned int entryHeight, unsigned int nBestSeenHeight,
+                  unsigned int bucketIndex, bool inBlock);
+
+    /** Record a transaction that left the mempool unconfirmed after blocksAgo blocks */
+    void RecordFailure(unsigned int blocksAgo, unsigned int bucketindex);
+
+    /** Update our estimates by decaying our historical moving average and updating
+        with the data gathered from the current block */
+    void UpdateMovingAverages();
+
+    /**
+     * Calculate a feerate estimate.  Find the lowest value bucket (or range of buckets
+     * to make sure we have enough data points) whose transactions still have sufficient likelihood
+     * of being confirmed within the target number of confirmations
+     * @param confTarget target number of confirmations
+     * @param sufficientTxVal required average number of transactions per block in a bucket range
+     * @param minSuccess the success probability we require
+     * @param nBlockHeight the current block height
+     */
+    double EstimateMedianVal(int confTarget, double sufficientTxVal,
+                             double minSuccess, unsigned int nBlockHeight,
+                             EstimationResult *result = nullptr) const;
+
+    /** Number of transactions of a bucket still unconfirmed after confTarget or more blocks, up to GetMaxConfirms */
+    int UnconfirmedSince(unsigned int confTarget, unsigned int nBlockHeight, unsigned int bucketindex) const;
+
+    /** Return the max number of confirms we're tracking */
+    unsigned int GetMaxConfirms() const { return scale * confAvg.size(); }
+
+    /** Write state of estimation data to a file*/
+    void Write(AutoFile& fileout) const;
+
+    /**
+     * Read saved state of estimation data from a file and replace all internal data structures and
+     * variables with this state.
+     */
+    void Read(AutoFile& filein, size_t numBuckets);
+};
+
 /** \class CBlockPolicyEstimator
  * The BlockPolicyEstimator is used for estimating the feerate needed
  * for a transaction to be included in a block within a certain number of
@@ -197,6 +319,8 @@ private:
     static constexpr double FEE_SPACING = 1.05;
 
     const fs::path m_estimation_filepath;
+    /** Log of the blocks processed since the estimation file was written */
+    const fs::path m_log_filepath;
 public:
     /** Create new BlockPolicyEstimator and initialize stats tracking classes with default values */
     CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates);
@@ -255,7 +379,7 @@ public:
     void Flush()
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
 
-    /** Record current fee estimations. */
+    /** Record current fee estimations, and start a new log of the blocks processed after. */
     void FlushFeeEstimates()
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
 
@@ -300,9 +424,25 @@ private:
     std::vector<double> buckets GUARDED_BY(m_cs_fee_estimator); // The upper-bound of the range for the bucket (inclusive)
     std::map<double, unsigned int> bucketMap GUARDED_BY(m_cs_fee_estimator); // Map of bucket upper-bound to index into all vectors by bucket
 
+    /** Blocks ago and bucket of the tracked transactions that left the mempool
+     * unconfirmed since the last block, to be logged with the next block. */
+    std::vector<std::pair<unsigned int, unsigned int>> m_pending_failures GUARDED_BY(m_cs_fee_estimator);
+
+    /** The log at m_log_filepath, kept open to append an entry for every block.
+     * Entries are not synced to disk: a crash of the node leaves them intact,
+     * but after a power failure the last ones may be missing or cut short, and
+     * the replay stops there. */
+    std::unique_ptr<AutoFile> m_log_file GUARDED_BY(m_cs_fee_estimator);
+
+    /** Results of estimateSmartFee by target and conservative flag, cleared
+     * whenever the data they were calculated from changes. */
+    mutable std::map<std::pair<int, bool>, std::pair<CFeeRate, FeeCalculation>> m_smart_fee_cache GUARDED_BY(m_cs_fee_estimator);
+
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const RemovedMempoolTransactionInfo& tx) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
+    /** estimateSmartFee without the cache */
+    CFeeRate _estimateSmartFee(int confTarget, FeeCalculation& feeCalc, bool conservative) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Helper for estimateSmartFee */
     double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Helper for estimateSmartFee */
@@ -317,6 +457,23 @@ private:
     /** A non-thread-safe helper for the removeTx function */
     bool _removeTx(const uint256& hash, bool inBlock)
         EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
+    /** A non-thread-safe helper for the Write function */
+    bool _Write(AutoFile& fileout) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
+    /** Start a new log of processed blocks on top of the current data */
+    void ResetLog()
+        EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
+    /** Stop appending to the log */
+    void CloseLog()
+        EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
+    /** Apply the blocks logged on top of the data read from the estimation
+     * file, and return how many were applied */
+    unsigned int ReplayLog()
+        EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 };
 
 class FeeFilterRounder
@@ -89,7 +89,7 @@ public:
 
     SERIALIZE_METHODS(CBlock, obj)
     {
-        READWRITE(AsBase<CBlockHeader>(obj), obj.vtx);
+        READWRITE(AsBase<CBlockHeader>(obj), Using<VectorFormatter<TransactionRefFormatter>>(obj.vtx));
     }
 
     void SetNull()
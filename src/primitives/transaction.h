@@ -18,6 +18,7 @@
 #include <ios>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <string>
 #include <tuple>
@@ -187,9 +188,12 @@ public:
 };
 
 struct CMutableTransaction;
+class TransactionArena;
 
 struct TransactionSerParams {
     const bool allow_witness;
+    //! Where to allocate the transactions of a deserialized block, if not individually on the heap.
+    TransactionArena* const arena{nullptr};
     SER_PARAMS_OPFUNC
 };
 static constexpr TransactionSerParams TX_WITH_WITNESS{.allow_witness = true};
@@ -423,4 +427,75 @@ struct CMutableTransaction
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
 
+/**
+ * Monotonic buffer that the transactions of a block, together with their
+ * reference counts, can be deserialized into instead of making one heap
+ * allocation each. The inputs, outputs, scripts and witnesses of the
+ * transactions are still allocated on the heap.
+ *
+ * Every transaction allocated from the arena keeps its memory alive, which
+ * is only released once all of them are gone. Only use it for blocks whose
+ * transactions are released together, not ones that may be held on to
+ * individually (e.g. by the mempool or the wallet).
+ *
+ * Not thread-safe: only one thread may allocate from an arena at a time.
+ */
+class TransactionArena
+{
+public:
+    /** Allocator keeping the arena memory alive for as long as it is in use. */
+    template <typename T>
+    class Allocator
+    {
+        template <typename U>
+        friend class Allocator;
+
+        std::shared_ptr<std::pmr::memory_resource> m_resource;
+
+    public:
+        using value_type = T;
+
+        explicit Allocator(std::shared_ptr<std::pmr::memory_resource> resource) noexcept : m_resource{std::move(resource)} {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) noexcept : m_resource{other.m_resource} {}
+
+        T* allocate(size_t n) { return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T* p, size_t n) noexcept { m_resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const noexcept { return m_resource == other.m_resource; }
+    };
+
+    TransactionArena() : m_resource{std::make_shared<std::pmr::monotonic_buffer_resource>()} {}
+
+    template <typename... Args>
+    CTransactionRef MakeTransactionRef(Args&&... args)
+    {
+        return std::allocate_shared<const CTransaction>(Allocator<CTransaction>{m_resource}, std::forward<Args>(args)...);
+    }
+
+private:
+    std::shared_ptr<std::pmr::memory_resource> m_resource;
+};
+
+/** Formatter for the transactions of a block, allocating them from the TransactionSerParams arena if there is one. */
+struct TransactionRefFormatter
+{
+    template <typename Stream>
+    void Ser(Stream& s, const CTransactionRef& tx)
+    {
+        s << tx;
+    }
+
+    template <typename Stream>
+    void Unser(Stream& s, CTransactionRef& tx)
+    {
+        if (TransactionArena* const arena{s.template GetParams<TransactionSerParams>().arena}) {
+            tx = arena->MakeTransactionRef(deserialize, s);
+        } else {
+            s >> tx;
+        }
+    }
+};
+
 #endif // BITCOIN_PRIMITIVES_TRANSACTION_H
@@ -446,9 +446,12 @@ static bool rest_block(const std::any& context,
     }
 
     case RESTResponseFormat::JSON: {
+        // The block is dropped once it is written out, so its transactions can share one allocation.
+        TransactionArena arena;
+        const TransactionSerParams params{.allow_witness = true, .arena = &arena};
         CBlock block{};
         DataStream block_stream{block_data};
-        block_stream >> TX_WITH_WITNESS(block);
+        block_stream >> params(block);
         UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
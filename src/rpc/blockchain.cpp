@@ -819,9 +819,12 @@ static RPCHelpMan getblock()
         return HexStr(block_data);
     }
 
+    // The block is dropped once it is converted, so its transactions can share one allocation.
+    TransactionArena arena;
+    const TransactionSerParams params{.allow_witness = true, .arena = &arena};
     DataStream block_stream{block_data};
     CBlock block{};
-    block_stream >> TX_WITH_WITNESS(block);
+    block_stream >> params(block);
 
     TxVerbosity tx_verbosity;
     if (verbosity == 1) {
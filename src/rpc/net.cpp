@@ -166,6 +166,15 @@ static RPCHelpMan getpeerinfo()
                     {
                         {RPCResult::Type::NUM, "n", "The heights of blocks we're currently asking from this peer"},
                     }},
+                    {RPCResult::Type::OBJ, "block_download", "Statistics of the blocks we requested from this peer",
+                    {
+                        {RPCResult::Type::NUM, "blocks", "The number of requested blocks received"},
+                        {RPCResult::Type::NUM, "bytes", "The total size of the requested blocks received"},
+                        {RPCResult::Type::NUM, "latency", "Moving average of the time in seconds from requesting a block to receiving it"},
+                        {RPCResult::Type::NUM, "rate", "Moving average of the download rate in bytes per second, or 0 if not known"},
+                        {RPCResult::Type::NUM, "inflight_limit", "The number of blocks that may be in flight from this peer during block download, based on its rate"},
+                        {RPCResult::Type::NUM, "rerequested", "The number of blocks requested from this peer because another peer stalled on them"},
+                    }},
                     {RPCResult::Type::BOOL, "addr_relay_enabled", "Whether we participate in address relay with this peer"},
                     {RPCResult::Type::NUM, "addr_processed", "The total number of addresses processed, excluding those dropped due to rate limiting"},
                     {RPCResult::Type::NUM, "addr_rate_limited", "The total number of addresses dropped due to rate limiting"},
@@ -272,6 +281,14 @@ static RPCHelpMan getpeerinfo()
             heights.push_back(height);
         }
         obj.pushKV("inflight", std::move(heights));
+        UniValue block_download(UniValue::VOBJ);
+        block_download.pushKV("blocks", statestats.m_blocks_downloaded);
+        block_download.pushKV("bytes", statestats.m_block_bytes_downloaded);
+        block_download.pushKV("latency", Ticks<SecondsDouble>(statestats.m_block_download_latency));
+        block_download.pushKV("rate", statestats.m_block_download_rate);
+        block_download.pushKV("inflight_limit", statestats.m_block_download_depth);
+        block_download.pushKV("rerequested", statestats.m_blocks_rerequested);
+        obj.pushKV("block_download", std::move(block_download));
         obj.pushKV("addr_relay_enabled", statestats.m_addr_relay_enabled);
         obj.pushKV("addr_processed", statestats.m_addr_processed);
         obj.pushKV("addr_rate_limited", statestats.m_addr_rate_limited);
@@ -642,6 +659,15 @@ static RPCHelpMan getnetworkinfo()
                         }},
                         {RPCResult::Type::BOOL, "localrelay", "true if transaction relay is requested from peers"},
                         {RPCResult::Type::NUM, "timeoffset", "the time offset"},
+                        {RPCResult::Type::OBJ, "blockservecache", "cache of serialized blocks served to peers",
+                        {
+                            {RPCResult::Type::NUM, "hits", "number of lookups answered from the cache"},
+                            {RPCResult::Type::NUM, "misses", "number of lookups that fell back to reading the block from disk"},
+                            {RPCResult::Type::NUM, "bytes_saved", "total bytes served from the cache instead of being read from disk"},
+                            {RPCResult::Type::NUM, "entries", "number of serialized blocks currently cached"},
+                            {RPCResult::Type::NUM, "usage", "bytes currently used by the cache"},
+                            {RPCResult::Type::NUM, "max_usage", "maximum bytes the cache may use"},
+                        }},
                         {RPCResult::Type::NUM, "connections", "the total number of connections"},
                         {RPCResult::Type::NUM, "connections_in", "the number of inbound connections"},
                         {RPCResult::Type::NUM, "connections_out", "the number of outbound connections"},
@@ -699,6 +725,14 @@ static RPCHelpMan getnetworkinfo()
         auto peerman_info{node.peerman->GetInfo()};
         obj.pushKV("localrelay", !peerman_info.ignores_incoming_txs);
         obj.pushKV("timeoffset", Ticks<std::chrono::seconds>(peerman_info.median_outbound_time_offset));
+        UniValue cache_stats(UniValue::VOBJ);
+        cache_stats.pushKV("hits", peerman_info.block_serve_cache.hits);
+        cache_stats.pushKV("misses", peerman_info.block_serve_cache.misses);
+        cache_stats.pushKV("bytes_saved", peerman_info.block_serve_cache.bytes_saved);
+        cache_stats.pushKV("entries", peerman_info.block_serve_cache.entries);
+        cache_stats.pushKV("usage", peerman_info.block_serve_cache.usage);
+        cache_stats.pushKV("max_usage", peerman_info.block_serve_cache.max_usage);
+        obj.pushKV("blockservecache", std::move(cache_stats));
     }
     if (node.connman) {
         obj.pushKV("networkactive", node.connman->GetNetworkActive());
@@ -15,7 +15,6 @@
 #include <util/hasher.h>
 
 #include <cstddef>
-#include <shared_mutex>
 #include <vector>
 
 class CPubKey;
@@ -41,9 +40,8 @@ private:
     //! Entries are SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature hash || public key || signature):
     CSHA256 m_salted_hasher_ecdsa;
     CSHA256 m_salted_hasher_schnorr;
-    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    typedef CuckooCache::sharded_cache<uint256, SignatureCacheHasher> map_type;
     map_type setValid;
-    std::shared_mutex cs_sigcache;
 
 public:
     SignatureCache(size_t max_size_bytes);
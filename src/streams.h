@@ -25,6 +25,7 @@
 #include <limits>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 /* Minimal stream for overwriting and/or appending to an existing byte vector
@@ -147,6 +148,8 @@ public:
     explicit DataStream() = default;
     explicit DataStream(std::span<const uint8_t> sp) : DataStream{std::as_bytes(sp)} {}
     explicit DataStream(std::span<const value_type> sp) : vch(sp.data(), sp.data() + sp.size()) {}
+    //! Take over an existing buffer, without copying its contents.
+    explicit DataStream(vector_type&& vch_in) noexcept : vch(std::move(vch_in)) {}
 
     std::string str() const
     {
@@ -171,6 +174,13 @@ public:
     value_type* data()                               { return vch.data() + m_read_pos; }
     const value_type* data() const                   { return vch.data() + m_read_pos; }
 
+    //! Take the underlying buffer (including any bytes already read) out of the stream, leaving it empty.
+    vector_type ReleaseBuffer() noexcept
+    {
+        m_read_pos = 0;
+        return std::exchange(vch, {});
+    }
+
     inline void Compact()
     {
         vch.erase(vch.begin(), vch.begin() + m_read_pos);
@@ -268,6 +268,85 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     filter_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_parallel_build, BuildChainTestingSetup)
+{
+    // Filters built in batches on several threads must match the ones built one block at a time.
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true,
+                                  /*f_wipe=*/false, /*filter_build_threads=*/3);
+    BOOST_REQUIRE(filter_index.Init());
+    filter_index.Sync();
+
+    uint256 last_header;
+    LOCK(cs_main);
+    for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+         block_index != nullptr;
+         block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+        CheckFilterLookups(filter_index, block_index, last_header, m_node.chainman->m_blockman);
+    }
+
+    filter_index.Interrupt();
+    filter_index.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_recent_headers_reorg, BuildChainTestingSetup)
+{
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true);
+    BOOST_REQUIRE(filter_index.Init());
+    filter_index.Sync();
+
+    const CBlockIndex* tip{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+    uint256 tip_header;
+    BOOST_REQUIRE(filter_index.LookupFilterHeader(tip, tip_header));
+
+    const CScript coinbase_script_pub_key_A{GetScriptForDestination(PKHash(GenerateRandomKey().GetPubKey()))};
+    const CScript coinbase_script_pub_key_B{GetScriptForDestination(PKHash(GenerateRandomKey().GetPubKey()))};
+    std::vector<std::shared_ptr<CBlock>> chainA, chainB;
+    BOOST_REQUIRE(BuildChain(tip, coinbase_script_pub_key_A, 3, chainA));
+    BOOST_REQUIRE(BuildChain(tip, coinbase_script_pub_key_B, 4, chainB));
+
+    const auto lookup_block_index{[&](const CBlock& block) {
+        return WITH_LOCK(cs_main, return m_node.chainman->m_blockman.LookupBlockIndex(block.GetHash()));
+    }};
+
+    // Connect chain A, so its headers end up in the recent headers cache.
+    for (const auto& block : chainA) {
+        BOOST_REQUIRE(Assert(m_node.chainman)->ProcessNewBlock(block, true, true, nullptr));
+    }
+    BOOST_REQUIRE(filter_index.BlockUntilSyncedToCurrentChain());
+    std::vector<uint256> chainA_headers;
+    uint256 last_header{tip_header};
+    for (const auto& block : chainA) {
+        CheckFilterLookups(filter_index, lookup_block_index(*block), last_header, m_node.chainman->m_blockman);
+        chainA_headers.push_back(last_header);
+    }
+
+    // Reorg to chain B, which overwrites the cached headers at the heights of chain A.
+    for (const auto& block : chainB) {
+        BOOST_REQUIRE(Assert(m_node.chainman)->ProcessNewBlock(block, true, true, nullptr));
+    }
+    BOOST_REQUIRE(filter_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()),
+                      chainB.back()->GetHash());
+    std::vector<uint256> chainB_headers;
+    last_header = tip_header;
+    for (const auto& block : chainB) {
+        CheckFilterLookups(filter_index, lookup_block_index(*block), last_header, m_node.chainman->m_blockman);
+        chainB_headers.push_back(last_header);
+    }
+
+    // The stale blocks of chain A must still get their own headers, not the cached ones of the
+    // chain B blocks at the same heights.
+    for (size_t i{0}; i < chainA.size(); ++i) {
+        uint256 header;
+        BOOST_CHECK(filter_index.LookupFilterHeader(lookup_block_index(*chainA[i]), header));
+        BOOST_CHECK_EQUAL(header, chainA_headers[i]);
+        BOOST_CHECK(header != chainB_headers[i]);
+    }
+
+    filter_index.Interrupt();
+    filter_index.Stop();
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
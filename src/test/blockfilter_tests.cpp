@@ -6,6 +6,7 @@
 #include <test/util/setup_common.h>
 
 #include <blockfilter.h>
+#include <blockview.h>
 #include <core_io.h>
 #include <primitives/block.h>
 #include <serialize.h>
@@ -173,9 +174,67 @@ BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 
         uint256 computed_header_basic = computed_filter_basic.ComputeHeader(prev_filter_header_basic);
         BOOST_CHECK(computed_header_basic == filter_header_basic);
+
+        // The same filter results from a lazily parsed view of the block.
+        DataStream block_data;
+        block_data << TX_WITH_WITNESS(block);
+        const BlockView block_view{block_data};
+        BOOST_CHECK(block_view.GetHash() == block.GetHash());
+        BlockFilter view_filter_basic(BlockFilterType::BASIC, block_view, block_undo);
+        BOOST_CHECK(view_filter_basic.GetFilter().GetEncoded() == filter_basic);
     }
 }
 
+BOOST_AUTO_TEST_CASE(blockview_test)
+{
+    CBlock block;
+    block.nVersion = 4;
+    block.nTime = 1231006505;
+
+    CMutableTransaction coinbase;
+    coinbase.vin.emplace_back();
+    coinbase.vin[0].scriptSig = CScript() << OP_0 << OP_0;
+    coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+    coinbase.vout.emplace_back(0, CScript() << OP_RETURN << std::vector<unsigned char>(36, 0xaa));
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    CMutableTransaction segwit;
+    segwit.vin.emplace_back(COutPoint{block.vtx[0]->GetHash(), 0});
+    segwit.vin.emplace_back(COutPoint{block.vtx[0]->GetHash(), 1});
+    segwit.vin[1].scriptWitness.stack = {{0x01, 0x02}, {}, std::vector<unsigned char>(100, 0x03)};
+    segwit.vout.emplace_back(COIN, CScript() << OP_1 << std::vector<unsigned char>(32, 0x04));
+    segwit.nLockTime = 42;
+    block.vtx.push_back(MakeTransactionRef(segwit));
+
+    // A transaction without inputs and outputs is serialized without the segwit marker.
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction{}));
+
+    DataStream block_data;
+    block_data << TX_WITH_WITNESS(block);
+    const BlockView view{block_data};
+    BOOST_CHECK(view.GetHash() == block.GetHash());
+    BOOST_REQUIRE_EQUAL(view.TxCount(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        BOOST_CHECK(view.GetTxid(i) == tx.GetHash());
+        DataStream tx_data;
+        tx_data << TX_WITH_WITNESS(tx);
+        BOOST_CHECK(std::ranges::equal(view.TxData(i), std::span{tx_data}));
+        size_t output{0};
+        view.ForEachOutput(i, [&](CAmount value, std::span<const unsigned char> script) {
+            BOOST_REQUIRE(output < tx.vout.size());
+            BOOST_CHECK_EQUAL(value, tx.vout[output].nValue);
+            BOOST_CHECK(std::ranges::equal(script, tx.vout[output].scriptPubKey));
+            ++output;
+        });
+        BOOST_CHECK_EQUAL(output, tx.vout.size());
+    }
+
+    // Malformed data fails like deserializing a CBlock does.
+    const std::span<const std::byte> truncated{std::span{block_data}.first(block_data.size() - 1)};
+    BOOST_CHECK_THROW(BlockView{truncated}, std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(blockfilter_type_names)
 {
     BOOST_CHECK_EQUAL(BlockFilterTypeName(BlockFilterType::BASIC), "basic");
@@ -0,0 +1,100 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <net.h>
+#include <node/blockservecache.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using node::BlockServeCache;
+
+namespace {
+//! Drain all bytes a transport has to send for one message.
+std::vector<unsigned char> SendMessage(CSerializedNetMsg msg)
+{
+    V1Transport transport{/*node_id=*/0};
+    BOOST_REQUIRE(transport.SetMessageToSend(msg));
+    std::vector<unsigned char> sent;
+    while (true) {
+        const auto [to_send, more, msg_type]{transport.GetBytesToSend(/*have_next_message=*/false)};
+        if (to_send.empty()) break;
+        sent.insert(sent.end(), to_send.begin(), to_send.end());
+        transport.MarkBytesSent(to_send.size());
+    }
+    return sent;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(blockservecache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(lookup_and_eviction)
+{
+    BlockServeCache cache{/*max_usage=*/300};
+    const uint256 a{m_rng.rand256()}, b{m_rng.rand256()}, c{m_rng.rand256()};
+
+    BOOST_CHECK(!cache.Get(a, /*witness=*/true));
+    const auto payload_a{cache.Add(a, /*witness=*/true, std::vector<unsigned char>(100, 0xaa))};
+    BOOST_CHECK(cache.Get(a, /*witness=*/true) == payload_a);
+    // The witness-stripped serialization is cached separately.
+    BOOST_CHECK(!cache.Get(a, /*witness=*/false));
+    cache.Add(a, /*witness=*/false, std::vector<unsigned char>(80, 0xab));
+    cache.Add(b, /*witness=*/true, std::vector<unsigned char>(100, 0xbb));
+
+    auto stats{cache.GetStats()};
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 2U);
+    BOOST_CHECK_EQUAL(stats.bytes_saved, 100U);
+    BOOST_CHECK_EQUAL(stats.entries, 3U);
+    BOOST_CHECK_EQUAL(stats.usage, 280U);
+
+    // Using the witness serialization of a makes its witness-stripped one the
+    // least recently used entry, which gets evicted to make room for c.
+    BOOST_CHECK(cache.Get(a, /*witness=*/true));
+    cache.Add(c, /*witness=*/true, std::vector<unsigned char>(100, 0xcc));
+    BOOST_CHECK(!cache.Get(a, /*witness=*/false));
+    BOOST_CHECK(cache.Get(a, /*witness=*/true));
+    BOOST_CHECK(cache.Get(b, /*witness=*/true));
+    BOOST_CHECK(cache.Get(c, /*witness=*/true));
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 3U);
+    BOOST_CHECK_EQUAL(stats.usage, 300U);
+
+    // A block larger than the budget is returned, but not cached.
+    const auto large{cache.Add(m_rng.rand256(), /*witness=*/true, std::vector<unsigned char>(301))};
+    BOOST_CHECK_EQUAL(large->data.size(), 301U);
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 3U);
+
+    // Evicted payloads stay valid for messages still referring to them.
+    cache.Add(m_rng.rand256(), /*witness=*/true, std::vector<unsigned char>(300));
+    BOOST_CHECK(!cache.Get(a, /*witness=*/true));
+    BOOST_CHECK(payload_a->data == std::vector<unsigned char>(100, 0xaa));
+}
+
+BOOST_AUTO_TEST_CASE(shared_payload_send)
+{
+    const auto data{m_rng.randbytes<unsigned char>(1000)};
+
+    CSerializedNetMsg owned;
+    owned.m_type = NetMsgType::BLOCK;
+    owned.data = data;
+
+    CSerializedNetMsg shared;
+    shared.m_type = NetMsgType::BLOCK;
+    shared.m_shared_payload = std::make_shared<const SharedNetMsgPayload>(data);
+    auto copy{shared.Copy()};
+    BOOST_CHECK(copy.m_shared_payload == shared.m_shared_payload);
+
+    // A shared payload goes out exactly like an owned one, with its memory
+    // accounted to every message referring to it.
+    BOOST_CHECK(shared.GetMemoryUsage() > data.size());
+    const auto expected{SendMessage(std::move(owned))};
+    BOOST_CHECK(SendMessage(std::move(shared)) == expected);
+    BOOST_CHECK(SendMessage(std::move(copy)) == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -214,6 +214,30 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Random)
     Correct_Queue_range(range);
 }
 
+/** Test that checks added in one large batch are spread over the workers,
+ * which may be pinned to CPUs, and each run once
+ */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Stealing)
+{
+    for (const bool pin_threads : {false, true}) {
+        WITH_LOCK(UniqueCheck::m, UniqueCheck::results.clear());
+        auto queue = std::make_unique<Unique_Queue>(QUEUE_BATCH_SIZE, SCRIPT_CHECK_THREADS, "Test", "test", pin_threads);
+        const size_t COUNT = 10000;
+        {
+            CCheckQueueControl<UniqueCheck> control(*queue);
+            std::vector<UniqueCheck> vChecks;
+            for (size_t i = 0; i < COUNT; ++i) vChecks.emplace_back(i);
+            control.Add(std::move(vChecks));
+            BOOST_REQUIRE(!control.Complete().has_value());
+        }
+        LOCK(UniqueCheck::m);
+        BOOST_REQUIRE_EQUAL(UniqueCheck::results.size(), COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            BOOST_REQUIRE_EQUAL(UniqueCheck::results.count(i), 1U);
+        }
+        UniqueCheck::results.clear();
+    }
+}
 
 /** Test that distinct failing checks are caught */
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure)
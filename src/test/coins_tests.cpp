@@ -1060,6 +1060,97 @@ BOOST_FIXTURE_TEST_CASE(ccoins_flush_behavior, FlushTest)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(ccoins_compact, BasicTestingSetup)
+{
+    CCoinsViewTest base{m_rng};
+
+    // Common templates with round amounts, plus a bare script too large to be stored inline.
+    const uint160 hash160{m_rng.randbytes(20)};
+    const std::vector<CScript> scripts{
+        GetScriptForDestination(PKHash{hash160}),
+        GetScriptForDestination(ScriptHash{hash160}),
+        GetScriptForDestination(WitnessV0KeyHash{hash160}),
+        GetScriptForDestination(WitnessV0ScriptHash{m_rng.rand256()}),
+        GetScriptForDestination(WitnessV1Taproot{XOnlyPubKey{m_rng.rand256()}}),
+        CScript() << std::vector<unsigned char>(100, 0x01) << OP_DROP << OP_TRUE,
+    };
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    {
+        CCoinsViewCacheTest writer{&base};
+        for (size_t i{0}; i < 50'000; ++i) {
+            const COutPoint outpoint{Txid::FromUint256(m_rng.rand256()), uint32_t(i % 4)};
+            Coin coin{CTxOut{CAmount(m_rng.randrange(100'000) * 1'000), scripts[i % scripts.size()]}, int(m_rng.randrange(1'000'000)), m_rng.randbool()};
+            writer.AddCoin(outpoint, Coin{coin}, /*possible_overwrite=*/false);
+            coins.emplace_back(outpoint, std::move(coin));
+        }
+        BOOST_CHECK(writer.Flush());
+    }
+
+    // Read the coins the way child caches do, until the cache outgrows a fixed size.
+    static constexpr size_t CACHE_SIZE_LIMIT{4 << 20};
+    const auto coins_fitting{[&](CCoinsViewCacheTest& cache) {
+        size_t count{0};
+        for (const auto& [outpoint, coin] : coins) {
+            BOOST_CHECK(cache.GetCoin(outpoint).value_or(Coin{}) == coin);
+            if (cache.DynamicMemoryUsage() > CACHE_SIZE_LIMIT) break;
+            ++count;
+        }
+        return count;
+    }};
+    CCoinsViewCacheTest plain{&base};
+    CCoinsViewCacheTest cache{&base};
+    cache.EnableCompactCoins();
+    const size_t plain_count{coins_fitting(plain)};
+    const size_t compact_count{coins_fitting(cache)};
+    BOOST_CHECK_LT(plain_count, coins.size());
+    BOOST_CHECK_GT(compact_count, plain_count + plain_count / 10);
+    // The coins were stored compactly as they were read.
+    BOOST_CHECK(cache.map().empty());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), std::min(compact_count + 1, coins.size()));
+    cache.SanityCheck();
+
+    // Compacted coins are expanded on access, without touching the base view.
+    for (size_t i{0}; i < 100; ++i) {
+        const auto& [outpoint, coin]{coins[i]};
+        BOOST_CHECK(cache.HaveCoinInCache(outpoint));
+        BOOST_CHECK(cache.HaveCoin(outpoint));
+        BOOST_CHECK(cache.AccessCoin(outpoint) == coin);
+        BOOST_CHECK(!cache.map().at(outpoint).IsDirty());
+    }
+    cache.SanityCheck();
+
+    // Spending a compacted coin is synced to the base view like any other spend,
+    // and the coins added meanwhile are kept compactly.
+    const auto& [spent_outpoint, spent_coin]{coins[100]};
+    Coin moved;
+    BOOST_CHECK(cache.SpendCoin(spent_outpoint, &moved));
+    BOOST_CHECK(moved == spent_coin);
+    BOOST_CHECK_THROW(cache.AddCoin(coins[101].first, Coin{coins[101].second}, /*possible_overwrite=*/false), std::logic_error);
+    const COutPoint added_outpoint{Txid::FromUint256(m_rng.rand256()), 0};
+    const Coin added_coin{CTxOut{COIN, scripts[3]}, 1, false};
+    cache.AddCoin(added_outpoint, Coin{added_coin}, /*possible_overwrite=*/false);
+    // A snapshot coin does not replace a compacted one.
+    cache.EmplaceCoinInternalDANGER(COutPoint{coins[102].first}, Coin{added_coin});
+    BOOST_CHECK(cache.Sync());
+    cache.SanityCheck();
+    BOOST_CHECK(!cache.map().contains(added_outpoint));
+    BOOST_CHECK(cache.HaveCoinInCache(added_outpoint));
+    BOOST_CHECK(!cache.HaveCoinInCache(spent_outpoint));
+    BOOST_CHECK(cache.GetCoin(coins[102].first).value_or(Coin{}) == coins[102].second);
+    BOOST_CHECK(base.GetCoin(added_outpoint).value_or(Coin{}) == added_coin);
+    const auto base_coin{base.GetCoin(spent_outpoint)};
+    BOOST_CHECK(!base_coin || base_coin->IsSpent());
+
+    cache.Uncache(coins[103].first);
+    BOOST_CHECK(!cache.HaveCoinInCache(coins[103].first));
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    // The cache keeps storing coins compactly after a flush.
+    BOOST_CHECK(cache.GetCoin(coins[103].first).value_or(Coin{}) == coins[103].second);
+    BOOST_CHECK(cache.map().empty());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 1U);
+}
+
 BOOST_AUTO_TEST_CASE(coins_resource_is_used)
 {
     CCoinsMapMemoryResource resource;
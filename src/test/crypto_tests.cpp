@@ -848,6 +848,66 @@ BOOST_AUTO_TEST_CASE(chacha20_midblock)
     BOOST_CHECK(std::ranges::equal(std::span{block}.last(52), b3));
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_implementations)
+{
+    // Compare the multi-block implementations with the standard one, including around the
+    // block counter overflow, which they leave to the standard one.
+    for (const uint32_t block_counter : {uint32_t{0}, uint32_t{0xfffffffa}, uint32_t{0xfffffff0}}) {
+        const auto key{m_rng.randbytes<std::byte>(ChaCha20::KEYLEN)};
+        const ChaCha20::Nonce96 nonce{m_rng.rand32(), m_rng.rand64()};
+        const auto input{m_rng.randbytes<std::byte>(64 * 40 + m_rng.randrange(64))};
+        std::vector<std::byte> expected(input.size());
+        ChaCha20AutoDetect(chacha20_implementation::STANDARD);
+        ChaCha20 ctx{key};
+        ctx.Seek(nonce, block_counter);
+        ctx.Crypt(input, expected);
+        for (const auto use : {chacha20_implementation::USE_SSE41, chacha20_implementation::USE_AVX2, chacha20_implementation::USE_ALL}) {
+            BOOST_TEST_MESSAGE("Using the '" << ChaCha20AutoDetect(use) << "' ChaCha20 implementation");
+            // Crypt in place, in pieces of random size.
+            std::vector<std::byte> output{input};
+            ChaCha20 c20{key};
+            c20.Seek(nonce, block_counter);
+            for (std::span<std::byte> left{output}; !left.empty();) {
+                const auto piece{left.first(std::min<size_t>(left.size(), m_rng.randrange(64 * 20)))};
+                c20.Crypt(piece, piece);
+                left = left.subspan(piece.size());
+            }
+            BOOST_CHECK(output == expected);
+            // The keystream is the encryption of zeros.
+            std::vector<std::byte> keystream(input.size());
+            c20.Seek(nonce, block_counter);
+            c20.Keystream(keystream);
+            for (size_t i = 0; i < input.size(); ++i) keystream[i] ^= input[i];
+            BOOST_CHECK(keystream == expected);
+        }
+    }
+    ChaCha20AutoDetect();
+}
+
+BOOST_AUTO_TEST_CASE(poly1305_implementations)
+{
+    for (int i = 0; i < 20; ++i) {
+        // Start with the largest possible key and message limbs.
+        const auto key{i == 0 ? std::vector<std::byte>(Poly1305::KEYLEN, std::byte{0xff}) : m_rng.randbytes<std::byte>(Poly1305::KEYLEN)};
+        const auto msg{i == 0 ? std::vector<std::byte>(2048, std::byte{0xff}) : m_rng.randbytes<std::byte>(m_rng.randrange(2048))};
+        std::vector<std::byte> expected(Poly1305::TAGLEN), tag(Poly1305::TAGLEN);
+        Poly1305AutoDetect(poly1305_implementation::STANDARD);
+        Poly1305{key}.Update(msg).Finalize(expected);
+        BOOST_TEST_MESSAGE("Using the '" << Poly1305AutoDetect() << "' Poly1305 implementation");
+        // Update in pieces of random size, so the multi-block implementation sees unaligned input
+        // and a partially filled buffer.
+        Poly1305 poly1305{key};
+        for (std::span<const std::byte> left{msg}; !left.empty();) {
+            const auto piece{left.first(std::min<size_t>(left.size(), m_rng.randrange(1024)))};
+            poly1305.Update(piece);
+            left = left.subspan(piece.size());
+        }
+        poly1305.Finalize(tag);
+        BOOST_CHECK(tag == expected);
+    }
+    Poly1305AutoDetect();
+}
+
 BOOST_AUTO_TEST_CASE(poly1305_testvector)
 {
     // RFC 7539, section 2.5.2.
@@ -10,6 +10,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <deque>
 #include <mutex>
 #include <shared_mutex>
@@ -121,6 +122,17 @@ BOOST_FIXTURE_TEST_CASE(cuckoocache_hit_rate_ok, HitRateTest)
     }
 }
 
+/** Check the hit rate of the sharded cache on the same loads */
+BOOST_FIXTURE_TEST_CASE(cuckoocache_sharded_hit_rate_ok, HitRateTest)
+{
+    double HitRateThresh = 0.98;
+    size_t megabytes = 4;
+    for (double load = 0.1; load < 2; load *= 2) {
+        double hits = test_cache<CuckooCache::sharded_cache<uint256, SignatureCacheHasher>>(megabytes, load);
+        BOOST_CHECK(normalize_hit_rate(hits, load) > HitRateThresh);
+    }
+}
+
 
 struct EraseTest : BasicTestingSetup {
 /** This helper checks that erased elements are preferentially inserted onto and
@@ -189,6 +201,12 @@ BOOST_FIXTURE_TEST_CASE(cuckoocache_erase_ok, EraseTest)
     test_cache_erase<CuckooCache::cache<uint256, SignatureCacheHasher>>(megabytes);
 }
 
+BOOST_FIXTURE_TEST_CASE(cuckoocache_sharded_erase_ok, EraseTest)
+{
+    size_t megabytes = 4;
+    test_cache_erase<CuckooCache::sharded_cache<uint256, SignatureCacheHasher>>(megabytes);
+}
+
 struct EraseParallelTest : BasicTestingSetup {
 template <typename Cache>
 void test_cache_erase_parallel(size_t megabytes)
@@ -379,4 +397,50 @@ BOOST_FIXTURE_TEST_CASE(cuckoocache_generations, GenerationsTest)
     test_cache_generations<CuckooCache::cache<uint256, SignatureCacheHasher>>();
 }
 
+BOOST_FIXTURE_TEST_CASE(cuckoocache_sharded_generations, GenerationsTest)
+{
+    test_cache_generations<CuckooCache::sharded_cache<uint256, SignatureCacheHasher>>();
+}
+
+/* Test that the sharded cache can be used from several threads at once without
+ * external locking.
+ */
+BOOST_AUTO_TEST_CASE(cuckoocache_sharded_parallel)
+{
+    SeedRandomForTest(SeedRand::ZEROS);
+    using Cache = CuckooCache::sharded_cache<uint256, SignatureCacheHasher>;
+    Cache set{};
+    size_t bytes = 4 << 20;
+    set.setup_bytes(bytes);
+    BOOST_CHECK_EQUAL(set.num_shards(), Cache::max_shards);
+
+    uint32_t n_insert = static_cast<uint32_t>(bytes / sizeof(uint256) / 2);
+    std::vector<uint256> hashes(n_insert);
+    for (auto& hash : hashes) hash = m_rng.rand256();
+
+    /** Each thread inserts its share of the elements and looks them up right away */
+    std::atomic<uint32_t> count_found{0};
+    std::vector<std::thread> threads;
+    for (uint32_t x = 0; x < 4; ++x) {
+        threads.emplace_back([&, x] {
+            for (uint32_t i = x; i < n_insert; i += 4) {
+                set.insert(hashes[i]);
+                count_found += set.contains(hashes[i], false);
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    uint32_t count = 0;
+    for (const uint256& h : hashes)
+        count += set.contains(h, false);
+    BOOST_CHECK(double(count_found) / n_insert > 0.98);
+    BOOST_CHECK(double(count) / n_insert > 0.98);
+
+    /** Small caches are not split */
+    Cache small{};
+    small.setup_bytes(0);
+    BOOST_CHECK_EQUAL(small.num_shards(), 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -172,6 +172,16 @@ ssize_t FuzzedSock::Send(const void* data, size_t len, int flags) const
     return r;
 }
 
+ssize_t FuzzedSock::SendV(std::span<const std::span<const unsigned char>> chunks, int flags) const
+{
+    // Like Send(), the outcome only depends on the total size of the data.
+    size_t len{0};
+    for (const auto& chunk : chunks.first(std::min(chunks.size(), MAX_SEND_CHUNKS))) {
+        len += chunk.size();
+    }
+    return Send(nullptr, len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void* buf, size_t len, int flags) const
 {
     // Have a permanent error at recv_errnos[0] because when the fuzzed data is exhausted
@@ -4,7 +4,9 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <checkqueue.h>
 #include <consensus/params.h>
+#include <consensus/validation.h>
 #include <headerssync.h>
 #include <pow.h>
 #include <test/util/setup_common.h>
@@ -143,4 +145,56 @@ BOOST_AUTO_TEST_CASE(headers_sync_state)
     BOOST_CHECK(result.success);
 }
 
+// Check that the proof of work of a headers message is checked the same way
+// with and without worker threads, and that the hashes computed on the way
+// can be passed on to HeadersSyncState and ProcessNewBlockHeaders.
+BOOST_AUTO_TEST_CASE(header_pow_checks)
+{
+    const auto& consensus{Params().GetConsensus()};
+    const size_t count{2000};
+    std::vector<CBlockHeader> headers;
+    // A version the block index accepts after the BIP34, BIP66 and BIP65 heights.
+    GenerateHeaders(headers, count, Params().GenesisBlock().GetHash(),
+            /*nVersion=*/4, Params().GenesisBlock().nTime,
+            ArithToUint256(0), Params().GenesisBlock().nBits);
+
+    CCheckQueue<HeaderPoWCheck> queue{/*batch_size=*/64, /*worker_threads_num=*/3, "Header proof of work checks", "hdrchk"};
+    std::vector<uint256> serial_hashes;
+    std::vector<uint256> parallel_hashes;
+    BOOST_CHECK(CheckHeadersProofOfWork(headers, serial_hashes, consensus));
+    BOOST_CHECK(CheckHeadersProofOfWork(headers, parallel_hashes, consensus, &queue));
+    BOOST_REQUIRE_EQUAL(serial_hashes.size(), count);
+    BOOST_CHECK(serial_hashes == parallel_hashes);
+    for (size_t i{0}; i < count; ++i) {
+        BOOST_CHECK_EQUAL(serial_hashes[i], headers[i].GetHash());
+    }
+
+    // A single header with too little work fails the whole message.
+    std::vector<CBlockHeader> invalid{headers};
+    invalid[count / 2].nBits = 0x1d00ffff;
+    BOOST_CHECK(!CheckHeadersProofOfWork(invalid, parallel_hashes, consensus, &queue));
+    BOOST_CHECK(!CheckHeadersProofOfWork(invalid, serial_hashes, consensus));
+
+    // The precomputed hashes lead to the same headers sync as hashing again.
+    const CBlockIndex* chain_start = WITH_LOCK(::cs_main, return m_node.chainman->m_blockman.LookupBlockIndex(Params().GenesisBlock().GetHash()));
+    const arith_uint256 chain_work{count};
+    BOOST_CHECK(CheckHeadersProofOfWork(headers, parallel_hashes, consensus, &queue));
+    HeadersSyncState hss{0, consensus, chain_start, chain_work};
+    auto result{hss.ProcessNextHeaders(headers, true, parallel_hashes)};
+    BOOST_CHECK(result.success);
+    BOOST_CHECK(hss.GetState() == HeadersSyncState::State::REDOWNLOAD);
+    result = hss.ProcessNextHeaders(headers, false, parallel_hashes);
+    BOOST_CHECK(result.success);
+    BOOST_REQUIRE_EQUAL(result.pow_validated_headers.size(), count);
+    BOOST_CHECK(result.pow_validated_hashes == parallel_hashes);
+
+    // Accept the headers into the block index without hashing them again.
+    BlockValidationState state;
+    const CBlockIndex* last{nullptr};
+    BOOST_CHECK(m_node.chainman->ProcessNewBlockHeaders(result.pow_validated_headers, /*min_pow_checked=*/true, state, &last, result.pow_validated_hashes));
+    BOOST_REQUIRE(last);
+    BOOST_CHECK_EQUAL(last->GetBlockHash(), headers.back().GetHash());
+    BOOST_CHECK_EQUAL(last->nHeight, int(count));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -804,4 +804,89 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolTrimDescendantStateTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // A chain below a high fee transaction, where tc has the lowest
+    // descendant score and is evicted together with its child td.
+    const CTransactionRef ta{make_tx(/*output_values=*/{10 * COIN})};
+    const CTransactionRef tb{make_tx(/*output_values=*/{9 * COIN}, /*inputs=*/{ta})};
+    const CTransactionRef tc{make_tx(/*output_values=*/{8 * COIN}, /*inputs=*/{tb})};
+    const CTransactionRef td{make_tx(/*output_values=*/{7 * COIN}, /*inputs=*/{tc})};
+    AddToMempool(pool, entry.Fee(50000LL).FromTx(ta));
+    AddToMempool(pool, entry.Fee(250LL).FromTx(tb));
+    AddToMempool(pool, entry.Fee(100LL).FromTx(tc));
+    AddToMempool(pool, entry.Fee(300LL).FromTx(td));
+    const int64_t size_a{(*pool.GetIter(ta->GetHash()))->GetTxSize()};
+    const int64_t size_b{(*pool.GetIter(tb->GetHash()))->GetTxSize()};
+
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(!pool.exists(tc->GetHash()));
+    BOOST_CHECK(!pool.exists(td->GetHash()));
+    // The remaining ancestors only account for the remaining descendants.
+    const auto a_it{*pool.GetIter(ta->GetHash())};
+    const auto b_it{*pool.GetIter(tb->GetHash())};
+    BOOST_CHECK_EQUAL(a_it->GetCountWithDescendants(), 2U);
+    BOOST_CHECK_EQUAL(a_it->GetSizeWithDescendants(), size_a + size_b);
+    BOOST_CHECK_EQUAL(a_it->GetModFeesWithDescendants(), 50250);
+    BOOST_CHECK_EQUAL(b_it->GetCountWithDescendants(), 1U);
+    BOOST_CHECK_EQUAL(b_it->GetSizeWithDescendants(), size_b);
+    BOOST_CHECK_EQUAL(b_it->GetModFeesWithDescendants(), 250);
+    BOOST_CHECK_EQUAL(b_it->GetCountWithAncestors(), 2U);
+    BOOST_CHECK(a_it->GetMemPoolChildrenConst().size() == 1);
+    BOOST_CHECK(b_it->GetMemPoolChildrenConst().empty());
+
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(!pool.exists(tb->GetHash()));
+    BOOST_CHECK_EQUAL(a_it->GetCountWithDescendants(), 1U);
+    BOOST_CHECK_EQUAL(a_it->GetSizeWithDescendants(), size_a);
+    BOOST_CHECK_EQUAL(a_it->GetModFeesWithDescendants(), 50000);
+    BOOST_CHECK(a_it->GetMemPoolChildrenConst().empty());
+}
+
+BOOST_AUTO_TEST_CASE(MempoolRemoveForBlockStateTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // tc spends both ta and tb, td spends tc, and tconflict spends the same
+    // output of tb as tx, which is not in the mempool.
+    const CTransactionRef ta{make_tx(/*output_values=*/{10 * COIN})};
+    const CTransactionRef tb{make_tx(/*output_values=*/{5 * COIN, 5 * COIN})};
+    const CTransactionRef tc{make_tx(/*output_values=*/{14 * COIN}, /*inputs=*/{ta, tb})};
+    const CTransactionRef td{make_tx(/*output_values=*/{13 * COIN}, /*inputs=*/{tc})};
+    const CTransactionRef tx{make_tx(/*output_values=*/{4 * COIN}, /*inputs=*/{tb}, /*input_indices=*/{1})};
+    const CTransactionRef tconflict{make_tx(/*output_values=*/{3 * COIN}, /*inputs=*/{tb}, /*input_indices=*/{1})};
+    AddToMempool(pool, entry.Fee(1000LL).SigOpsCost(4).FromTx(ta));
+    AddToMempool(pool, entry.Fee(2000LL).SigOpsCost(8).FromTx(tb));
+    AddToMempool(pool, entry.Fee(3000LL).SigOpsCost(1).FromTx(tc));
+    AddToMempool(pool, entry.Fee(4000LL).SigOpsCost(2).FromTx(td));
+    AddToMempool(pool, entry.Fee(5000LL).SigOpsCost(1).FromTx(tconflict));
+    const int64_t size_c{(*pool.GetIter(tc->GetHash()))->GetTxSize()};
+    const int64_t size_d{(*pool.GetIter(td->GetHash()))->GetTxSize()};
+    BOOST_CHECK_EQUAL((*pool.GetIter(td->GetHash()))->GetCountWithAncestors(), 4U);
+
+    pool.removeForBlock({ta, tb, tx}, 1);
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+    BOOST_CHECK(!pool.exists(tconflict->GetHash()));
+    // The remaining transactions no longer account for any of the confirmed
+    // ancestors.
+    const auto c_it{*pool.GetIter(tc->GetHash())};
+    const auto d_it{*pool.GetIter(td->GetHash())};
+    BOOST_CHECK_EQUAL(c_it->GetCountWithAncestors(), 1U);
+    BOOST_CHECK_EQUAL(c_it->GetSizeWithAncestors(), size_c);
+    BOOST_CHECK_EQUAL(c_it->GetModFeesWithAncestors(), 3000);
+    BOOST_CHECK_EQUAL(c_it->GetSigOpCostWithAncestors(), 1);
+    BOOST_CHECK_EQUAL(d_it->GetCountWithAncestors(), 2U);
+    BOOST_CHECK_EQUAL(d_it->GetSizeWithAncestors(), size_c + size_d);
+    BOOST_CHECK_EQUAL(d_it->GetModFeesWithAncestors(), 7000);
+    BOOST_CHECK_EQUAL(d_it->GetSigOpCostWithAncestors(), 3);
+    BOOST_CHECK_EQUAL(c_it->GetCountWithDescendants(), 2U);
+    BOOST_CHECK(c_it->GetMemPoolParentsConst().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -35,6 +35,7 @@ using namespace util::hex_literals;
 using interfaces::BlockTemplate;
 using interfaces::Mining;
 using node::BlockAssembler;
+using node::BlockTemplateCache;
 
 namespace miner_tests {
 struct MinerTestingSetup : public TestingSetup {
@@ -786,4 +787,74 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     TestPrioritisedMining(scriptPubKey, txFirst);
 }
 
+static std::vector<Txid> TemplateTxids(const node::CBlockTemplate& block_template)
+{
+    std::vector<Txid> txids;
+    for (size_t i{1}; i < block_template.block.vtx.size(); ++i) {
+        txids.push_back(block_template.block.vtx[i]->GetHash());
+    }
+    return txids;
+}
+
+BOOST_FIXTURE_TEST_CASE(block_template_cache, TestChain100Setup)
+{
+    BlockTemplateCache cache{*m_node.chainman, *m_node.mempool};
+    m_node.validation_signals->RegisterValidationInterface(&cache);
+    BlockAssembler::Options options;
+    options.coinbase_output_script = CScript() << OP_TRUE;
+
+    // The kept template must always match a template built from scratch.
+    const auto check_template{[&] {
+        m_node.validation_signals->SyncWithValidationInterfaceQueue();
+        const auto block_template{cache.Get(options)};
+        const auto expected{BlockAssembler{m_node.chainman->ActiveChainstate(), m_node.mempool.get(), options}.CreateNewBlock()};
+        BOOST_CHECK_EQUAL(block_template->block.hashPrevBlock, expected->block.hashPrevBlock);
+        BOOST_CHECK(TemplateTxids(*block_template) == TemplateTxids(*expected));
+        BOOST_CHECK(block_template->vTxFees == expected->vTxFees);
+        BOOST_CHECK_EQUAL(block_template->block.vtx[0]->GetValueOut(), expected->block.vtx[0]->GetValueOut());
+        if (options.defer_validity_check) {
+            // The validity of the template is checked in the background.
+            BOOST_CHECK(cache.WaitForValidation());
+        }
+        BOOST_CHECK(*block_template->validated);
+        return TemplateTxids(*block_template);
+    }};
+
+    const CScript script{GetScriptForDestination(WitnessV0KeyHash(coinbaseKey.GetPubKey()))};
+    const CAmount value{m_coinbase_txns[0]->vout[0].nValue / 4};
+    const CAmount high_fee{value / 10};
+    const auto parent{MakeTransactionRef(CreateValidMempoolTransaction({m_coinbase_txns[0]}, {COutPoint{m_coinbase_txns[0]->GetHash(), 0}}, /*input_height=*/1, {coinbaseKey},
+                                                                       {CTxOut{value, script}, CTxOut{value, script}, CTxOut{value, script}}))};
+    BOOST_CHECK(check_template() == std::vector{parent->GetHash()});
+    // Handing out the same template again.
+    BOOST_CHECK(check_template() == std::vector{parent->GetHash()});
+
+    options.defer_validity_check = true;
+
+    // A transaction paying less than everything in the template is appended.
+    const auto child_low{MakeTransactionRef(CreateValidMempoolTransaction(parent, /*input_vout=*/0, /*input_height=*/101, coinbaseKey, script, value - 1000))};
+    BOOST_CHECK((check_template() == std::vector{parent->GetHash(), child_low->GetHash()}));
+
+    // A transaction paying more than a selected one is put before it.
+    const auto child_high{MakeTransactionRef(CreateValidMempoolTransaction(parent, /*input_vout=*/1, /*input_height=*/101, coinbaseKey, script, value - high_fee))};
+    BOOST_CHECK((check_template() == std::vector{parent->GetHash(), child_high->GetHash(), child_low->GetHash()}));
+
+    // Prioritisation is not notified, but still taken into account.
+    m_node.mempool->PrioritiseTransaction(child_low->GetHash(), 2 * high_fee);
+    BOOST_CHECK((check_template() == std::vector{parent->GetHash(), child_low->GetHash(), child_high->GetHash()}));
+
+    // A selected transaction is removed.
+    {
+        LOCK2(cs_main, m_node.mempool->cs);
+        m_node.mempool->removeRecursive(*child_high, MemPoolRemovalReason::REPLACED);
+    }
+    BOOST_CHECK((check_template() == std::vector{parent->GetHash(), child_low->GetHash()}));
+
+    // A new tip.
+    CreateAndProcessBlock({}, script);
+    BOOST_CHECK((check_template() == std::vector{parent->GetHash(), child_low->GetHash()}));
+
+    m_node.validation_signals->UnregisterValidationInterface(&cache);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,10 +1,12 @@
 // Copyright (c) 2021 The Bitcoin Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include <node/bumpfeeoracle.h>
 #include <node/mini_miner.h>
 #include <random.h>
 #include <txmempool.h>
 #include <util/time.h>
+#include <validationinterface.h>
 
 #include <test/util/setup_common.h>
 #include <test/util/txmempool.h>
@@ -709,4 +711,87 @@ BOOST_FIXTURE_TEST_CASE(manual_ctor, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(bump_fee_oracle, TestChain100Setup)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    node::BumpFeeOracle oracle{pool};
+    m_node.validation_signals->RegisterValidationInterface(&oracle);
+    TestMemPoolEntryHelper entry;
+
+    // A low-feerate parent tx0 with a high-feerate child tx1, and a low-feerate parent tx2 with a
+    // low-feerate child tx3.
+    const auto tx0 = make_tx({COutPoint{m_coinbase_txns[0]->GetHash(), 0}}, /*num_outputs=*/2);
+    const auto tx1 = make_tx({COutPoint{tx0->GetHash(), 0}}, /*num_outputs=*/1);
+    const auto tx2 = make_tx({COutPoint{m_coinbase_txns[1]->GetHash(), 0}}, /*num_outputs=*/2);
+    const auto tx3 = make_tx({COutPoint{tx2->GetHash(), 0}}, /*num_outputs=*/1);
+    {
+        LOCK2(cs_main, pool.cs);
+        AddToMempool(pool, entry.Fee(low_fee).FromTx(tx0));
+        AddToMempool(pool, entry.Fee(high_fee).FromTx(tx1));
+        AddToMempool(pool, entry.Fee(low_fee).FromTx(tx2));
+        AddToMempool(pool, entry.Fee(low_fee).FromTx(tx3));
+    }
+
+    // Includes a spent outpoint, whose spender is to-be-replaced, and a nonexistent one.
+    const std::vector<COutPoint> outpoints{{tx0->GetHash(), 0}, {tx0->GetHash(), 1}, {tx1->GetHash(), 0},
+                                           {tx2->GetHash(), 1}, {tx3->GetHash(), 0}, {Txid::FromUint256(GetRandHash()), 0}};
+    const std::vector<CFeeRate> target_feerates{CFeeRate(2500), CFeeRate(0), CFeeRate(50000), CFeeRate(1000), CFeeRate(5*CENT), CFeeRate(2500)};
+
+    // The oracle must give the same results as a new MiniMiner for each target feerate.
+    const auto check_bump_fees{[&] {
+        const auto bump_fees{oracle.CalculateBumpFees(outpoints, target_feerates)};
+        BOOST_REQUIRE_EQUAL(bump_fees.size(), target_feerates.size());
+        for (size_t i{0}; i < target_feerates.size(); ++i) {
+            BOOST_CHECK(bump_fees[i] == node::MiniMiner(pool, outpoints).CalculateBumpFees(target_feerates[i]));
+            BOOST_CHECK_EQUAL(*Assert(oracle.CalculateTotalBumpFee(outpoints, target_feerates[i])),
+                              *Assert(node::MiniMiner(pool, outpoints).CalculateTotalBumpFees(target_feerates[i])));
+        }
+    }};
+
+    check_bump_fees();
+    BOOST_CHECK_EQUAL(oracle.Size(), 4U);
+
+    // Changes to the mempool that are not notified are found by comparing the kept clusters
+    // against the mempool.
+    pool.PrioritiseTransaction(tx3->GetHash(), high_fee);
+    check_bump_fees();
+    const auto tx4 = make_tx({COutPoint{tx2->GetHash(), 1}}, /*num_outputs=*/1);
+    {
+        LOCK2(cs_main, pool.cs);
+        AddToMempool(pool, entry.Fee(med_fee).FromTx(tx4));
+    }
+    check_bump_fees();
+    BOOST_CHECK_EQUAL(oracle.Size(), 5U);
+
+    // A notified change drops the cluster it changed.
+    {
+        LOCK(pool.cs);
+        pool.removeRecursive(*tx1, MemPoolRemovalReason::CONFLICT);
+    }
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    BOOST_CHECK_EQUAL(oracle.Size(), 3U);
+    check_bump_fees();
+    BOOST_CHECK_EQUAL(oracle.Size(), 4U);
+
+    // Like a MiniMiner, the oracle does not calculate bump fees for more than 500 transactions,
+    // even if they are spread across many clusters.
+    std::vector<COutPoint> many_outpoints;
+    for (size_t i{0}; i <= node::BumpFeeOracle::MAX_REQUEST_TRANSACTIONS; ++i) {
+        const auto tx = make_tx({COutPoint{Txid::FromUint256(GetRandHash()), 0}}, /*num_outputs=*/1);
+        {
+            LOCK2(cs_main, pool.cs);
+            AddToMempool(pool, entry.Fee(low_fee).FromTx(tx));
+        }
+        many_outpoints.emplace_back(tx->GetHash(), 0);
+    }
+    BOOST_CHECK(!node::MiniMiner(pool, many_outpoints).IsReadyToCalculate());
+    BOOST_CHECK(oracle.CalculateBumpFees(many_outpoints, target_feerates).empty());
+    BOOST_CHECK(!oracle.CalculateTotalBumpFee(many_outpoints, target_feerates[0]));
+    many_outpoints.pop_back();
+    BOOST_CHECK(node::MiniMiner(pool, many_outpoints).IsReadyToCalculate());
+    BOOST_CHECK_EQUAL(oracle.CalculateBumpFees(many_outpoints, target_feerates).size(), target_feerates.size());
+
+    m_node.validation_signals->UnregisterValidationInterface(&oracle);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
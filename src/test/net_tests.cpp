@@ -13,6 +13,7 @@
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <node/protocol_version.h>
+#include <node/recvbufferpool.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -26,6 +27,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
+#include <deque>
+#include <initializer_list>
 #include <ios>
 #include <memory>
 #include <optional>
@@ -1546,4 +1549,142 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+namespace {
+/** Move all bytes the sender has to send into the receiver, one GetBytesToSend() at a time. */
+void DeliverBytes(Transport& sender, Transport& receiver)
+{
+    while (true) {
+        const auto& [to_send, _more, _msg_type] = sender.GetBytesToSend(false);
+        if (to_send.empty()) break;
+        std::span<const uint8_t> to_recv{to_send};
+        const size_t len{to_recv.size()};
+        BOOST_REQUIRE(receiver.ReceivedBytes(to_recv));
+        sender.MarkBytesSent(len - to_recv.size());
+    }
+}
+
+/** Queue messages on sender and send them in batches of chunks, with partial sends, checking that
+ *  receiver gets them all, in order. */
+void CheckSendBatch(FastRandomContext& rng, Transport& sender, Transport& receiver)
+{
+    std::deque<CSerializedNetMsg> to_queue;
+    for (int i = 0; i < 40; ++i) {
+        // Include messages without payload, and long and short BIP324 message types.
+        const auto msg_type{i % 3 == 0 ? NetMsgType::VERACK : i % 3 == 1 ? NetMsgType::TX : NetMsgType::SENDTXRCNCL};
+        to_queue.push_back(NetMsg::Make(msg_type, rng.randbytes<uint8_t>(i % 3 == 0 ? 0 : rng.randrange(2000))));
+    }
+    std::deque<CSerializedNetMsg> expected;
+    for (const auto& msg : to_queue) expected.push_back(msg.Copy());
+
+    std::vector<Transport::SendChunk> chunks;
+    size_t max_queued{0};
+    while (!to_queue.empty() || !chunks.empty()) {
+        size_t queued{0};
+        while (!to_queue.empty() && sender.SetMessageToSend(to_queue.front())) {
+            to_queue.pop_front();
+            ++queued;
+        }
+        max_queued = std::max(max_queued, queued);
+        sender.GetBytesToSendBatch(!to_queue.empty(), chunks, 1 + rng.randrange(8));
+        if (chunks.empty()) continue;
+        std::vector<uint8_t> data;
+        for (const auto& chunk : chunks) {
+            BOOST_CHECK(!chunk.data.empty());
+            data.insert(data.end(), chunk.data.begin(), chunk.data.end());
+        }
+        // Send a random part of the batch, possibly ending in the middle of a chunk.
+        std::span<const uint8_t> to_recv{std::span{data}.first(1 + rng.randrange(data.size()))};
+        const size_t sent{to_recv.size()};
+        while (!to_recv.empty()) {
+            BOOST_REQUIRE(receiver.ReceivedBytes(to_recv));
+            if (receiver.ReceivedMessageComplete()) {
+                bool reject{false};
+                CNetMessage msg{receiver.GetReceivedMessage({}, reject)};
+                BOOST_REQUIRE(!reject && !expected.empty());
+                BOOST_CHECK_EQUAL(msg.m_type, expected.front().m_type);
+                BOOST_CHECK(std::ranges::equal(MakeUCharSpan(msg.m_recv), expected.front().data));
+                expected.pop_front();
+            }
+        }
+        sender.MarkBytesSent(sent);
+        sender.GetBytesToSendBatch(false, chunks, Sock::MAX_SEND_CHUNKS);
+    }
+    BOOST_CHECK(expected.empty());
+    // Messages were actually batched.
+    BOOST_CHECK_GT(max_queued, 1U);
+    BOOST_CHECK_LE(max_queued, Transport::MAX_SEND_BATCH_MESSAGES);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(transport_send_batch)
+{
+    {
+        V1Transport sender{0}, receiver{1};
+        CheckSendBatch(m_rng, sender, receiver);
+    }
+    {
+        V2Transport sender{0, /*initiating=*/true}, receiver{1, /*initiating=*/false};
+        // Complete the handshake: keys, garbage, garbage terminators and version packets.
+        for (int i = 0; i < 3; ++i) {
+            DeliverBytes(sender, receiver);
+            DeliverBytes(receiver, sender);
+        }
+        BOOST_REQUIRE(sender.GetInfo().transport_type == TransportProtocolType::V2);
+        CheckSendBatch(m_rng, sender, receiver);
+    }
+}
+
+namespace {
+/** Send messages of various sizes from sender to receiver, checking that large payloads are
+ *  received into buffers from the pool, and that those are returned to it afterwards. */
+void CheckRecvBufferPool(FastRandomContext& rng, Transport& sender, Transport& receiver, const node::RecvBufferPool& pool)
+{
+    // Payload sizes, and whether a buffer returned by an earlier message fits them.
+    for (const auto& [size, reuse] : std::initializer_list<std::pair<size_t, bool>>{
+             {100'000, false}, {100'000, true}, {10, false}, {150'000, false}, {60'000, true}, {0, false}}) {
+        const bool pooled{size >= node::RecvBufferPool::MIN_POOLED_CAPACITY};
+        const size_t usage_before{pool.GetUsage()};
+        CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, rng.randbytes<uint8_t>(size))};
+        const auto payload{msg.data};
+        BOOST_REQUIRE(sender.SetMessageToSend(msg));
+        DeliverBytes(sender, receiver);
+        BOOST_REQUIRE(receiver.ReceivedMessageComplete());
+        {
+            bool reject{false};
+            CNetMessage received{receiver.GetReceivedMessage({}, reject)};
+            BOOST_REQUIRE(!reject);
+            BOOST_CHECK_EQUAL(received.m_type, NetMsgType::BLOCK);
+            BOOST_CHECK(std::ranges::equal(MakeUCharSpan(received.m_recv), payload));
+            if (reuse) {
+                BOOST_CHECK_LT(pool.GetUsage(), usage_before);
+            } else {
+                BOOST_CHECK_EQUAL(pool.GetUsage(), usage_before);
+            }
+        }
+        // The buffer is back once the message is processed.
+        if (pooled) BOOST_CHECK_GT(pool.GetUsage(), 0U);
+        if (!pooled) BOOST_CHECK_EQUAL(pool.GetUsage(), usage_before);
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(transport_recv_buffer_pool)
+{
+    {
+        auto pool{std::make_shared<node::RecvBufferPool>(MAX_RECV_BUFFER_POOL_USAGE)};
+        V1Transport sender{0}, receiver{1, pool};
+        CheckRecvBufferPool(m_rng, sender, receiver, *pool);
+    }
+    {
+        auto pool{std::make_shared<node::RecvBufferPool>(MAX_RECV_BUFFER_POOL_USAGE)};
+        V2Transport sender{0, /*initiating=*/true}, receiver{1, /*initiating=*/false, pool};
+        for (int i = 0; i < 3; ++i) {
+            DeliverBytes(sender, receiver);
+            DeliverBytes(receiver, sender);
+        }
+        BOOST_REQUIRE(receiver.GetInfo().transport_type == TransportProtocolType::V2);
+        CheckRecvBufferPool(m_rng, sender, receiver, *pool);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
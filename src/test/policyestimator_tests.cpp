@@ -15,6 +15,12 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(policyestimator_tests, ChainTestingSetup)
 
 BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
@@ -265,4 +271,112 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     }
 }
 
+BOOST_AUTO_TEST_CASE(BlockPolicyEstimatesLog)
+{
+    CBlockPolicyEstimator feeEst{FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    uint32_t tx_count{0};
+
+    // Transactions of 10 feerates confirming within 1 to 3 blocks, some of
+    // which leave the mempool unconfirmed. All are confirmed or removed by the
+    // last block.
+    std::list<std::pair<RemovedMempoolTransactionInfo, unsigned int>> pending;
+    const auto process_blocks{[&](unsigned int from, unsigned int to) {
+        for (unsigned int height{from}; height < to; ++height) {
+            for (int j{0}; height + 2 < to && j < 10; ++j) {
+                tx.vin[0].prevout.n = tx_count++;
+                const auto& info{pending.emplace_back(RemovedMempoolTransactionInfo{entry.Fee(1000 * (j + 1)).Height(height - 1).FromTx(tx)}, height + j % 3).first.info};
+                feeEst.processTransaction(NewMempoolTransactionInfo(info.m_tx, info.m_fee, info.m_virtual_transaction_size, info.txHeight,
+                                                                    /*mempool_limit_bypassed=*/false,
+                                                                    /*submitted_in_package=*/false,
+                                                                    /*chainstate_is_current=*/true,
+                                                                    /*has_no_mempool_parents=*/true));
+            }
+            if (height % 5 == 0 && !pending.empty() && pending.front().first.info.txHeight + 1 < height) {
+                BOOST_CHECK(feeEst.removeTx(pending.front().first.info.m_tx->GetHash()));
+                pending.erase(pending.begin());
+            }
+            std::vector<RemovedMempoolTransactionInfo> block;
+            std::erase_if(pending, [&](const auto& pending_tx) {
+                if (pending_tx.second != height) return false;
+                block.push_back(pending_tx.first);
+                return true;
+            });
+            feeEst.processBlock(block, height);
+        }
+        BOOST_CHECK(pending.empty());
+    }};
+
+    // Blocks processed after the estimates were flushed are logged.
+    process_blocks(1, 100);
+    feeEst.FlushFeeEstimates();
+    process_blocks(100, 150);
+
+    // Replaying them on top of the flushed estimates yields the same estimates.
+    CBlockPolicyEstimator restartedFeeEst{FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    BOOST_CHECK(feeEst.estimateSmartFee(2, nullptr, /*conservative=*/false) != CFeeRate(0));
+    for (const bool conservative : {false, true}) {
+        for (int target{1}; target <= 100; ++target) {
+            FeeCalculation feeCalc, restartedFeeCalc;
+            const CFeeRate feeRate{feeEst.estimateSmartFee(target, &feeCalc, conservative)};
+            BOOST_CHECK(restartedFeeEst.estimateSmartFee(target, &restartedFeeCalc, conservative) == feeRate);
+            BOOST_CHECK_EQUAL(restartedFeeCalc.returnedTarget, feeCalc.returnedTarget);
+            BOOST_CHECK(restartedFeeCalc.reason == feeCalc.reason);
+            // Cached estimates are the same.
+            BOOST_CHECK(feeEst.estimateSmartFee(target, nullptr, conservative) == feeRate);
+        }
+    }
+    for (const auto horizon : ALL_FEE_ESTIMATE_HORIZONS) {
+        BOOST_CHECK_EQUAL(restartedFeeEst.HighestTargetTracked(horizon), feeEst.HighestTargetTracked(horizon));
+        for (unsigned int target{1}; target <= feeEst.HighestTargetTracked(horizon); ++target) {
+            BOOST_CHECK(restartedFeeEst.estimateRawFee(target, 0.85, horizon) == feeEst.estimateRawFee(target, 0.85, horizon));
+        }
+    }
+
+    // The replayed blocks were flushed, and are not replayed again.
+    CBlockPolicyEstimator restartedAgainFeeEst{FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    for (int target{1}; target <= 100; ++target) {
+        BOOST_CHECK(restartedAgainFeeEst.estimateSmartFee(target, nullptr, /*conservative=*/true) == feeEst.estimateSmartFee(target, nullptr, /*conservative=*/true));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(TxConfirmStatsUnconfirmedSince, BasicTestingSetup)
+{
+    const std::vector<double> buckets{1000, 2000, 4000, 1e99};
+    const std::map<double, unsigned int> bucket_map{{1000, 0}, {2000, 1}, {4000, 2}, {1e99, 3}};
+    TxConfirmStats stats{buckets, bucket_map, /*maxPeriods=*/6, /*decay=*/0.9, /*scale=*/2};
+    const unsigned int max_confirms{stats.GetMaxConfirms()};
+    BOOST_REQUIRE_EQUAL(max_confirms, 12U);
+
+    // Entry height and bucket of the transactions still in the mempool.
+    std::vector<std::pair<unsigned int, unsigned int>> unconfirmed;
+    for (unsigned int height{1}; height < 10 * max_confirms; ++height) {
+        stats.ClearCurrent(height);
+        std::erase_if(unconfirmed, [&](const auto& tx) {
+            if (!m_rng.randbool()) return false;
+            stats.removeTx(tx.first, height, tx.second, /*inBlock=*/m_rng.randbool());
+            return true;
+        });
+        for (int i{0}; i < 8; ++i) {
+            const unsigned int bucket{stats.NewTx(height, m_rng.randrange(5000))};
+            unconfirmed.emplace_back(height, bucket);
+        }
+        // Before GetMaxConfirms blocks, the range sums are not used.
+        if (height < max_confirms) continue;
+        // What looping over the slots of the unconfirmed for confTarget up to
+        // GetMaxConfirms blocks counted.
+        for (unsigned int bucket{0}; bucket < buckets.size(); ++bucket) {
+            for (unsigned int conf_target{1}; conf_target <= max_confirms; ++conf_target) {
+                const auto expected{std::ranges::count_if(unconfirmed, [&](const auto& tx) {
+                    return tx.second == bucket && height - tx.first >= conf_target && height - tx.first < max_confirms;
+                })};
+                BOOST_CHECK_EQUAL(stats.UnconfirmedSince(conf_target, height, bucket), expected);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
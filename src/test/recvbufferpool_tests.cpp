@@ -0,0 +1,70 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/recvbufferpool.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+
+using node::RecvBufferPool;
+
+namespace {
+SerializeData MakeBuffer(size_t capacity)
+{
+    SerializeData buffer;
+    buffer.reserve(capacity);
+    buffer.resize(capacity / 2);
+    return buffer;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(recvbufferpool_tests)
+
+BOOST_AUTO_TEST_CASE(get_put)
+{
+    RecvBufferPool pool{/*max_usage=*/100'000};
+    BOOST_CHECK_EQUAL(pool.Get(10'000).capacity(), 0U);
+
+    // Small buffers are not pooled.
+    pool.Put(MakeBuffer(RecvBufferPool::MIN_POOLED_CAPACITY - 1));
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 0U);
+
+    pool.Put(MakeBuffer(10'000));
+    pool.Put(MakeBuffer(40'000));
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 50'000U);
+
+    // Nothing is handed out for sizes not worth pooling, or without a large enough buffer.
+    BOOST_CHECK_EQUAL(pool.Get(100).capacity(), 0U);
+    BOOST_CHECK_EQUAL(pool.Get(40'001).capacity(), 0U);
+    // Nor buffers more than twice as large as needed.
+    BOOST_CHECK_EQUAL(pool.Get(4'900).capacity(), 0U);
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 50'000U);
+
+    // The smallest fitting buffer is handed out, empty.
+    auto buffer{pool.Get(9'000)};
+    BOOST_CHECK_EQUAL(buffer.capacity(), 10'000U);
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 40'000U);
+    buffer = pool.Get(30'000);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 40'000U);
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(max_usage)
+{
+    RecvBufferPool pool{/*max_usage=*/100'000};
+    pool.Put(MakeBuffer(60'000));
+    pool.Put(MakeBuffer(30'000));
+    // Buffers that do not fit anymore are freed.
+    pool.Put(MakeBuffer(20'000));
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 90'000U);
+    pool.Put(MakeBuffer(10'000));
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 100'000U);
+    BOOST_CHECK_EQUAL(pool.Get(20'000).capacity(), 30'000U);
+    BOOST_CHECK_EQUAL(pool.GetUsage(), 70'000U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,6 +16,7 @@
 #include <key.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <primitives/block.h>
 #include <script/script.h>
 #include <script/script_error.h>
 #include <script/sigcache.h>
@@ -32,6 +33,7 @@
 #include <util/transaction_identifier.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <string>
@@ -1149,4 +1151,44 @@ BOOST_AUTO_TEST_CASE(max_standard_legacy_sigops)
     BOOST_CHECK(!::AreInputsStandard(CTransaction(tx_max_sigops), coins));
 }
 
+BOOST_AUTO_TEST_CASE(block_arena_deserialization)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.emplace_back();
+    coinbase.vin[0].scriptSig = CScript() << 42 << OP_0;
+    coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    CMutableTransaction spend;
+    spend.vin.emplace_back(COutPoint{block.vtx[0]->GetHash(), 0});
+    spend.vin[0].scriptWitness.stack = {{0x01, 0x02}, std::vector<unsigned char>(100, 0x03)};
+    spend.vout.emplace_back(COIN, CScript() << OP_1 << std::vector<unsigned char>(32, 0x04));
+    block.vtx.push_back(MakeTransactionRef(spend));
+
+    DataStream block_data;
+    block_data << TX_WITH_WITNESS(block);
+
+    CBlock arena_block;
+    {
+        TransactionArena arena;
+        const TransactionSerParams params{.allow_witness = true, .arena = &arena};
+        DataStream{block_data} >> params(arena_block);
+    }
+    // The transactions keep the arena memory alive after the arena itself is gone.
+    BOOST_REQUIRE_EQUAL(arena_block.vtx.size(), block.vtx.size());
+    for (size_t i{0}; i < block.vtx.size(); ++i) {
+        BOOST_CHECK(arena_block.vtx[i]->GetWitnessHash() == block.vtx[i]->GetWitnessHash());
+    }
+    BOOST_CHECK(arena_block.vtx[1]->vin[0].scriptWitness.stack == spend.vin[0].scriptWitness.stack);
+
+    DataStream arena_block_data;
+    arena_block_data << TX_WITH_WITNESS(arena_block);
+    BOOST_CHECK(std::ranges::equal(arena_block_data, block_data));
+
+    // Copies of a transaction outlive the block they were deserialized with.
+    const CTransactionRef tx{arena_block.vtx[1]};
+    arena_block.SetNull();
+    BOOST_CHECK(tx->GetWitnessHash() == block.vtx[1]->GetWitnessHash());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
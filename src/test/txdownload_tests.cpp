@@ -338,4 +338,39 @@ BOOST_FIXTURE_TEST_CASE(handle_missing_inputs, TestChain100Setup)
     }
 }
 
+BOOST_AUTO_TEST_CASE(announcements_from_many_peers)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    FastRandomContext det_rand{true};
+    node::TxDownloadOptions DEFAULT_OPTS{pool, det_rand, true};
+    node::TxDownloadConnectionInfo DEFAULT_CONN{/*m_preferred=*/false, /*m_relay_permissions=*/false, /*m_wtxid_relay=*/true};
+    const std::chrono::microseconds now{GetTime()};
+
+    node::TxDownloadManagerImpl txdownload_impl{DEFAULT_OPTS};
+    for (NodeId nodeid{0}; nodeid < 4; ++nodeid) txdownload_impl.ConnectedPeer(nodeid, DEFAULT_CONN);
+
+    const auto ptx{CreatePlaceholderTx(/*segwit=*/true)};
+    const auto& wtxid{ptx->GetWitnessHash()};
+
+    // The first announcement starts the download, later ones from other peers
+    // are added as alternatives to download it from.
+    BOOST_CHECK(!txdownload_impl.m_txrequest.HaveTxHash(wtxid.ToUint256()));
+    for (NodeId nodeid{0}; nodeid < 3; ++nodeid) {
+        BOOST_CHECK(!txdownload_impl.AddTxAnnouncement(nodeid, wtxid, now));
+        BOOST_CHECK(txdownload_impl.m_txrequest.HaveTxHash(wtxid.ToUint256()));
+    }
+    std::vector<NodeId> candidates;
+    txdownload_impl.m_txrequest.GetCandidatePeers(wtxid.ToUint256(), candidates);
+    BOOST_CHECK_EQUAL(candidates.size(), 3U);
+
+    // Once the transaction is rejected, it is no longer downloaded, and further
+    // announcements are recognized as ones of a transaction we already have.
+    TxValidationState state;
+    state.Invalid(TxValidationResult::TX_CONSENSUS, "");
+    txdownload_impl.MempoolRejectedTx(ptx, state, /*nodeid=*/0, /*first_time_failure=*/true);
+    BOOST_CHECK(!txdownload_impl.m_txrequest.HaveTxHash(wtxid.ToUint256()));
+    BOOST_CHECK(txdownload_impl.AddTxAnnouncement(/*peer=*/3, wtxid, now));
+    BOOST_CHECK_EQUAL(txdownload_impl.m_txrequest.Size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,9 +4,11 @@
 
 #include <addresstype.h>
 #include <chainparams.h>
+#include <index/sync_coordinator.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <test/util/setup_common.h>
+#include <util/time.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -73,4 +75,38 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
     txindex.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(txindex_coordinated_sync, TestChain100Setup)
+{
+    // Two indexes syncing together through a coordinator share their block
+    // reads, and both must end up complete.
+    TxIndex txindex1(interfaces::MakeChain(m_node), 1 << 20, true);
+    TxIndex txindex2(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(txindex1.Init());
+    BOOST_REQUIRE(txindex2.Init());
+
+    const auto coordinator{std::make_shared<IndexSyncCoordinator>(m_node.chainman->m_blockman)};
+    txindex1.SetSyncCoordinator(coordinator);
+    txindex2.SetSyncCoordinator(coordinator);
+    BOOST_REQUIRE(txindex1.StartBackgroundSync());
+    BOOST_REQUIRE(txindex2.StartBackgroundSync());
+
+    for (const TxIndex* txindex : {&txindex1, &txindex2}) {
+        while (!txindex->GetSummary().synced) UninterruptibleSleep(10ms);
+
+        CTransactionRef tx_disk;
+        uint256 block_hash;
+        for (const auto& txn : m_coinbase_txns) {
+            if (!txindex->FindTx(txn->GetHash(), block_hash, tx_disk)) {
+                BOOST_ERROR("FindTx failed");
+            } else if (tx_disk->GetHash() != txn->GetHash()) {
+                BOOST_ERROR("Read incorrect tx");
+            }
+        }
+    }
+
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    txindex1.Stop();
+    txindex2.Stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
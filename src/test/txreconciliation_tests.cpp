@@ -5,6 +5,10 @@
 #include <node/txreconciliation.h>
 
 #include <test/util/setup_common.h>
+#include <util/transaction_identifier.h>
+
+#include <algorithm>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -81,4 +85,145 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    // Node 0 has an outbound connection to node 1, so node 0 initiates reconciliations.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const NodeId to_responder{1}, to_initiator{0};
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(to_responder)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(to_initiator)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(to_responder, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(to_initiator, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    // Only the initiator requests reconciliations, and only when it is not in the middle of one.
+    BOOST_CHECK(!responder.MaybeRequestReconciliation(to_initiator, 0s));
+    BOOST_CHECK(!initiator.HandleSketch(to_responder, {}));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(to_initiator, true, {}));
+
+    std::vector<Wtxid> shared, initiator_only, responder_only;
+    for (int i = 0; i < 100; ++i) shared.push_back(Wtxid::FromUint256(m_rng.rand256()));
+    for (int i = 0; i < 5; ++i) initiator_only.push_back(Wtxid::FromUint256(m_rng.rand256()));
+    for (int i = 0; i < 7; ++i) responder_only.push_back(Wtxid::FromUint256(m_rng.rand256()));
+    for (const auto& wtxid : shared) {
+        BOOST_CHECK(initiator.AddToSet(to_responder, wtxid));
+        BOOST_CHECK(responder.AddToSet(to_initiator, wtxid));
+    }
+    for (const auto& wtxid : initiator_only) BOOST_CHECK(initiator.AddToSet(to_responder, wtxid));
+    for (const auto& wtxid : responder_only) BOOST_CHECK(responder.AddToSet(to_initiator, wtxid));
+
+    const auto request{initiator.MaybeRequestReconciliation(to_responder, 0s)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->first, shared.size() + initiator_only.size());
+    BOOST_CHECK(!initiator.MaybeRequestReconciliation(to_responder, 0s));
+
+    // A generous q, so the sketch is large enough for the difference.
+    const auto skdata{responder.HandleReconciliationRequest(to_initiator, request->first, /*peer_q=*/16383, 0s)};
+    BOOST_REQUIRE(skdata);
+    BOOST_CHECK(!skdata->empty());
+    BOOST_CHECK(!responder.HandleReconciliationRequest(to_initiator, request->first, 16383, 0s));
+
+    const auto result{initiator.HandleSketch(to_responder, *skdata)};
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE(result->success);
+    BOOST_CHECK(std::is_permutation(result->announce.begin(), result->announce.end(), initiator_only.begin(), initiator_only.end()));
+    BOOST_CHECK_EQUAL(result->ask_shortids.size(), responder_only.size());
+
+    const auto announce{responder.HandleReconciliationDifference(to_initiator, result->success, result->ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(std::is_permutation(announce->begin(), announce->end(), responder_only.begin(), responder_only.end()));
+
+    // The next round starts from empty sets, after the request interval.
+    BOOST_CHECK(!initiator.MaybeRequestReconciliation(to_responder, RECON_REQUEST_INTERVAL - 1s));
+    const auto next_request{initiator.MaybeRequestReconciliation(to_responder, RECON_REQUEST_INTERVAL)};
+    BOOST_REQUIRE(next_request);
+    BOOST_CHECK_EQUAL(next_request->first, 0);
+
+    // A sketch too small to decode the difference makes both sides announce their whole set.
+    for (const auto& wtxid : initiator_only) BOOST_CHECK(initiator.AddToSet(to_responder, wtxid));
+    for (const auto& wtxid : responder_only) BOOST_CHECK(responder.AddToSet(to_initiator, wtxid));
+    const auto small_skdata{responder.HandleReconciliationRequest(to_initiator, /*peer_set_size=*/0, /*peer_q=*/0, 0s)};
+    BOOST_REQUIRE(small_skdata);
+    const auto failed_result{initiator.HandleSketch(to_responder, *small_skdata)};
+    BOOST_REQUIRE(failed_result);
+    BOOST_CHECK(!failed_result->success);
+    BOOST_CHECK_EQUAL(failed_result->announce.size(), initiator_only.size());
+    const auto failed_announce{responder.HandleReconciliationDifference(to_initiator, false, {})};
+    BOOST_REQUIRE(failed_announce);
+    BOOST_CHECK_EQUAL(failed_announce->size(), responder_only.size());
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationTimeoutTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const NodeId to_responder{1}, to_initiator{0};
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(to_responder)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(to_initiator)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(to_responder, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(to_initiator, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    std::vector<Wtxid> wtxids;
+    for (int i = 0; i < 10; ++i) wtxids.push_back(Wtxid::FromUint256(m_rng.rand256()));
+    for (const auto& wtxid : wtxids) {
+        BOOST_CHECK(initiator.AddToSet(to_responder, wtxid));
+        BOOST_CHECK(responder.AddToSet(to_initiator, wtxid));
+    }
+
+    // Nothing expires outside of a round.
+    BOOST_CHECK(initiator.MaybeExpireReconciliation(to_responder, RECON_RESPONSE_TIMEOUT).empty());
+    BOOST_CHECK(responder.MaybeExpireReconciliation(to_initiator, RECON_RESPONSE_TIMEOUT).empty());
+
+    // The initiator never gets a sketch back: it gives up on the round and
+    // announces the set it asked about.
+    BOOST_REQUIRE(initiator.MaybeRequestReconciliation(to_responder, 0s));
+    BOOST_CHECK(initiator.MaybeExpireReconciliation(to_responder, RECON_RESPONSE_TIMEOUT - 1s).empty());
+    const auto initiator_expired{initiator.MaybeExpireReconciliation(to_responder, RECON_RESPONSE_TIMEOUT)};
+    BOOST_CHECK(std::is_permutation(initiator_expired.begin(), initiator_expired.end(), wtxids.begin(), wtxids.end()));
+    BOOST_CHECK(initiator.MaybeExpireReconciliation(to_responder, RECON_RESPONSE_TIMEOUT).empty());
+    // A sketch arriving late is unexpected, and the next round starts from an empty set.
+    BOOST_CHECK(!initiator.HandleSketch(to_responder, {}));
+    const auto next_request{initiator.MaybeRequestReconciliation(to_responder, RECON_RESPONSE_TIMEOUT)};
+    BOOST_REQUIRE(next_request);
+    BOOST_CHECK_EQUAL(next_request->first, 0);
+
+    // The responder never hears about the outcome: it gives up on the round and
+    // announces the set it put aside, keeping the transactions queued since.
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(to_initiator, /*peer_set_size=*/10, 16383, 0s));
+    const Wtxid queued{Wtxid::FromUint256(m_rng.rand256())};
+    BOOST_CHECK(responder.AddToSet(to_initiator, queued));
+    BOOST_CHECK(!responder.HandleReconciliationRequest(to_initiator, /*peer_set_size=*/10, 16383, RECON_RESPONSE_TIMEOUT - 1s));
+    BOOST_CHECK(responder.MaybeExpireReconciliation(to_initiator, RECON_RESPONSE_TIMEOUT - 1s).empty());
+    const auto responder_expired{responder.MaybeExpireReconciliation(to_initiator, RECON_RESPONSE_TIMEOUT)};
+    BOOST_CHECK(std::is_permutation(responder_expired.begin(), responder_expired.end(), wtxids.begin(), wtxids.end()));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(to_initiator, true, {}));
+    // The next request is answered again, with a sketch of the queued transaction.
+    const auto skdata{responder.HandleReconciliationRequest(to_initiator, /*peer_set_size=*/0, 16383, RECON_RESPONSE_TIMEOUT)};
+    BOOST_REQUIRE(skdata);
+    const auto announce{responder.HandleReconciliationDifference(to_initiator, false, {})};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(*announce == std::vector<Wtxid>{queued});
+}
+
+BOOST_AUTO_TEST_CASE(ShouldFanoutToTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+
+    // Peers not reconciling with us always get transactions flooded.
+    const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+    BOOST_CHECK(tracker.ShouldFanoutTo(wtxid, 0));
+
+    for (NodeId peer_id = 0; peer_id < 8; ++peer_id) {
+        tracker.PreRegisterPeer(peer_id);
+        BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id, /*is_peer_inbound=*/false, 1, 1), ReconciliationRegisterResult::SUCCESS);
+    }
+    // Every transaction is flooded to exactly OUTBOUND_FANOUT_DESTINATIONS outbound reconciling peers.
+    for (int i = 0; i < 10; ++i) {
+        const Wtxid tx{Wtxid::FromUint256(m_rng.rand256())};
+        size_t destinations{0};
+        for (NodeId peer_id = 0; peer_id < 8; ++peer_id) destinations += tracker.ShouldFanoutTo(tx, peer_id);
+        BOOST_CHECK_EQUAL(destinations, OUTBOUND_FANOUT_DESTINATIONS);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+// Copyright (c) 2025-present The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txrelayschedule.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using node::TxRelaySchedule;
+
+BOOST_FIXTURE_TEST_SUITE(txrelayschedule_tests, TestingSetup)
+
+static CTransactionRef MakeTx(const Txid& prev_txid, CAmount value)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint{prev_txid, 0};
+    tx.vin[0].scriptSig = CScript() << OP_11;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx.vout[0].nValue = value;
+    return MakeTransactionRef(tx);
+}
+
+static std::vector<GenTxid> ScheduledIds(const TxRelaySchedule::Schedule& schedule)
+{
+    std::vector<GenTxid> ids;
+    for (const auto& [gtxid, _] : schedule.entries) ids.push_back(gtxid);
+    return ids;
+}
+
+BOOST_AUTO_TEST_CASE(schedule_order)
+{
+    CTxMemPool& pool{*Assert(m_node.mempool)};
+    TxRelaySchedule relay_schedule{pool};
+    TestMemPoolEntryHelper entry;
+
+    // A parent paying a low fee with a child paying a high one, and an
+    // unrelated transaction paying a medium fee.
+    const auto parent{MakeTx(Txid::FromUint256(uint256::ONE), 10000)};
+    const auto child{MakeTx(parent->GetHash(), 5000)};
+    const auto other{MakeTx(Txid::FromUint256(uint256{2}), 10000)};
+    {
+        LOCK2(cs_main, pool.cs);
+        AddToMempool(pool, entry.Fee(1000).FromTx(parent));
+        AddToMempool(pool, entry.Fee(20000).FromTx(child));
+        AddToMempool(pool, entry.Fee(5000).FromTx(other));
+    }
+
+    // Nothing is scheduled before anything is queued.
+    BOOST_CHECK(relay_schedule.Get()->entries.empty());
+
+    // Transactions can be queued by txid and by wtxid; the same transaction
+    // queued for several peers is only scheduled once per id.
+    relay_schedule.Add(GenTxid{child->GetWitnessHash()});
+    relay_schedule.Add(GenTxid{child->GetWitnessHash()});
+    relay_schedule.Add(GenTxid{parent->GetWitnessHash()});
+    relay_schedule.Add(GenTxid{other->GetHash()});
+    BOOST_CHECK_EQUAL(relay_schedule.Size(), 3U);
+
+    const auto schedule{relay_schedule.Get()};
+    // Ancestors come first, then the higher fee rate.
+    const std::vector<GenTxid> expected{GenTxid{other->GetHash()}, GenTxid{parent->GetWitnessHash()}, GenTxid{child->GetWitnessHash()}};
+    BOOST_CHECK(ScheduledIds(*schedule) == expected);
+    BOOST_CHECK_EQUAL(schedule->ids.size(), 3U);
+    BOOST_CHECK_EQUAL(schedule->entries[1].second.tx, parent);
+    BOOST_CHECK_EQUAL(schedule->entries[1].second.fee, 1000);
+
+    // The schedule is reused until transactions are queued or the mempool
+    // changes.
+    BOOST_CHECK_EQUAL(relay_schedule.Get(), schedule);
+    relay_schedule.Add(GenTxid{child->GetWitnessHash()});
+    BOOST_CHECK_EQUAL(relay_schedule.Get(), schedule);
+
+    // Transactions no peer has queued anymore are dropped from the schedule
+    // the next time it is computed.
+    relay_schedule.Remove(std::vector{GenTxid{other->GetHash()}});
+    BOOST_CHECK_EQUAL(relay_schedule.Size(), 2U);
+    relay_schedule.Add(GenTxid{parent->GetHash()});
+    const auto ids{ScheduledIds(*relay_schedule.Get())};
+    BOOST_CHECK_EQUAL(ids.size(), 3U);
+    BOOST_CHECK(ids.back() == GenTxid{child->GetWitnessHash()});
+    BOOST_CHECK(!relay_schedule.Get()->ids.contains(GenTxid{other->GetHash()}));
+}
+
+BOOST_AUTO_TEST_CASE(mempool_changes)
+{
+    CTxMemPool& pool{*Assert(m_node.mempool)};
+    TxRelaySchedule relay_schedule{pool};
+    TestMemPoolEntryHelper entry;
+
+    const auto tx1{MakeTx(Txid::FromUint256(uint256::ONE), 10000)};
+    const auto tx2{MakeTx(Txid::FromUint256(uint256{2}), 10000)};
+    {
+        LOCK2(cs_main, pool.cs);
+        AddToMempool(pool, entry.Fee(1000).FromTx(tx1));
+    }
+
+    // Transactions that are not in the mempool are not scheduled.
+    relay_schedule.Add(GenTxid{tx1->GetWitnessHash()});
+    relay_schedule.Add(GenTxid{tx2->GetWitnessHash()});
+    BOOST_CHECK(ScheduledIds(*relay_schedule.Get()) == std::vector{GenTxid{tx1->GetWitnessHash()}});
+
+    // A change to the mempool makes the schedule get recomputed.
+    {
+        LOCK2(cs_main, pool.cs);
+        AddToMempool(pool, entry.Fee(2000).FromTx(tx2));
+    }
+    BOOST_CHECK((ScheduledIds(*relay_schedule.Get()) == std::vector{GenTxid{tx2->GetWitnessHash()}, GenTxid{tx1->GetWitnessHash()}}));
+    {
+        LOCK(pool.cs);
+        pool.removeRecursive(*tx2, MemPoolRemovalReason::BLOCK);
+    }
+    BOOST_CHECK(ScheduledIds(*relay_schedule.Get()) == std::vector{GenTxid{tx1->GetWitnessHash()}});
+
+    // Removing the last reference drops a transaction from the queue even if it
+    // was never scheduled.
+    relay_schedule.Remove(std::vector{GenTxid{tx1->GetWitnessHash()}, GenTxid{tx2->GetWitnessHash()}});
+    BOOST_CHECK_EQUAL(relay_schedule.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <consensus/validation.h>
 #include <key_io.h>
 #include <policy/packages.h>
@@ -110,6 +111,39 @@ static inline CTransactionRef make_ephemeral_tx(const std::vector<COutPoint>& in
     return MakeTransactionRef(mtx);
 }
 
+BOOST_FIXTURE_TEST_CASE(tx_mempool_parallel_script_checks, TestChain100Setup)
+{
+    // Enough inputs for the script checks to run on the script check threads.
+    static constexpr uint32_t NUM_INPUTS{10};
+    BOOST_CHECK(m_node.chainman->GetCheckQueue().HasThreads());
+
+    const CScript script_pub_key{GetScriptForDestination(WitnessV0KeyHash(coinbaseKey.GetPubKey()))};
+    const CAmount fee{10000};
+    const CAmount input_value{(m_coinbase_txns[0]->vout[0].nValue - fee) / NUM_INPUTS};
+    const std::vector<CTxOut> funding_outputs(NUM_INPUTS, CTxOut{input_value, script_pub_key});
+    const auto funding_tx{MakeTransactionRef(CreateValidMempoolTransaction({m_coinbase_txns[0]}, {COutPoint{m_coinbase_txns[0]->GetHash(), 0}},
+                                                                           /*input_height=*/0, {coinbaseKey}, funding_outputs))};
+    std::vector<COutPoint> inputs;
+    for (uint32_t i{0}; i < NUM_INPUTS; ++i) inputs.emplace_back(funding_tx->GetHash(), i);
+    const auto mtx{CreateValidMempoolTransaction({funding_tx}, inputs, /*input_height=*/0, {coinbaseKey},
+                                                 {CTxOut{NUM_INPUTS * input_value - fee, script_pub_key}}, /*submit=*/false)};
+
+    LOCK(cs_main);
+
+    // A bad signature on one input is reported like without the threads.
+    CMutableTransaction bad_mtx{mtx};
+    bad_mtx.vin[NUM_INPUTS / 2].scriptWitness.stack[0][10] ^= 1;
+    const auto bad_result{m_node.chainman->ProcessTransaction(MakeTransactionRef(bad_mtx))};
+    BOOST_CHECK(bad_result.m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK(bad_result.m_state.GetResult() == TxValidationResult::TX_CONSENSUS);
+    BOOST_CHECK(bad_result.m_state.GetRejectReason().starts_with("mandatory-script-verify-flag-failed"));
+    BOOST_CHECK(!m_node.mempool->exists(bad_mtx.GetHash()));
+
+    const auto result{m_node.chainman->ProcessTransaction(MakeTransactionRef(mtx))};
+    BOOST_CHECK(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+    BOOST_CHECK(m_node.mempool->exists(mtx.GetHash()));
+}
+
 BOOST_FIXTURE_TEST_CASE(ephemeral_tests, RegTestingSetup)
 {
     CTxMemPool& pool = *Assert(m_node.mempool);
@@ -2,7 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <consensus/validation.h>
+#include <core_memusage.h>
 #include <key.h>
 #include <random.h>
 #include <script/sigcache.h>
@@ -24,7 +26,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                       std::vector<CScriptCheck>* pvChecks,
+                       const PrecomputedTransactionData* known_txdata = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 BOOST_AUTO_TEST_SUITE(txvalidationcache_tests)
 
@@ -385,4 +388,57 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(mempool_precomputed_txdata, TestChain100Setup)
+{
+    const CScript p2pk_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const CScript p2wpkh_script{GetScriptForDestination(WitnessV0KeyHash{coinbaseKey.GetPubKey()})};
+
+    // Fund a P2WPKH output, whose spend uses the BIP143 signature hash.
+    const CAmount fee{10000};
+    const CAmount funding_value{m_coinbase_txns[0]->vout[0].nValue - fee};
+    const CMutableTransaction funding{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey, p2wpkh_script, funding_value, /*submit=*/false)};
+    CreateAndProcessBlock({funding}, p2pk_script);
+
+    const CMutableTransaction legacy_spend{CreateValidMempoolTransaction(m_coinbase_txns[1], 0, 0, coinbaseKey, p2pk_script, m_coinbase_txns[1]->vout[0].nValue - fee)};
+    const CMutableTransaction segwit_spend{CreateValidMempoolTransaction(MakeTransactionRef(funding), 0, 0, coinbaseKey, p2pk_script, funding_value - fee)};
+    const CTransaction segwit_tx{segwit_spend};
+    {
+        LOCK2(cs_main, m_node.mempool->cs);
+        const CTxMemPoolEntry* legacy_entry{m_node.mempool->GetEntry(legacy_spend.GetHash())};
+        const CTxMemPoolEntry* segwit_entry{m_node.mempool->GetEntry(segwit_tx.GetHash())};
+        BOOST_REQUIRE(legacy_entry && segwit_entry);
+
+        // Only the segwit spend keeps the data precomputed for its signature
+        // hashes, which counts towards the memory usage of its entry.
+        BOOST_CHECK(!legacy_entry->GetPrecomputedTxData());
+        const auto txdata{segwit_entry->GetPrecomputedTxData()};
+        BOOST_REQUIRE(txdata);
+        BOOST_CHECK(txdata->m_bip143_segwit_ready);
+        BOOST_CHECK_GT(segwit_entry->DynamicMemoryUsage(), RecursiveDynamicUsage(segwit_entry->GetSharedTx()));
+
+        // Known data is reused for the same spent outputs only. Flags that are
+        // not cached make sure the scripts are executed.
+        const CCoinsViewCache& coins{m_node.chainman->ActiveChainstate().CoinsTip()};
+        const unsigned int flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS};
+        PrecomputedTransactionData known{*txdata};
+        known.hashPrevouts = uint256::ONE;
+        TxValidationState state;
+        PrecomputedTransactionData reused;
+        BOOST_CHECK(!CheckInputScripts(segwit_tx, state, coins, flags, false, false, reused, m_node.chainman->m_validation_cache, nullptr, &known));
+        BOOST_CHECK(reused.hashPrevouts == uint256::ONE);
+
+        known.m_spent_outputs[0].nValue += 1;
+        state = TxValidationState{};
+        PrecomputedTransactionData recomputed;
+        BOOST_CHECK(CheckInputScripts(segwit_tx, state, coins, flags, false, false, recomputed, m_node.chainman->m_validation_cache, nullptr, &known));
+        BOOST_CHECK(recomputed.hashPrevouts == txdata->hashPrevouts);
+    }
+
+    // A block with the transactions is connected using the kept data.
+    const CBlock block{CreateAndProcessBlock({legacy_spend, segwit_spend}, p2pk_script)};
+    LOCK(cs_main);
+    BOOST_CHECK_EQUAL(m_node.chainman->ActiveChain().Tip()->GetBlockHash(), block.GetHash());
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -153,6 +153,15 @@ ZeroSock::~ZeroSock() { m_socket = INVALID_SOCKET; }
 
 ssize_t ZeroSock::Send(const void*, size_t len, int) const { return len; }
 
+ssize_t ZeroSock::SendV(std::span<const std::span<const unsigned char>> chunks, int flags) const
+{
+    std::vector<unsigned char> data;
+    for (const auto& chunk : chunks.first(std::min(chunks.size(), MAX_SEND_CHUNKS))) {
+        data.insert(data.end(), chunk.begin(), chunk.end());
+    }
+    return Send(data.data(), data.size(), flags);
+}
+
 ssize_t ZeroSock::Recv(void* buf, size_t len, int flags) const
 {
     memset(buf, 0x0, len);
@@ -147,6 +147,9 @@ public:
 
     ssize_t Send(const void*, size_t len, int) const override;
 
+    /** Sends the chunks with a single Send() call, so that derived mocks only need to override Send(). */
+    ssize_t SendV(std::span<const std::span<const unsigned char>> chunks, int flags) const override;
+
     ssize_t Recv(void* buf, size_t len, int flags) const override;
 
     int Connect(const sockaddr*, socklen_t) const override;
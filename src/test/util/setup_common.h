@@ -56,6 +56,7 @@ struct TestOpts {
     bool setup_net{true};
     bool setup_validation_interface{true};
     bool min_validation_cache{false}; // Equivalent of -maxsigcachebytes=0
+    int worker_threads_num{2}; // Script check worker threads
 };
 
 /** Basic testing setup.
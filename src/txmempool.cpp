@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
 #include <numeric>
 #include <optional>
 #include <ranges>
@@ -325,6 +326,26 @@ void CTxMemPool::UpdateChildrenForRemoval(txiter it)
 
 void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, bool updateDescendants)
 {
+    // Totals of the removed transactions, to update each remaining
+    // transaction once for all of its removed ancestors or descendants,
+    // instead of once per removed transaction: each update repositions the
+    // entry in the mapTx indexes. Transactions that are removed as well need
+    // no update at all.
+    struct RemovedTotals {
+        int32_t size{0};
+        CAmount fee{0};
+        int64_t count{0};
+        int64_t sigops{0};
+
+        void Add(const CTxMemPoolEntry& entry)
+        {
+            size += entry.GetTxSize();
+            fee += entry.GetModifiedFee();
+            ++count;
+            sigops += entry.GetSigOpCost();
+        }
+    };
+
     // For each entry, walk back all ancestors and decrement size associated with this
     // transaction
     if (updateDescendants) {
@@ -334,18 +355,21 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // Here we only update statistics and not data in CTxMemPool::Parents
         // and CTxMemPoolEntry::Children (which we need to preserve until we're
         // finished with all operations that need to traverse the mempool).
+        std::map<txiter, RemovedTotals, CompareIteratorByHash> removed_ancestors;
         for (txiter removeIt : entriesToRemove) {
             setEntries setDescendants;
             CalculateDescendants(removeIt, setDescendants);
-            setDescendants.erase(removeIt); // don't update state for self
-            int32_t modifySize = -removeIt->GetTxSize();
-            CAmount modifyFee = -removeIt->GetModifiedFee();
-            int modifySigOps = -removeIt->GetSigOpCost();
             for (txiter dit : setDescendants) {
-                mapTx.modify(dit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
+                // Also skips removeIt itself.
+                if (entriesToRemove.contains(dit)) continue;
+                removed_ancestors[dit].Add(*removeIt);
             }
         }
+        for (const auto& [dit, removed] : removed_ancestors) {
+            mapTx.modify(dit, [&removed](CTxMemPoolEntry& e) { e.UpdateAncestorState(-removed.size, -removed.fee, -removed.count, -removed.sigops); });
+        }
     }
+    std::map<txiter, RemovedTotals, CompareIteratorByHash> removed_descendants;
     for (txiter removeIt : entriesToRemove) {
         const CTxMemPoolEntry &entry = *removeIt;
         // Since this is a tx that is already in the mempool, we can call CMPA
@@ -368,9 +392,18 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // we use the cached notion of ancestor transactions as the set of
         // things to update for removal.
         auto ancestors{AssumeCalculateMemPoolAncestors(__func__, entry, Limits::NoLimits(), /*fSearchForParents=*/false)};
-        // Note that UpdateAncestorsOf severs the child links that point to
-        // removeIt in the entries for the parents of removeIt.
-        UpdateAncestorsOf(false, removeIt, ancestors);
+        // Sever the child links that point to removeIt in the entries for the
+        // parents of removeIt.
+        for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+            UpdateChild(mapTx.iterator_to(parent), removeIt, false);
+        }
+        for (txiter ancestorIt : ancestors) {
+            if (entriesToRemove.contains(ancestorIt)) continue;
+            removed_descendants[ancestorIt].Add(*removeIt);
+        }
+    }
+    for (const auto& [ancestorIt, removed] : removed_descendants) {
+        mapTx.modify(ancestorIt, [&removed](CTxMemPoolEntry& e) { e.UpdateDescendantState(-removed.size, -removed.fee, -removed.count); });
     }
     // After updating all the ancestor sizes, we can now sever the link between each
     // transaction being removed and any mempool children (ie, update CTxMemPoolEntry::m_parents
@@ -669,14 +702,20 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
     std::vector<RemovedMempoolTransactionInfo> txs_removed_for_block;
     if (mapTx.size() || mapNextTx.size() || mapDeltas.size()) {
         txs_removed_for_block.reserve(vtx.size());
+        // Remove all confirmed transactions in one batch, so that the
+        // transactions depending on several of them are only updated once.
+        // Conflicts can be removed afterwards, as a confirmed transaction
+        // cannot depend on a transaction conflicting with the block.
+        setEntries stage;
         for (const auto& tx : vtx) {
             txiter it = mapTx.find(tx->GetHash());
             if (it != mapTx.end()) {
-                setEntries stage;
                 stage.insert(it);
                 txs_removed_for_block.emplace_back(*it);
-                RemoveStaged(stage, true, MemPoolRemovalReason::BLOCK);
             }
+        }
+        RemoveStaged(stage, true, MemPoolRemovalReason::BLOCK);
+        for (const auto& tx : vtx) {
             removeConflicts(*tx);
             ClearPrioritisation(tx->GetHash());
         }
@@ -869,6 +908,27 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
     return ret;
 }
 
+std::vector<std::pair<GenTxid, TxMempoolInfo>> CTxMemPool::InfoSortedByDepthAndScore(std::span<const GenTxid> ids) const
+{
+    AssertLockHeld(cs);
+    std::vector<std::pair<GenTxid, txiter>> found;
+    found.reserve(ids.size());
+    for (const auto& gtxid : ids) {
+        auto it{std::visit([&](const auto& id) EXCLUSIVE_LOCKS_REQUIRED(cs) { return GetIter(id); }, gtxid)};
+        if (it) found.emplace_back(gtxid, *it);
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+        return DepthAndScoreComparator()(a.second, b.second);
+    });
+
+    std::vector<std::pair<GenTxid, TxMempoolInfo>> ret;
+    ret.reserve(found.size());
+    for (const auto& [id, it] : found) {
+        ret.emplace_back(id, GetInfo(it));
+    }
+    return ret;
+}
+
 const CTxMemPoolEntry* CTxMemPool::GetEntry(const Txid& txid) const
 {
     AssertLockHeld(cs);
@@ -1398,6 +1458,12 @@ CTxMemPool::ChangeSet::TxHandle CTxMemPool::ChangeSet::StageAddition(const CTran
     return newit;
 }
 
+void CTxMemPool::ChangeSet::SetPrecomputedTxData(TxHandle tx, std::shared_ptr<const PrecomputedTransactionData> txdata)
+{
+    LOCK(m_pool->cs);
+    m_to_add.modify(tx, [&txdata](CTxMemPoolEntry& e) { e.SetPrecomputedTxData(std::move(txdata)); });
+}
+
 void CTxMemPool::ChangeSet::Apply()
 {
     LOCK(m_pool->cs);
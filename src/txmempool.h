@@ -36,6 +36,7 @@
 #include <map>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -662,6 +663,12 @@ public:
 
     std::vector<CTxMemPoolEntryRef> entryAll() const EXCLUSIVE_LOCKS_REQUIRED(cs);
     std::vector<TxMempoolInfo> infoAll() const;
+    /**
+     * Look up the given transactions and return the info of those that are in
+     * the mempool, sorted the way infoAll() sorts them (fewest ancestors and
+     * highest score first), along with the id each one was looked up by.
+     */
+    std::vector<std::pair<GenTxid, TxMempoolInfo>> InfoSortedByDepthAndScore(std::span<const GenTxid> ids) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     size_t DynamicMemoryUsage() const;
 
@@ -824,6 +831,9 @@ public:
         using TxHandle = CTxMemPool::txiter;
 
         TxHandle StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp);
+        /** Keep the data precomputed for the signature hashes of a staged transaction in its entry,
+         * so block validation can reuse it. */
+        void SetPrecomputedTxData(TxHandle tx, std::shared_ptr<const PrecomputedTransactionData> txdata);
         void StageRemoval(CTxMemPool::txiter it) { m_to_remove.insert(it); }
 
         const CTxMemPool::setEntries& GetRemovals() const { return m_to_remove; }
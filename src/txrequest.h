@@ -198,6 +198,10 @@ public:
     /** Count how many announcements are being tracked in total across all peers and transaction hashes. */
     size_t Size() const;
 
+    /** Whether any announcements exist for some txhash (txid or wtxid). As announcements for a txhash are deleted once
+     *  only COMPLETED ones remain, this means that the transaction is being downloaded. */
+    bool HaveTxHash(const uint256& txhash) const;
+
     /** For some txhash (txid or wtxid), finds all peers with non-COMPLETED announcements and appends them to
      * result_peers. Does not try to ensure that result_peers contains no duplicates. */
     void GetCandidatePeers(const uint256& txhash, std::vector<NodeId>& result_peers) const;
@@ -11,6 +11,8 @@
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -19,6 +21,10 @@
 #include <poll.h>
 #endif
 
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
 static inline bool IOErrorIsPermanent(int err)
 {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK && err != WSAEINPROGRESS;
@@ -47,6 +53,33 @@ ssize_t Sock::Send(const void* data, size_t len, int flags) const
     return send(m_socket, static_cast<const char*>(data), len, flags);
 }
 
+ssize_t Sock::SendV(std::span<const std::span<const unsigned char>> chunks, int flags) const
+{
+    const size_t count{std::min(chunks.size(), MAX_SEND_CHUNKS)};
+#ifdef WIN32
+    std::array<WSABUF, MAX_SEND_CHUNKS> bufs;
+    for (size_t i{0}; i < count; ++i) {
+        bufs[i].buf = const_cast<char*>(reinterpret_cast<const char*>(chunks[i].data()));
+        bufs[i].len = static_cast<ULONG>(chunks[i].size());
+    }
+    DWORD sent{0};
+    if (WSASend(m_socket, bufs.data(), static_cast<DWORD>(count), &sent, static_cast<DWORD>(flags), nullptr, nullptr) == SOCKET_ERROR) {
+        return -1;
+    }
+    return sent;
+#else
+    std::array<iovec, MAX_SEND_CHUNKS> iov;
+    for (size_t i{0}; i < count; ++i) {
+        iov[i].iov_base = const_cast<unsigned char*>(chunks[i].data());
+        iov[i].iov_len = chunks[i].size();
+    }
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void* buf, size_t len, int flags) const
 {
     return recv(m_socket, static_cast<char*>(buf), len, flags);
@@ -11,6 +11,7 @@
 
 #include <chrono>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 
@@ -64,6 +65,17 @@ public:
      */
     [[nodiscard]] virtual ssize_t Send(const void* data, size_t len, int flags) const;
 
+    /** Maximum number of chunks SendV() sends with a single call. */
+    static constexpr size_t MAX_SEND_CHUNKS{64};
+
+    /**
+     * sendmsg(2) wrapper. Sends the given chunks of data with a single call, as if they were one
+     * contiguous buffer, without copying them together first. Only the first MAX_SEND_CHUNKS
+     * chunks are sent. Code that uses this wrapper can be unit tested if this method is
+     * overridden by a mock Sock implementation.
+     */
+    [[nodiscard]] virtual ssize_t SendV(std::span<const std::span<const unsigned char>> chunks, int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(m_socket, buf, len, flags);`. Code that uses this
      * wrapper can be unit tested if this method is overridden by a mock Sock implementation.
@@ -13,6 +13,11 @@
 #include <string>
 #include <utility>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 void util::TraceThread(std::string_view thread_name, std::function<void()> thread_func)
 {
     util::ThreadRename(std::string{thread_name});
@@ -28,3 +33,25 @@ void util::TraceThread(std::string_view thread_name, std::function<void()> threa
         throw;
     }
 }
+
+bool util::ThreadPinToCPU(int n)
+{
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+    const int num_allowed{CPU_COUNT(&allowed)};
+    if (num_allowed == 0) return false;
+    int skip{n % num_allowed};
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed) || skip-- > 0) continue;
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        return pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) == 0;
+    }
+#else
+    (void)n;
+#endif
+    return false;
+}
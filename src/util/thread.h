@@ -14,6 +14,14 @@ namespace util {
  */
 void TraceThread(std::string_view thread_name, std::function<void()> thread_func);
 
+/**
+ * Pin the current thread to the n'th (modulo their number) of the CPUs the
+ * process may run on. CPUs are usually numbered by core and NUMA node, so
+ * threads pinned to consecutive ones share as few nodes as possible.
+ * @returns false if pinning is not supported or failed.
+ */
+bool ThreadPinToCPU(int n);
+
 } // namespace util
 
 #endif // BITCOIN_UTIL_THREAD_H
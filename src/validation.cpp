@@ -112,6 +112,10 @@ const std::vector<std::string> CHECKLEVEL_DOC {
  *  noticeably interfere with the pruning mechanism.
  * */
 static constexpr int PRUNE_LOCK_BUFFER{10};
+/** Minimum number of inputs for the script checks of a transaction or package
+ *  submitted to the mempool to be run on the script check threads. Handing
+ *  fewer checks over costs more than it saves. */
+static constexpr size_t MIN_PARALLEL_MEMPOOL_SCRIPT_CHECKS{8};
 
 TRACEPOINT_SEMAPHORE(validation, block_connected);
 TRACEPOINT_SEMAPHORE(utxocache, flush);
@@ -142,7 +146,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks = nullptr)
+                       std::vector<CScriptCheck>* pvChecks = nullptr,
+                       const PrecomputedTransactionData* known_txdata = nullptr)
                        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 bool CheckFinalTxAtTip(const CBlockIndex& active_chain_tip, const CTransaction& tx)
@@ -663,6 +668,11 @@ private:
         /** A temporary cache containing serialized transaction data for signature verification.
          * Reused across PolicyScriptChecks and ConsensusScriptChecks. */
         PrecomputedTransactionData m_precomputed_txdata;
+        /** Whether the policy script checks passed on the script check threads. */
+        bool m_policy_scripts_checked{false};
+        /** Whether the policy script checks already ran on the script check
+         * threads, so that a failure is not looked for there twice. */
+        bool m_policy_scripts_parallel_tried{false};
     };
 
     // Run the policy checks on a given transaction, excluding any script checks.
@@ -685,6 +695,13 @@ private:
     // only invoke this on transactions that have otherwise passed policy checks.
     bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
+    // Run the policy script checks of the transactions on the script check
+    // threads, if there are any and the transactions have enough inputs to
+    // make it worth it. Returns false if the checks were not run or any of
+    // them failed; the caller then runs them serially, which also determines
+    // the error to report.
+    bool ParallelPolicyScriptChecks(std::span<Workspace> workspaces) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
     // Re-run the script checks, using consensus flags, and try to cache the
     // result in the scriptcache. This should be done after
     // PolicyScriptChecks(). This requires that all inputs either be in our
@@ -1236,7 +1253,8 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
 
     // Check input scripts and signatures.
     // This is done last to help prevent CPU exhaustion denial-of-service attacks.
-    if (!CheckInputScripts(tx, state, m_view, scriptVerifyFlags, true, false, ws.m_precomputed_txdata, GetValidationCache())) {
+    if (!ws.m_policy_scripts_checked && (ws.m_policy_scripts_parallel_tried || !ParallelPolicyScriptChecks({&ws, 1})) &&
+        !CheckInputScripts(tx, state, m_view, scriptVerifyFlags, true, false, ws.m_precomputed_txdata, GetValidationCache())) {
         // SCRIPT_VERIFY_CLEANSTACK requires SCRIPT_VERIFY_WITNESS, so we
         // need to turn both off, and compare against just turning off CLEANSTACK
         // to see if the failure is specifically due to witness validation.
@@ -1250,6 +1268,42 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
         return false; // state filled in by CheckInputScripts
     }
 
+    // Keep the data precomputed for the segwit signature hashes in the mempool
+    // entry, so that block validation does not compute it again if the script
+    // execution cache misses. Legacy signature hashes do not use it.
+    const PrecomputedTransactionData& txdata{ws.m_precomputed_txdata};
+    if (!args.m_test_accept && (txdata.m_bip143_segwit_ready || txdata.m_bip341_taproot_ready)) {
+        m_subpackage.m_changeset->SetPrecomputedTxData(ws.m_tx_handle, std::make_shared<const PrecomputedTransactionData>(txdata));
+    }
+
+    return true;
+}
+
+bool MemPoolAccept::ParallelPolicyScriptChecks(std::span<Workspace> workspaces)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+    auto& queue{m_active_chainstate.m_chainman.GetCheckQueue()};
+    if (!queue.HasThreads()) return false;
+    const size_t num_inputs{std::accumulate(workspaces.begin(), workspaces.end(), size_t{0},
+        [](size_t sum, const Workspace& ws) { return sum + ws.m_ptx->vin.size(); })};
+    if (num_inputs < MIN_PARALLEL_MEMPOOL_SCRIPT_CHECKS) return false;
+
+    // Block validation holds cs_main while it uses the queue as well, so the
+    // two take turns, and a block never waits for more than the checks of
+    // one transaction or package.
+    CCheckQueueControl<CScriptCheck> control{queue};
+    for (Workspace& ws : workspaces) {
+        ws.m_policy_scripts_parallel_tried = true;
+        std::vector<CScriptCheck> checks;
+        // Checks that are not cached are all added to checks, not run.
+        Assume(CheckInputScripts(*ws.m_ptx, ws.m_state, m_view, STANDARD_SCRIPT_VERIFY_FLAGS, true, false, ws.m_precomputed_txdata, GetValidationCache(), &checks));
+        control.Add(std::move(checks));
+    }
+    if (control.Complete().has_value()) return false;
+    for (Workspace& ws : workspaces) {
+        ws.m_policy_scripts_checked = true;
+    }
     return true;
 }
 
@@ -1600,6 +1654,9 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
         }
     }
 
+    // Check the scripts of all transactions at once, so that small transactions
+    // make use of the script check threads as well.
+    ParallelPolicyScriptChecks(workspaces);
     for (Workspace& ws : workspaces) {
         ws.m_package_feerate = package_feerate;
         if (!PolicyScriptChecks(args, ws)) {
@@ -1958,6 +2015,9 @@ void CoinsViews::InitCache()
 {
     AssertLockHeld(::cs_main);
     m_cacheview = std::make_unique<CCoinsViewCache>(&m_catcherview);
+    // Validation and the mempool read coins through caches layered on top,
+    // which only need copies of them.
+    m_cacheview->EnableCompactCoins();
 }
 
 Chainstate::Chainstate(
@@ -2136,8 +2196,8 @@ ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, cons
     m_script_execution_cache_hasher.Write(nonce.begin(), 32);
 
     const auto [num_elems, approx_size_bytes] = m_script_execution_cache.setup_bytes(script_execution_cache_bytes);
-    LogPrintf("Using %zu MiB out of %zu MiB requested for script execution cache, able to store %zu elements\n",
-              approx_size_bytes >> 20, script_execution_cache_bytes >> 20, num_elems);
+    LogPrintf("Using %zu MiB out of %zu MiB requested for script execution cache, able to store %zu elements in %u shards\n",
+              approx_size_bytes >> 20, script_execution_cache_bytes >> 20, num_elems, m_script_execution_cache.num_shards());
 }
 
 /**
@@ -2163,7 +2223,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks)
+                       std::vector<CScriptCheck>* pvChecks,
+                       const PrecomputedTransactionData* known_txdata)
 {
     if (tx.IsCoinBase()) return true;
 
@@ -2179,7 +2240,6 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     uint256 hashCacheEntry;
     CSHA256 hasher = validation_cache.ScriptExecutionCacheHasher();
     hasher.Write(UCharCast(tx.GetWitnessHash().begin()), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
-    AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (validation_cache.m_script_execution_cache.contains(hashCacheEntry, !cacheFullScriptStore)) {
         return true;
     }
@@ -2194,7 +2254,13 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
             assert(!coin.IsSpent());
             spent_outputs.emplace_back(coin.out);
         }
-        txdata.Init(tx, std::move(spent_outputs));
+        if (known_txdata && known_txdata->m_spent_outputs_ready && known_txdata->m_spent_outputs == spent_outputs) {
+            // The same transaction spending the same outputs was checked
+            // before, so the data precomputed then can be reused.
+            txdata = *known_txdata;
+        } else {
+            txdata.Init(tx, std::move(spent_outputs));
+        }
     }
     assert(txdata.m_spent_outputs.size() == tx.vin.size());
 
@@ -2612,6 +2678,20 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
 
+    // Transactions that were accepted to the mempool may have kept the data
+    // precomputed for their signature hashes then.
+    std::vector<std::shared_ptr<const PrecomputedTransactionData>> mempool_txsdata(block.vtx.size());
+    if (m_mempool && fScriptChecks) {
+        LOCK(m_mempool->cs);
+        if (m_mempool->size() > 0) {
+            for (size_t i = 1; i < block.vtx.size(); ++i) {
+                if (const auto it{m_mempool->GetIter(block.vtx[i]->GetWitnessHash())}) {
+                    mempool_txsdata[i] = (*it)->GetPrecomputedTxData();
+                }
+            }
+        }
+    }
+
     std::vector<int> prevheights;
     CAmount nFees = 0;
     int nInputs = 0;
@@ -2676,10 +2756,10 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             // they need to be added to control which runs them asynchronously. Otherwise, CheckInputScripts runs the checks before returning.
             if (control) {
                 std::vector<CScriptCheck> vChecks;
-                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks);
+                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks, mempool_txsdata[i].get());
                 if (tx_ok) control->Add(std::move(vChecks));
             } else {
-                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache);
+                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, nullptr, mempool_txsdata[i].get());
             }
             if (!tx_ok) {
                 // Any transaction validation failure in ConnectBlock is a block consensus failure
@@ -4156,6 +4236,30 @@ bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consens
             [&](const auto& header) { return CheckProofOfWork(header.GetHash(), header.nBits, consensusParams);});
 }
 
+std::optional<uint256> HeaderPoWCheck::operator()() const
+{
+    *m_hash_out = m_header->GetHash();
+    if (!CheckProofOfWork(*m_hash_out, m_header->nBits, *m_params)) return *m_hash_out;
+    return std::nullopt;
+}
+
+bool CheckHeadersProofOfWork(std::span<const CBlockHeader> headers, std::vector<uint256>& hashes_out,
+                             const Consensus::Params& consensusParams, CCheckQueue<HeaderPoWCheck>* check_queue)
+{
+    hashes_out.resize(headers.size());
+    std::vector<HeaderPoWCheck> checks;
+    checks.reserve(headers.size());
+    for (size_t i{0}; i < headers.size(); ++i) {
+        checks.push_back({&headers[i], &hashes_out[i], &consensusParams});
+    }
+    if (!check_queue || !check_queue->HasThreads() || checks.size() <= 1) {
+        return std::ranges::all_of(checks, [](const auto& check) { return !check().has_value(); });
+    }
+    CCheckQueueControl<HeaderPoWCheck> control{*check_queue};
+    control.Add(std::move(checks));
+    return !control.Complete().has_value();
+}
+
 bool IsBlockMutated(const CBlock& block, bool check_witness_root)
 {
     BlockValidationState state;
@@ -4316,12 +4420,12 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
     return true;
 }
 
-bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
+bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked, const uint256* pow_checked_hash)
 {
     AssertLockHeld(cs_main);
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
+    const uint256 hash{pow_checked_hash ? *pow_checked_hash : block.GetHash()};
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -4336,7 +4440,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, GetConsensus())) {
+        if (!CheckBlockHeader(block, state, GetConsensus(), /*fCheckPOW=*/!pow_checked_hash)) {
             LogDebug(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -4362,7 +4466,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
         LogDebug(BCLog::VALIDATION, "%s: not adding new block header %s, missing anti-dos proof-of-work validation\n", __func__, hash.ToString());
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK, "too-little-chainwork");
     }
-    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, hash, m_best_header)};
 
     if (ppindex)
         *ppindex = pindex;
@@ -4371,14 +4475,17 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
 }
 
 // Exposed wrapper for AcceptBlockHeader
-bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex)
+bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex,
+                                               std::span<const uint256> pow_checked_hashes)
 {
     AssertLockNotHeld(cs_main);
+    Assume(pow_checked_hashes.empty() || pow_checked_hashes.size() == headers.size());
+    const bool have_hashes{pow_checked_hashes.size() == headers.size()};
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i{0}; i < headers.size(); ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            bool accepted{AcceptBlockHeader(header, state, &pindex, min_pow_checked)};
+            bool accepted{AcceptBlockHeader(headers[i], state, &pindex, min_pow_checked, have_hashes ? &pow_checked_hashes[i] : nullptr)};
             CheckBlockIndex();
 
             if (!accepted) {
@@ -6300,7 +6407,8 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 }
 
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
-    : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)},
+    : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS),
+                           "Script verification", "scriptch", options.pin_worker_threads},
       m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
       m_blockman{interrupt, std::move(blockman_options)},
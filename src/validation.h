@@ -367,7 +367,7 @@ private:
     CSHA256 m_script_execution_cache_hasher;
 
 public:
-    CuckooCache::cache<uint256, SignatureCacheHasher> m_script_execution_cache;
+    CuckooCache::sharded_cache<uint256, SignatureCacheHasher> m_script_execution_cache;
     SignatureCache m_signature_cache;
 
     ValidationCache(size_t script_execution_cache_bytes, size_t signature_cache_bytes);
@@ -410,6 +410,24 @@ BlockValidationState TestBlockValidity(
 /** Check with the proof of work on each blockheader matches the value in nBits */
 bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams);
 
+/** Check of the proof of work of a single block header, storing its hash for later use. */
+struct HeaderPoWCheck {
+    const CBlockHeader* m_header;
+    uint256* m_hash_out;
+    const Consensus::Params* m_params;
+
+    /** Returns std::nullopt if the proof of work is valid, and the hash of the header otherwise. */
+    std::optional<uint256> operator()() const;
+};
+
+/**
+ * Check the proof of work of each blockheader like HasValidProofOfWork, and
+ * store their hashes in hashes_out. The headers are hashed in parallel on the
+ * workers of check_queue, if one is given.
+ */
+bool CheckHeadersProofOfWork(std::span<const CBlockHeader> headers, std::vector<uint256>& hashes_out,
+                             const Consensus::Params& consensusParams, CCheckQueue<HeaderPoWCheck>* check_queue = nullptr);
+
 /** Check if a block has been mutated (with respect to its merkle root and witness commitments). */
 bool IsBlockMutated(const CBlock& block, bool check_witness_root);
 
@@ -939,12 +957,15 @@ private:
      * Caller must set min_pow_checked=true in order to add a new header to the
      * block index (permanent memory storage), indicating that the header is
      * known to be part of a sufficiently high-work chain (anti-dos check).
+     * If pow_checked_hash is set, it is the hash of the header, whose proof
+     * of work was checked already.
      */
     bool AcceptBlockHeader(
         const CBlockHeader& block,
         BlockValidationState& state,
         CBlockIndex** ppindex,
-        bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+        bool min_pow_checked,
+        const uint256* pow_checked_hash = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     friend Chainstate;
 
     /** Most recent headers presync progress update, for rate-limiting. */
@@ -1213,9 +1234,12 @@ public:
      * @param[in]  min_pow_checked  True if proof-of-work anti-DoS checks have been done by caller for headers chain
      * @param[out] state This may be set to an Error state if any error occurred processing them
      * @param[out] ppindex If set, the pointer will be set to point to the last new block index object for the given headers
+     * @param[in]  pow_checked_hashes  Optionally, the hashes of the headers as computed by CheckHeadersProofOfWork, so
+     *                                 they are not hashed and checked again while holding cs_main
      * @returns false if AcceptBlockHeader fails on any of the headers, true otherwise (including if headers were already known)
      */
-    bool ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex = nullptr) LOCKS_EXCLUDED(cs_main);
+    bool ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex = nullptr,
+                                std::span<const uint256> pow_checked_hashes = {}) LOCKS_EXCLUDED(cs_main);
 
     /**
      * Sufficiently validate a block for disk storage (and store on disk).
@@ -7,10 +7,13 @@ from collections import defaultdict
 
 from test_framework.messages import (
     CInv,
+    MSG_BLOCK,
+    MSG_WITNESS_FLAG,
     msg_getdata,
 )
 from test_framework.p2p import P2PInterface
 from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
 
 
 class P2PStoreBlock(P2PInterface):
@@ -43,6 +46,23 @@ class GetdataTest(BitcoinTestFramework):
         p2p_block_store.send_and_ping(good_getdata)
         p2p_block_store.wait_until(lambda: p2p_block_store.blocks[best_block] == 1)
 
+        self.log.info("test that blocks requested by several peers are served from the block cache")
+        old_block = int(self.nodes[0].getblockhash(100), 16)
+        stats_before = self.nodes[0].getnetworkinfo()["blockservecache"]
+        peers = [p2p_block_store, self.nodes[0].add_p2p_connection(P2PStoreBlock())]
+        for inv_type in [MSG_BLOCK | MSG_WITNESS_FLAG, MSG_BLOCK]:
+            for peer in peers:
+                peer.send_and_ping(msg_getdata([CInv(t=inv_type, h=old_block)]))
+        for peer in peers:
+            peer.wait_until(lambda: peer.blocks[old_block] == 2)
+        stats = self.nodes[0].getnetworkinfo()["blockservecache"]
+        # Each serialization is read once for the first peer and then shared.
+        # The witness-stripped one is decoded from the cached witness one.
+        assert_equal(stats["hits"] - stats_before["hits"], 3)
+        assert_equal(stats["entries"] - stats_before["entries"], 2)
+        assert stats["bytes_saved"] > stats_before["bytes_saved"]
+        assert stats["usage"] <= stats["max_usage"]
+
 
 if __name__ == '__main__':
     GetdataTest(__file__).main()
@@ -99,6 +99,10 @@ class P2PIBDStallingTest(BitcoinTestFramework):
                 p.send_without_ping(headers_message)
             self.all_sync_send_with_ping(peers)
 
+        self.log.info("Check that the block holding back the window is requested from one more peer")
+        self.wait_until(lambda: sum(stall_block in p.getdata_requests for p in peers) == 2)
+        assert_equal(sum(info["block_download"]["rerequested"] for info in node.getpeerinfo()), 1)
+
         self.log.info("Check that the stalling peer is disconnected after 2 seconds")
         self.mocktime += 3
         node.setmocktime(self.mocktime)
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025-present The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction relay through reconciliation (BIP 330).
+
+Relays transactions across a small network of nodes, once with transaction
+reconciliation enabled and once with flooding only, and compares the bytes the
+nodes spent on announcing them to each other.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_greater_than
+from test_framework.wallet import MiniWallet
+
+# Messages used to announce transactions. The getdata and tx messages that
+# follow are the same with and without reconciliation.
+ANNOUNCEMENT_MSGS = ["inv", "reqrecon", "sketch", "reconcildiff"]
+NUM_TXS = 100
+# Beyond the reconciliation request interval, so every step triggers a round.
+TIME_STEP = 10
+
+
+class TxReconRelayTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 6
+
+    def setup_network(self):
+        self.setup_nodes()
+        self.connect_ring()
+
+    def connect_ring(self):
+        # Every node has two outbound and two inbound connections.
+        for i in range(self.num_nodes):
+            for step in [1, 2]:
+                self.connect_nodes(i, (i + step) % self.num_nodes)
+
+    def announcement_bytes(self):
+        return sum(peer["bytessent_per_msg"].get(msg, 0)
+                   for node in self.nodes
+                   for peer in node.getpeerinfo()
+                   for msg in ANNOUNCEMENT_MSGS)
+
+    def relay(self, utxos):
+        """Submit one transaction per utxo, spread over all nodes, and return
+        the announcement bytes spent until every node has all of them."""
+        self.mocktime = int(self.nodes[0].getblockheader(self.nodes[0].getbestblockhash())["time"]) + 1
+        for node in self.nodes:
+            node.setmocktime(self.mocktime)
+        bytes_before = self.announcement_bytes()
+
+        txids = []
+        for i, utxo in enumerate(utxos):
+            tx = self.wallet.send_self_transfer(from_node=self.nodes[i % self.num_nodes], utxo_to_spend=utxo)
+            txids.append(tx["txid"])
+
+        def all_relayed():
+            self.mocktime += TIME_STEP
+            for node in self.nodes:
+                node.setmocktime(self.mocktime)
+            return all(set(txids) <= set(node.getrawmempool()) for node in self.nodes)
+        self.wait_until(all_relayed)
+
+        return self.announcement_bytes() - bytes_before
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        utxos = self.wallet.send_self_transfer_multi(from_node=self.nodes[0], num_outputs=2 * NUM_TXS)["new_utxos"]
+        self.generate(self.nodes[0], 1)
+
+        self.log.info("Relay transactions by flooding")
+        flooding_bytes = self.relay(utxos[:NUM_TXS])
+        self.generate(self.nodes[0], 1)
+
+        self.log.info("Relay transactions through reconciliation")
+        for i in range(self.num_nodes):
+            self.restart_node(i, extra_args=["-txreconciliation"])
+        self.connect_ring()
+        for node in self.nodes:
+            assert any(peer["bytesrecv_per_msg"].get("sendtxrcncl", 0) > 0 for peer in node.getpeerinfo())
+        reconciliation_bytes = self.relay(utxos[NUM_TXS:])
+        assert any(peer["bytessent_per_msg"].get("sketch", 0) > 0
+                   for node in self.nodes
+                   for peer in node.getpeerinfo())
+
+        self.log.info(f"Announcement bytes: {flooding_bytes} flooding, {reconciliation_bytes} reconciling "
+                      f"({100 - 100 * reconciliation_bytes // flooding_bytes}% saved)")
+        assert_greater_than(flooding_bytes, reconciliation_bytes)
+
+
+if __name__ == '__main__':
+    TxReconRelayTest(__file__).main()
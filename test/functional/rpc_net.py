@@ -150,6 +150,14 @@ class NetTest(BitcoinTestFramework):
                 "addr_relay_enabled": False,
                 "bip152_hb_from": False,
                 "bip152_hb_to": False,
+                "block_download": {
+                    "blocks": 0,
+                    "bytes": 0,
+                    "inflight_limit": 16,
+                    "latency": 0,
+                    "rate": 0,
+                    "rerequested": 0,
+                },
                 "bytesrecv_per_msg": {},
                 "bytessent_per_msg": {},
                 "connection_type": "inbound",